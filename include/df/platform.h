@@ -25,6 +25,17 @@ DF_API_IMPORT
 *** alignment ***
 DF_ALIGN_PRE( ALIGNMENT )
 DF_ALIGN_POST( ALIGNMENT ) 
+DF_CACHE_LINE_SIZE
+
+*** thread local storage ***
+DF_THREAD_LOCAL   // static thread local variable of POD type
+
+*** simd ***
+DF_SIMD_SSE2
+DF_SIMD_AVX2
+
+*** language ***
+DF_STD_ATOMIC     // <atomic> is available (C++11)
 
 */
 
@@ -72,6 +83,7 @@ DF_ALIGN_POST( ALIGNMENT )
     
     #define DF_ALIGN_PRE( ALIGNMENT ) __declspec( align( ALIGNMENT ) )
     #define DF_ALIGN_POST( ALIGNMENT )
+    #define DF_THREAD_LOCAL __declspec( thread )
     #ifndef NOMINMAX
         #define NOMINMAX
     #endif
@@ -94,10 +106,29 @@ DF_ALIGN_POST( ALIGNMENT )
     //force a variable to be aligned in memory. ALIGNMENT must be a power of two.
     #define DF_ALIGN_PRE( ALIGNMENT )
     #define DF_ALIGN_POST( ALIGNMENT ) __attribute__( ( aligned( ALIGNMENT ) ) ) 
+    #define DF_THREAD_LOCAL __thread
 #else
     #error Unknown compiler.
 #endif
 
+// SIMD instruction sets available at compile time
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define DF_SIMD_SSE2
+#endif
+#if defined(__AVX2__)
+    #define DF_SIMD_AVX2
+#endif
+
+// C++11 atomics, used by df::Atomic when available
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700)
+    #define DF_STD_ATOMIC
+#endif
+
+// Size of a cache line, used to pad data shared between threads (avoid false sharing)
+#ifndef DF_CACHE_LINE_SIZE
+    #define DF_CACHE_LINE_SIZE 64
+#endif
+
 // portable fixed-size types
 namespace df
 {
@@ -1,7 +1,10 @@
 #pragma once
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <new>
+#include <df/system/SimdKernels.h>
 
 namespace df
 {
@@ -73,14 +76,14 @@ protected:
 	T* _data;
 };
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline void* Array<T, ALIGNMENT>::allocate(uint32_t size)
 {
     const size_t pointerSize = sizeof(void*) + sizeof(size_t);
     const size_t requestedSize = size + ALIGNMENT - 1 + pointerSize;
-    void* raw = std::malloc(requestedSize);
+    void* raw = malloc(requestedSize);
     void* start = (char*)raw + pointerSize;
-    void* aligned = (void*)(((size_t)((char*)start+ALIGNMENT-1)) & ~(ALIGNMENT-1));  
+    void* aligned = (void*)(((size_t)((char*)start+ALIGNMENT-1)) & ~(size_t)(ALIGNMENT-1));  
    	*(size_t*)((char*)aligned-pointerSize) = size;
 	 *(void**)((char*)aligned-sizeof(void*)) = raw;
 
@@ -89,7 +92,7 @@ inline void* Array<T, ALIGNMENT>::allocate(uint32_t size)
 	return aligned;	
 }
 
-template<class T, size_t ALIGNMENT>
+template<class T, uint32_t ALIGNMENT>
 inline void Array<T, ALIGNMENT>::deallocate(void* alignedPtr)
 {
 	assert(alignedPtr !=NULL);
@@ -97,15 +100,15 @@ inline void Array<T, ALIGNMENT>::deallocate(void* alignedPtr)
 	//_allocated_size-=allocated_size(aligned);
 	//--_allocations_count;
 	void* raw = *(void**)((char*)alignedPtr-sizeof(void*));
-	std::free(raw);	
+	free(raw);	
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline Array<T, ALIGNMENT>::Array() : _size(0), _reserved_size(0), _data(NULL)
 {		
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline Array<T, ALIGNMENT>::Array(uint32_t reserved_size) : _size(0)
 {
 	reserved_size = (reserved_size > MINIMAL_SIZE) ? reserved_size : MINIMAL_SIZE;
@@ -113,19 +116,16 @@ inline Array<T, ALIGNMENT>::Array(uint32_t reserved_size) : _size(0)
 	_reserved_size = reserved_size;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline Array<T, ALIGNMENT>::Array(const Array& other)  : _size(0), _reserved_size(0), _data(NULL)
 {
-	resize(other._size);
-
-	T* end_ptr = _data + _size;
-	T* other_ptr = other._data;
-	for (T* ptr = _data; ptr < end_ptr; ++ptr, ++other_ptr) {
-		new (ptr) T(*other_ptr);
-	}
+	reserve(other._size);
+	// copy construct, arithmetic types are copied in bulk
+	priv::ConstructOps<T>::copy(_data, other._data, other._size);
+	_size = other._size;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline Array<T, ALIGNMENT>&  Array<T, ALIGNMENT>::operator=(const Array& other) 
 {
 	// ensure we don't try to assign array to itself  
@@ -137,7 +137,7 @@ inline Array<T, ALIGNMENT>&  Array<T, ALIGNMENT>::operator=(const Array& other)
     return *this;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 inline Array<T, ALIGNMENT>::~Array()
 {
 	if(_data!=NULL)
@@ -154,8 +154,8 @@ inline Array<T, ALIGNMENT>::~Array()
 	}
 }
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::reserve(size_t new_size)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::reserve(uint32_t new_size)
 {
 	// Grow the underlying array if necessary
 	if (new_size > _reserved_size) 
@@ -174,7 +174,7 @@ void Array<T, ALIGNMENT>::reserve(size_t new_size)
 			// strategy taken from G3D::Arrayxx
 
 			size_t old_size_bytes = _reserved_size * sizeof(T);
-			size_t new_reserved_size = (_reserved_size * 3);
+			uint32_t new_reserved_size = (_reserved_size * 3);
 			if (old_size_bytes > 400000) {
 				new_reserved_size >>= 1; // Avoid bloat ( *= 1.5)
 			} else if (old_size_bytes > 64000) {
@@ -199,8 +199,8 @@ void Array<T, ALIGNMENT>::reserve(size_t new_size)
 }
 
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::resize(size_t new_size)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::resize(uint32_t new_size)
 {
     if (new_size == _size) {
         return;
@@ -227,8 +227,8 @@ void Array<T, ALIGNMENT>::resize(size_t new_size)
 }
 
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::resize(size_t new_size, const T& default_value)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::resize(uint32_t new_size, const T& default_value)
 {
     if (new_size == _size) {
         return;
@@ -245,16 +245,13 @@ void Array<T, ALIGNMENT>::resize(size_t new_size, const T& default_value)
 	{
 		//ensure there is enough place for the leftovers
 		reserve(new_size);
-        // Call the constructors on newly revealed elements.
-		const T* end_ptr = _data+new_size;
-		for(T* ptr = _data+_size; ptr < end_ptr; ++ptr)	{
-			new (ptr) T(default_value);
-		}
+        // Call the constructors on newly revealed elements (vectorized fill for arithmetic types).
+		priv::ConstructOps<T>::fill(_data+_size, new_size-_size, default_value);
 	}
 	_size = new_size;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 void Array<T, ALIGNMENT>::clear()
 {	
 	const T* end_ptr = _data+_size;
@@ -267,7 +264,7 @@ void Array<T, ALIGNMENT>::clear()
 	_reserved_size = 0;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 void Array<T, ALIGNMENT>::push_back(const T& value)
 {
 	if (_size < _reserved_size) {
@@ -287,7 +284,7 @@ void Array<T, ALIGNMENT>::push_back(const T& value)
 	++_size;
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 void Array<T, ALIGNMENT>::pop_back()
 {
 	assert(_size>0);	
@@ -297,8 +294,8 @@ void Array<T, ALIGNMENT>::pop_back()
 
 
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::insert(const T& value, size_t idx)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::insert(const T& value, uint32_t idx)
 {
 	assert(idx <= _size);
 	if ( (&value >= _data) && (&value < _data + _size) )
@@ -321,7 +318,7 @@ void Array<T, ALIGNMENT>::insert(const T& value, size_t idx)
     
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 void Array<T, ALIGNMENT>::insert(const T& value, uint32_t idx, uint32_t count)
 {
 	assert(idx <= _size);
@@ -331,15 +328,10 @@ void Array<T, ALIGNMENT>::insert(const T& value, uint32_t idx, uint32_t count)
 	_size+=count;
 	memmove(_data+idx+count, _data+idx, (_size-idx -count) * sizeof(T));
 	
-	const T* end_ptr = _data+idx+count;
-	for(T* ptr = _data+idx; ptr < end_ptr; ++ptr)
-	{
-			new (ptr) T(value);
-	}
-	
+	priv::ConstructOps<T>::fill(_data+idx, count, value);
 }
 
-template<class T, size_t ALIGNMENT> 
+template<class T, uint32_t ALIGNMENT> 
 void Array<T, ALIGNMENT>::insert(const T* values, uint32_t idx, uint32_t count)
 {
 	assert(idx <= _size);
@@ -348,12 +340,11 @@ void Array<T, ALIGNMENT>::insert(const T* values, uint32_t idx, uint32_t count)
 	reserve(_size + count);	
 	_size+=count;
 	memmove(_data+idx+count, _data+idx, (_size-idx -count) * sizeof(T));
-	memcpy(_data+idx, values, count * sizeof(T));
-	_size+=count;
+	priv::ConstructOps<T>::copy(_data+idx, values, count);
 }
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::remove(size_t idx)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::remove(uint32_t idx)
 {
 	assert(idx >= 0);
 	assert(idx < _size);
@@ -364,8 +355,8 @@ void Array<T, ALIGNMENT>::remove(size_t idx)
 	--_size;
 }
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::remove(size_t idx, size_t count)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::remove(uint32_t idx, uint32_t count)
 {
 	assert((idx >= 0) && (idx < _size));	
 	assert((count > 0) && (idx+count <= _size));
@@ -380,8 +371,8 @@ void Array<T, ALIGNMENT>::remove(size_t idx, size_t count)
 	_size-=count;
 }
 
-template<class T, size_t ALIGNMENT> 
-void Array<T, ALIGNMENT>::unsorted_remove(size_t idx)
+template<class T, uint32_t ALIGNMENT> 
+void Array<T, ALIGNMENT>::unsorted_remove(uint32_t idx)
 {
 	assert(idx >= 0);
 	assert(idx < _size);
@@ -0,0 +1,147 @@
+#pragma once
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <df/system/Array.h>
+#include <df/system/ArrayView.h>
+#include <df/system/SimdKernels.h>
+
+// Bulk operations over Array and ArrayView.
+// int32, uint32, int64, uint64, float and double use SSE2/AVX2 kernels when available
+// (other types use scalar loops). Array overloads rely on the ALIGNMENT template parameter
+// of the Array to use aligned loads without a scalar prologue.
+// Note: sum of floating point values is computed in a different order than a scalar loop.
+
+namespace df
+{
+
+/// returned by find when the value is not found
+const uint32_t npos = 0xFFFFFFFF;
+
+// *** fill ***
+template<class T>
+inline void fill(ArrayView<T> view, const typename ArrayView<T>::value_type& value)
+{
+	priv::SimdKernels<T, priv::SimdEqVec<T>, 1>::fill(view.begin(), view.size(), value);
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline void fill(Array<T, ALIGNMENT>& array, const T& value)
+{
+	priv::SimdKernels<T, priv::SimdEqVec<T>, ALIGNMENT>::fill(array.begin(), array.size(), value);
+}
+
+// *** copy ***
+/// copy src elements at the start of dst (dst must be large enough), converting them if U differs from T
+template<class T, class U>
+inline void copy(ArrayView<T> dst, ArrayView<U> src)
+{
+	assert(dst.size() >= src.size());
+	typedef typename ArrayView<T>::value_type DstValue;
+	typedef typename ArrayView<U>::value_type SrcValue;
+	if(priv::IsArithmetic<DstValue>::value && priv::IsSame<DstValue, SrcValue>::value) {
+		memcpy(dst.begin(), src.begin(), src.size() * sizeof(T));
+	} else {
+		for(uint32_t i = 0; i < src.size(); ++i) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+/// resize dst to the size of src and copy src elements
+template<class T, uint32_t ALIGNMENT, uint32_t SRC_ALIGNMENT>
+inline void copy(Array<T, ALIGNMENT>& dst, const Array<T, SRC_ALIGNMENT>& src)
+{
+	dst.resize(src.size());
+	copy(ArrayView<T>(dst), ArrayView<const T>(src));
+}
+
+// *** find / count ***
+/// index of the first element equal to value, npos if none
+template<class T>
+inline uint32_t find(ArrayView<T> view, const typename ArrayView<T>::value_type& value)
+{
+	typedef typename ArrayView<T>::value_type V;
+	const uint32_t idx = priv::SimdKernels<V, priv::SimdEqVec<V>, 1>::find(view.begin(), view.size(), value);
+	return (idx < view.size()) ? idx : npos;
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline uint32_t find(const Array<T, ALIGNMENT>& array, const T& value)
+{
+	const uint32_t idx = priv::SimdKernels<T, priv::SimdEqVec<T>, ALIGNMENT>::find(array.begin(), array.size(), value);
+	return (idx < array.size()) ? idx : npos;
+}
+
+/// number of elements equal to value
+template<class T>
+inline uint32_t count(ArrayView<T> view, const typename ArrayView<T>::value_type& value)
+{
+	typedef typename ArrayView<T>::value_type V;
+	return priv::SimdKernels<V, priv::SimdEqVec<V>, 1>::count(view.begin(), view.size(), value);
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline uint32_t count(const Array<T, ALIGNMENT>& array, const T& value)
+{
+	return priv::SimdKernels<T, priv::SimdEqVec<T>, ALIGNMENT>::count(array.begin(), array.size(), value);
+}
+
+// *** comparison ***
+/// true if both ranges have the same size and the same elements
+template<class T, class U>
+inline bool equal(ArrayView<T> a, ArrayView<U> b)
+{
+	typedef typename ArrayView<T>::value_type V;
+	return a.size() == b.size() && priv::SimdKernels<V, priv::SimdEqVec<V>, 1>::equal(a.begin(), b.begin(), a.size());
+}
+
+template<class T, uint32_t ALIGNMENT, uint32_t OTHER_ALIGNMENT>
+inline bool equal(const Array<T, ALIGNMENT>& a, const Array<T, OTHER_ALIGNMENT>& b)
+{
+	return a.size() == b.size() && priv::SimdKernels<T, priv::SimdEqVec<T>, ALIGNMENT>::equal(a.begin(), b.begin(), a.size());
+}
+
+// *** reductions ***
+template<class T>
+inline typename ArrayView<T>::value_type sum(ArrayView<T> view)
+{
+	typedef typename ArrayView<T>::value_type V;
+	return priv::SimdKernels<V, priv::SimdArithVec<V>, 1>::sum(view.begin(), view.size());
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline T sum(const Array<T, ALIGNMENT>& array)
+{
+	return priv::SimdKernels<T, priv::SimdArithVec<T>, ALIGNMENT>::sum(array.begin(), array.size());
+}
+
+/// smallest element, the range cannot be empty
+template<class T>
+inline typename ArrayView<T>::value_type minValue(ArrayView<T> view)
+{
+	typedef typename ArrayView<T>::value_type V;
+	return priv::SimdKernels<V, priv::SimdArithVec<V>, 1>::min(view.begin(), view.size());
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline T minValue(const Array<T, ALIGNMENT>& array)
+{
+	return priv::SimdKernels<T, priv::SimdArithVec<T>, ALIGNMENT>::min(array.begin(), array.size());
+}
+
+/// largest element, the range cannot be empty
+template<class T>
+inline typename ArrayView<T>::value_type maxValue(ArrayView<T> view)
+{
+	typedef typename ArrayView<T>::value_type V;
+	return priv::SimdKernels<V, priv::SimdArithVec<V>, 1>::max(view.begin(), view.size());
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline T maxValue(const Array<T, ALIGNMENT>& array)
+{
+	return priv::SimdKernels<T, priv::SimdArithVec<T>, ALIGNMENT>::max(array.begin(), array.size());
+}
+
+} // namespace df
@@ -0,0 +1,45 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <df/system/Array.h>
+#include <df/system/SimdKernels.h>
+
+namespace df
+{
+
+/// A non owning view on a contiguous range of elements (a whole Array or a part of it).
+/// Use ArrayView<const T> for read only access.
+/// The view is invalidated by any reallocation of the viewed storage.
+template<class T>
+class ArrayView
+{
+public:
+	typedef typename priv::RemoveConst<T>::type value_type;
+
+	ArrayView() : _data(NULL), _size(0) {}
+	ArrayView(T* data, uint32_t size) : _data(data), _size(size) {}
+	template<class U, uint32_t ALIGNMENT>
+	ArrayView(Array<U, ALIGNMENT>& array) : _data(array.begin()), _size(array.size()) {}
+	template<class U, uint32_t ALIGNMENT>
+	ArrayView(const Array<U, ALIGNMENT>& array) : _data(array.begin()), _size(array.size()) {}
+	/// a view on const elements can be built from a view on mutable ones
+	template<class U>
+	ArrayView(const ArrayView<U>& other) : _data(other.begin()), _size(other.size()) {}
+
+	uint32_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	T& operator[](uint32_t idx) const { assert(idx < _size); return _data[idx]; }
+
+	T* begin() const { return _data; }
+	T* end() const   { return _data + _size; }
+
+	/// view on count elements starting at first
+	ArrayView sub(uint32_t first, uint32_t count) const { assert(first + count <= _size); return ArrayView(_data + first, count); }
+
+private:
+	T* _data;
+	uint32_t _size;
+};
+
+} // namespace df
@@ -0,0 +1,259 @@
+#pragma once
+#include <stddef.h>
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#if defined(DF_STD_ATOMIC)
+	#include <atomic>
+#endif
+
+// Atomic<T>: a value of integral or pointer type read and modified atomically, each operation
+// taking an explicit memory order (sequentially consistent by default, as std::atomic).
+// Maps to std::atomic when the compiler provides it (DF_STD_ATOMIC), otherwise to the GCC
+// __atomic builtins or to the MSVC interlocked intrinsics (where every read-modify-write is
+// sequentially consistent). Without std::atomic, T must be 32 or 64 bits wide.
+// PaddedAtomic<T> is an Atomic alone on its cache line, for values written by different threads.
+
+namespace df
+{
+
+/// Ordering constraints of an atomic operation (see std::memory_order)
+enum MemoryOrder
+{
+	MEMORY_ORDER_RELAXED, ///< atomicity only
+	MEMORY_ORDER_ACQUIRE, ///< for loads: later memory accesses cannot be reordered before
+	MEMORY_ORDER_RELEASE, ///< for stores: earlier memory accesses cannot be reordered after
+	MEMORY_ORDER_ACQ_REL, ///< for read-modify-write operations: acquire and release
+	MEMORY_ORDER_SEQ_CST  ///< acquire / release, and a single total order of all such operations
+};
+
+namespace priv
+{
+/// order of the load done by a failing compare exchange
+inline MemoryOrder getFailureOrder(MemoryOrder order)
+{
+	if(order == MEMORY_ORDER_ACQ_REL) return MEMORY_ORDER_ACQUIRE;
+	if(order == MEMORY_ORDER_RELEASE) return MEMORY_ORDER_RELAXED;
+	return order;
+}
+
+#if defined(DF_STD_ATOMIC)
+inline std::memory_order toNativeOrder(MemoryOrder order)
+{
+	switch(order)
+	{
+	case MEMORY_ORDER_RELAXED: return std::memory_order_relaxed;
+	case MEMORY_ORDER_ACQUIRE: return std::memory_order_acquire;
+	case MEMORY_ORDER_RELEASE: return std::memory_order_release;
+	case MEMORY_ORDER_ACQ_REL: return std::memory_order_acq_rel;
+	default: return std::memory_order_seq_cst;
+	}
+}
+#elif defined(DF_COMPILER_GCC)
+inline int toNativeOrder(MemoryOrder order)
+{
+	switch(order)
+	{
+	case MEMORY_ORDER_RELAXED: return __ATOMIC_RELAXED;
+	case MEMORY_ORDER_ACQUIRE: return __ATOMIC_ACQUIRE;
+	case MEMORY_ORDER_RELEASE: return __ATOMIC_RELEASE;
+	case MEMORY_ORDER_ACQ_REL: return __ATOMIC_ACQ_REL;
+	default: return __ATOMIC_SEQ_CST;
+	}
+}
+#endif
+
+/// operations common to integral and pointer atomics
+template<class T>
+class AtomicBase : NonCopyable
+{
+public:
+	AtomicBase():_value(T()) {}
+	explicit AtomicBase(T value):_value(value) {}
+
+	/// order cannot be release or acq_rel
+	T load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const
+	{
+#if defined(DF_STD_ATOMIC)
+		return _value.load(toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_load_n(&_value, toNativeOrder(order));
+#else
+		// x86: a plain load is an acquire (and sequentially consistent since stores are interlocked)
+		return (order == MEMORY_ORDER_RELAXED) ? atomicLoadRelaxed(&_value) : atomicLoadAcquire(&_value);
+#endif
+	}
+
+	/// order cannot be acquire or acq_rel
+	void store(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		_value.store(value, toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		__atomic_store_n(&_value, value, toNativeOrder(order));
+#else
+		if(order == MEMORY_ORDER_RELAXED) {
+			atomicStoreRelaxed(&_value, value);
+		} else if(order == MEMORY_ORDER_SEQ_CST) {
+			atomicExchange(&_value, value);
+		} else {
+			atomicStoreRelease(&_value, value);
+		}
+#endif
+	}
+
+	/// replace the value, return the previous one
+	T exchange(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return _value.exchange(value, toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_exchange_n(&_value, value, toNativeOrder(order));
+#else
+		return atomicExchange(&_value, value);
+#endif
+	}
+
+	/// replace the value by desired if it is equal to expected
+	/// return true on success, otherwise expected receives the current value
+	bool compareExchange(T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return _value.compare_exchange_strong(expected, desired, toNativeOrder(order), toNativeOrder(getFailureOrder(order)));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_compare_exchange_n(&_value, &expected, desired, false, toNativeOrder(order), toNativeOrder(getFailureOrder(order)));
+#else
+		return atomicCompareExchange(&_value, expected, desired);
+#endif
+	}
+
+	/// as compareExchange, but may fail even if the value is equal to expected (cheaper in a loop on LL/SC cpus)
+	bool compareExchangeWeak(T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return _value.compare_exchange_weak(expected, desired, toNativeOrder(order), toNativeOrder(getFailureOrder(order)));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_compare_exchange_n(&_value, &expected, desired, true, toNativeOrder(order), toNativeOrder(getFailureOrder(order)));
+#else
+		return atomicCompareExchange(&_value, expected, desired);
+#endif
+	}
+
+protected:
+#if defined(DF_STD_ATOMIC)
+	std::atomic<T> _value;
+#else
+	volatile T _value;
+#endif
+};
+}
+
+/// \brief Atomic integral value
+template<class T>
+class Atomic : public priv::AtomicBase<T>
+{
+public:
+	Atomic() {}
+	explicit Atomic(T value):priv::AtomicBase<T>(value) {}
+
+	// read-modify-write operations, return the previous value
+	T fetchAdd(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return this->_value.fetch_add(value, priv::toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_fetch_add(&this->_value, value, priv::toNativeOrder(order));
+#else
+		return priv::atomicFetchAdd(&this->_value, value);
+#endif
+	}
+	T fetchSub(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+		return fetchAdd(T(0) - value, order);
+	}
+	T fetchAnd(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return this->_value.fetch_and(value, priv::toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_fetch_and(&this->_value, value, priv::toNativeOrder(order));
+#else
+		T previous = this->load(MEMORY_ORDER_RELAXED);
+		while(!this->compareExchange(previous, previous & value)) {}
+		return previous;
+#endif
+	}
+	T fetchOr(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return this->_value.fetch_or(value, priv::toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_fetch_or(&this->_value, value, priv::toNativeOrder(order));
+#else
+		T previous = this->load(MEMORY_ORDER_RELAXED);
+		while(!this->compareExchange(previous, previous | value)) {}
+		return previous;
+#endif
+	}
+	T fetchXor(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return this->_value.fetch_xor(value, priv::toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		return __atomic_fetch_xor(&this->_value, value, priv::toNativeOrder(order));
+#else
+		T previous = this->load(MEMORY_ORDER_RELAXED);
+		while(!this->compareExchange(previous, previous ^ value)) {}
+		return previous;
+#endif
+	}
+};
+
+/// \brief Atomic pointer, arithmetic is in number of elements as for regular pointers
+template<class T>
+class Atomic<T*> : public priv::AtomicBase<T*>
+{
+public:
+	Atomic() {}
+	explicit Atomic(T* value):priv::AtomicBase<T*>(value) {}
+
+	T* fetchAdd(ptrdiff_t count, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+#if defined(DF_STD_ATOMIC)
+		return this->_value.fetch_add(count, priv::toNativeOrder(order));
+#elif defined(DF_COMPILER_GCC)
+		// the builtin does not scale pointer arithmetic
+		return __atomic_fetch_add(&this->_value, count * ptrdiff_t(sizeof(T)), priv::toNativeOrder(order));
+#else
+		T* previous = this->load(MEMORY_ORDER_RELAXED);
+		while(!this->compareExchange(previous, previous + count)) {}
+		return previous;
+#endif
+	}
+	T* fetchSub(ptrdiff_t count, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+	{
+		return fetchAdd(-count, order);
+	}
+};
+
+namespace priv
+{
+struct CacheLinePadding
+{
+	char _padding[DF_CACHE_LINE_SIZE];
+};
+}
+
+/// \brief Atomic alone on its cache line
+/// Padded before and after: neighbouring data never shares the line (no false sharing).
+template<class T>
+class PaddedAtomic : private priv::CacheLinePadding, public Atomic<T>
+{
+public:
+	PaddedAtomic() {}
+	explicit PaddedAtomic(T value):Atomic<T>(value) {}
+private:
+	char _padAfter[DF_CACHE_LINE_SIZE - sizeof(Atomic<T>) % DF_CACHE_LINE_SIZE];
+};
+
+} // namespace df
@@ -0,0 +1,143 @@
+#pragma once
+#include <df/platform.h>
+#if defined(DF_COMPILER_MSVC)
+	#include <intrin.h>
+	#include <string.h>
+#endif
+
+namespace df
+{
+namespace priv
+{
+// Minimal set of atomic operations on 32 bits, 64 bits and pointer values.
+// Low level layer of df::Atomic (see Atomic.h), used directly on the words waited on with a futex.
+
+/// atomic load, no ordering constraint
+template<class T>
+inline T atomicLoadRelaxed(const volatile T* ptr)
+{
+#if defined(DF_COMPILER_GCC)
+	return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+#else
+	return *ptr;
+#endif
+}
+
+/// atomic load, subsequent memory accesses cannot be reordered before it
+template<class T>
+inline T atomicLoadAcquire(const volatile T* ptr)
+{
+#if defined(DF_COMPILER_GCC)
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+	// x86 loads already have acquire semantic, only prevent compiler reordering
+	T value = *ptr;
+	_ReadWriteBarrier();
+	return value;
+#endif
+}
+
+/// atomic store, no ordering constraint
+template<class T>
+inline void atomicStoreRelaxed(volatile T* ptr, T value)
+{
+#if defined(DF_COMPILER_GCC)
+	__atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+#else
+	*ptr = value;
+#endif
+}
+
+/// atomic store, previous memory accesses cannot be reordered after it
+template<class T>
+inline void atomicStoreRelease(volatile T* ptr, T value)
+{
+#if defined(DF_COMPILER_GCC)
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+	// x86 stores already have release semantic, only prevent compiler reordering
+	_ReadWriteBarrier();
+	*ptr = value;
+#endif
+}
+
+/// atomic add, return the previous value (sequentially consistent)
+template<class T>
+inline T atomicFetchAdd(volatile T* ptr, T value)
+{
+#if defined(DF_COMPILER_GCC)
+	return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#else
+	if(sizeof(T) == 8)
+		return (T)_InterlockedExchangeAdd64((volatile __int64*)ptr, (__int64)value);
+	return (T)_InterlockedExchangeAdd((volatile long*)ptr, (long)value);
+#endif
+}
+
+/// replace *ptr by desired if it is equal to expected (sequentially consistent)
+/// return true on success, otherwise expected receives the current value
+template<class T>
+inline bool atomicCompareExchange(volatile T* ptr, T& expected, T desired)
+{
+#if defined(DF_COMPILER_GCC)
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+	if(sizeof(T) == 8)
+	{
+		__int64 expectedBits, desiredBits;
+		memcpy(&expectedBits, &expected, 8);
+		memcpy(&desiredBits, &desired, 8);
+		const __int64 previous = _InterlockedCompareExchange64((volatile __int64*)ptr, desiredBits, expectedBits);
+		if(previous == expectedBits) return true;
+		memcpy(&expected, &previous, 8);
+		return false;
+	}
+	long expectedBits, desiredBits;
+	memcpy(&expectedBits, &expected, 4);
+	memcpy(&desiredBits, &desired, 4);
+	const long previous = _InterlockedCompareExchange((volatile long*)ptr, desiredBits, expectedBits);
+	if(previous == expectedBits) return true;
+	memcpy(&expected, &previous, 4);
+	return false;
+#endif
+}
+
+/// replace *ptr by value, return the previous value (sequentially consistent)
+template<class T>
+inline T atomicExchange(volatile T* ptr, T value)
+{
+#if defined(DF_COMPILER_GCC)
+	return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#else
+	T expected = *ptr;
+	while(!atomicCompareExchange(ptr, expected, value)) {}
+	return expected;
+#endif
+}
+
+/// full memory barrier
+inline void atomicThreadFence()
+{
+#if defined(DF_COMPILER_GCC)
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+	_ReadWriteBarrier();
+	_mm_mfence();
+	_ReadWriteBarrier();
+#endif
+}
+
+/// hint the cpu that we are in a spin loop
+inline void cpuPause()
+{
+#if defined(DF_COMPILER_MSVC)
+	_mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__("pause");
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+} // namespace priv
+} // namespace df
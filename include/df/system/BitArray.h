@@ -0,0 +1,263 @@
+#pragma once
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <df/platform.h>
+#include <df/system/Array.h>
+#include <df/system/BitOps.h>
+#if defined(DF_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(DF_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace df
+{
+
+namespace priv
+{
+// Whole array kernels used by BitArray. Word pointers must be aligned on 32 bytes.
+
+/// return the number of bits set in count words
+inline uint32_t bitCountWords(const uint64* words, uint32_t count)
+{
+	uint32_t i = 0;
+	uint64 total = 0;
+#if defined(DF_SIMD_AVX2)
+	// nibble lookup popcount (W. Mula), accumulated with sad into 64 bits lanes
+	const __m256i lookup = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+	const __m256i lowMask = _mm256_set1_epi8(0x0f);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m256i v = _mm256_load_si256((const __m256i*)(words + i));
+		const __m256i lo = _mm256_and_si256(v, lowMask);
+		const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+		const __m256i bytesCount = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytesCount, zero));
+	}
+	DF_ALIGN_PRE(32) uint64 lanes[4] DF_ALIGN_POST(32);
+	_mm256_store_si256((__m256i*)lanes, acc);
+	total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+	for(; i < count; ++i) {
+		total += popcount(words[i]);
+	}
+	return uint32_t(total);
+}
+
+/// dst[i] &= src[i]
+inline void bitAndWords(uint64* dst, const uint64* src, uint32_t count)
+{
+	uint32_t i = 0;
+#if defined(DF_SIMD_AVX2)
+	for(; i + 4 <= count; i += 4) {
+		_mm256_store_si256((__m256i*)(dst + i), _mm256_and_si256(_mm256_load_si256((const __m256i*)(dst + i)), _mm256_load_si256((const __m256i*)(src + i))));
+	}
+#elif defined(DF_SIMD_SSE2)
+	for(; i + 2 <= count; i += 2) {
+		_mm_store_si128((__m128i*)(dst + i), _mm_and_si128(_mm_load_si128((const __m128i*)(dst + i)), _mm_load_si128((const __m128i*)(src + i))));
+	}
+#endif
+	for(; i < count; ++i) {
+		dst[i] &= src[i];
+	}
+}
+
+/// dst[i] |= src[i]
+inline void bitOrWords(uint64* dst, const uint64* src, uint32_t count)
+{
+	uint32_t i = 0;
+#if defined(DF_SIMD_AVX2)
+	for(; i + 4 <= count; i += 4) {
+		_mm256_store_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_load_si256((const __m256i*)(dst + i)), _mm256_load_si256((const __m256i*)(src + i))));
+	}
+#elif defined(DF_SIMD_SSE2)
+	for(; i + 2 <= count; i += 2) {
+		_mm_store_si128((__m128i*)(dst + i), _mm_or_si128(_mm_load_si128((const __m128i*)(dst + i)), _mm_load_si128((const __m128i*)(src + i))));
+	}
+#endif
+	for(; i < count; ++i) {
+		dst[i] |= src[i];
+	}
+}
+
+/// dst[i] ^= src[i]
+inline void bitXorWords(uint64* dst, const uint64* src, uint32_t count)
+{
+	uint32_t i = 0;
+#if defined(DF_SIMD_AVX2)
+	for(; i + 4 <= count; i += 4) {
+		_mm256_store_si256((__m256i*)(dst + i), _mm256_xor_si256(_mm256_load_si256((const __m256i*)(dst + i)), _mm256_load_si256((const __m256i*)(src + i))));
+	}
+#elif defined(DF_SIMD_SSE2)
+	for(; i + 2 <= count; i += 2) {
+		_mm_store_si128((__m128i*)(dst + i), _mm_xor_si128(_mm_load_si128((const __m128i*)(dst + i)), _mm_load_si128((const __m128i*)(src + i))));
+	}
+#endif
+	for(; i < count; ++i) {
+		dst[i] ^= src[i];
+	}
+}
+}
+
+/// A dense array of bits, stored in 64 bits words.
+/// Storage is an Array of words aligned on 32 bytes (same growth strategy as Array).
+/// Bits beyond size() in the last word are always kept to 0.
+class BitArray
+{
+public:
+	typedef uint64 Word;
+	static const uint32_t BITS_PER_WORD = 64;
+	/// returned by find functions when no bit is found
+	static const uint32_t npos = 0xFFFFFFFF;
+
+	BitArray() : _size(0) {}
+	explicit BitArray(uint32_t size, bool value = false) : _size(0) { resize(size, value); }
+
+	uint32_t size() const { return _size; }
+	uint32_t reserved_size() const { return _words.reserved_size() * BITS_PER_WORD; }
+
+	/// Makes sure that the array has at least the specified capacity (in bits).
+	void reserve(uint32_t reserved_size) { _words.reserve(wordCount(reserved_size)); }
+	/// Changes the size of the array, new bits are set to value.
+	void resize(uint32_t new_size, bool value = false);
+	//set size to 0 and free memory
+	void clear() { if(_words.reserved_size() > 0) _words.clear(); _size = 0; }
+
+	// *** word access ***
+	uint32_t word_count() const { return _words.size(); }
+	/// Raw words, aligned on 32 bytes. Bits beyond size() must be left to 0.
+	Word* words() { return _words.begin(); }
+	const Word* words() const { return _words.begin(); }
+
+	// *** bit operations ***
+	bool test(uint32_t idx) const { assert(idx < _size); return (_words[idx / BITS_PER_WORD] >> (idx % BITS_PER_WORD)) & 1; }
+	bool operator[](uint32_t idx) const { return test(idx); }
+	void set(uint32_t idx)   { assert(idx < _size); _words[idx / BITS_PER_WORD] |= Word(1) << (idx % BITS_PER_WORD); }
+	void set(uint32_t idx, bool value) { if(value) set(idx); else reset(idx); }
+	void reset(uint32_t idx) { assert(idx < _size); _words[idx / BITS_PER_WORD] &= ~(Word(1) << (idx % BITS_PER_WORD)); }
+	void flip(uint32_t idx)  { assert(idx < _size); _words[idx / BITS_PER_WORD] ^= Word(1) << (idx % BITS_PER_WORD); }
+
+	/// Pushes a bit at the end of the array.
+	void push_back(bool value);
+
+	/// Set count bits, starting from first, to value.
+	void fill(uint32_t first, uint32_t count, bool value);
+	void set_all()   { fill(0, _size, true); }
+	void reset_all() { fill(0, _size, false); }
+
+	// *** scan ***
+	/// Index of the first bit set, npos if none.
+	uint32_t find_first() const { return find_next(0); }
+	/// Index of the first bit set at or after idx, npos if none.
+	uint32_t find_next(uint32_t idx) const;
+
+	/// Number of bits set.
+	uint32_t count() const { return priv::bitCountWords(_words.begin(), _words.size()); }
+	bool any() const;
+	bool none() const { return !any(); }
+
+	// *** whole array operations (arrays must have the same size) ***
+	BitArray& operator&=(const BitArray& other) { assert(_size == other._size); priv::bitAndWords(_words.begin(), other._words.begin(), _words.size()); return *this; }
+	BitArray& operator|=(const BitArray& other) { assert(_size == other._size); priv::bitOrWords(_words.begin(), other._words.begin(), _words.size()); return *this; }
+	BitArray& operator^=(const BitArray& other) { assert(_size == other._size); priv::bitXorWords(_words.begin(), other._words.begin(), _words.size()); return *this; }
+
+private:
+	static uint32_t wordCount(uint32_t bits) { return (bits + BITS_PER_WORD - 1) / BITS_PER_WORD; }
+	/// clear the unused bits of the last word
+	void clearTrailingBits();
+
+	Array<Word, 32> _words;
+	uint32_t _size;
+};
+
+inline void BitArray::clearTrailingBits()
+{
+	const uint32_t usedBits = _size % BITS_PER_WORD;
+	if(usedBits != 0) {
+		_words[_words.size()-1] &= (Word(1) << usedBits) - 1;
+	}
+}
+
+inline void BitArray::resize(uint32_t new_size, bool value)
+{
+	const uint32_t old_size = _size;
+	_words.resize(wordCount(new_size), Word(0));
+	_size = new_size;
+	if(new_size > old_size && value) {
+		fill(old_size, new_size - old_size, true);
+	}else {
+		clearTrailingBits();
+	}
+}
+
+inline void BitArray::push_back(bool value)
+{
+	if(_size % BITS_PER_WORD == 0) {
+		_words.push_back(Word(0));
+	}
+	++_size;
+	if(value) {
+		set(_size-1);
+	}
+}
+
+inline void BitArray::fill(uint32_t first, uint32_t count, bool value)
+{
+	assert(first + count <= _size);
+	if(count == 0) {
+		return;
+	}
+	const uint32_t last = first + count; // excluded
+	const uint32_t firstWord = first / BITS_PER_WORD;
+	const uint32_t lastWord = (last - 1) / BITS_PER_WORD;
+	const Word firstMask = ~Word(0) << (first % BITS_PER_WORD);
+	const Word lastMask = ~Word(0) >> (BITS_PER_WORD - 1 - (last - 1) % BITS_PER_WORD);
+	Word* words = _words.begin();
+
+	if(firstWord == lastWord)
+	{
+		const Word mask = firstMask & lastMask;
+		words[firstWord] = value ? (words[firstWord] | mask) : (words[firstWord] & ~mask);
+		return;
+	}
+
+	words[firstWord] = value ? (words[firstWord] | firstMask) : (words[firstWord] & ~firstMask);
+	memset(words + firstWord + 1, value ? 0xFF : 0, (lastWord - firstWord - 1) * sizeof(Word));
+	words[lastWord] = value ? (words[lastWord] | lastMask) : (words[lastWord] & ~lastMask);
+}
+
+inline uint32_t BitArray::find_next(uint32_t idx) const
+{
+	if(idx >= _size) {
+		return npos;
+	}
+	const Word* words = _words.begin();
+	const uint32_t wordCount = _words.size();
+	uint32_t wordIdx = idx / BITS_PER_WORD;
+	Word word = words[wordIdx] & (~Word(0) << (idx % BITS_PER_WORD));
+	while(word == 0)
+	{
+		if(++wordIdx >= wordCount) {
+			return npos;
+		}
+		word = words[wordIdx];
+	}
+	return wordIdx * BITS_PER_WORD + countTrailingZeros(word);
+}
+
+inline bool BitArray::any() const
+{
+	const Word* words = _words.begin();
+	const uint32_t wordCount = _words.size();
+	for(uint32_t i = 0; i < wordCount; ++i) {
+		if(words[i] != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace df
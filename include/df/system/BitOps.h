@@ -0,0 +1,76 @@
+#pragma once
+#include <df/platform.h>
+#if defined(DF_COMPILER_MSVC)
+	#include <intrin.h>
+#endif
+
+namespace df
+{
+
+/// return true if value is a power of two (0 is not)
+inline bool isPowerOfTwo(uint32 value) { return value != 0 && (value & (value - 1)) == 0; }
+
+/// return the smallest power of two greater or equal to value (value must be <= 2^31)
+inline uint32 nextPowerOfTwo(uint32 value)
+{
+	if(value <= 1) return 1;
+	--value;
+	value |= value >> 1;
+	value |= value >> 2;
+	value |= value >> 4;
+	value |= value >> 8;
+	value |= value >> 16;
+	return value + 1;
+}
+
+/// return the number of bits set in value
+inline uint32 popcount(uint64 value)
+{
+#if defined(DF_COMPILER_GCC)
+	return uint32(__builtin_popcountll(value));
+#else
+	// portable SWAR implementation (__popcnt64 requires the POPCNT instruction)
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return uint32((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/// return the index of the least significant bit set (value must not be 0)
+inline uint32 countTrailingZeros(uint64 value)
+{
+#if defined(DF_COMPILER_GCC)
+	return uint32(__builtin_ctzll(value));
+#elif defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return uint32(index);
+#else
+	unsigned long index;
+	if(_BitScanForward(&index, uint32(value)))
+		return uint32(index);
+	_BitScanForward(&index, uint32(value >> 32));
+	return uint32(index) + 32;
+#endif
+}
+
+/// return the number of leading zero bits (value must not be 0)
+inline uint32 countLeadingZeros(uint64 value)
+{
+#if defined(DF_COMPILER_GCC)
+	return uint32(__builtin_clzll(value));
+#elif defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - uint32(index);
+#else
+	unsigned long index;
+	if(_BitScanReverse(&index, uint32(value >> 32)))
+		return 31 - uint32(index);
+	_BitScanReverse(&index, uint32(value));
+	return 63 - uint32(index);
+#endif
+}
+
+} // namespace df
@@ -0,0 +1,105 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Futex.h>
+#include <df/system/Time.h>
+#include <df/system/Timer.h>
+
+namespace df
+{
+
+/// \brief Block until another thread notifies a change of a state protected by a lock
+/// Works with any lock providing lock() and unlock() (Mutex, FastMutex, AdaptiveMutex ...); the lock
+/// must be held (exactly once for a recursive Mutex) when calling wait. As with any condition variable,
+/// wake ups may be spurious: wait in a loop checking the state, or use the predicate overloads.
+/// The condition is a sequence counter waited on with a futex: notifying without waiter is a single
+/// atomic increment, without system call.
+class ConditionVariable : NonCopyable
+{
+public:
+	ConditionVariable():_sequence(0), _waiterCount(0) {}
+
+	template<class Lock>
+	void wait(Lock& lock)
+	{
+		const uint32 sequence = beginWait();
+		lock.unlock();
+		priv::futexWait(&_sequence, sequence);
+		endWait();
+		lock.lock();
+	}
+
+	/// return false if timeout expired before a notification
+	template<class Lock>
+	bool wait(Lock& lock, Time timeout)
+	{
+		const uint32 sequence = beginWait();
+		lock.unlock();
+		const bool isNotified = priv::futexWait(&_sequence, sequence, timeout);
+		endWait();
+		lock.lock();
+		return isNotified;
+	}
+
+	/// wait until isReady() returns true
+	template<class Lock, class Predicate>
+	void wait(Lock& lock, Predicate isReady)
+	{
+		while(!isReady()) {
+			wait(lock);
+		}
+	}
+
+	/// wait until isReady() returns true, return its last result if timeout expires before
+	template<class Lock, class Predicate>
+	bool wait(Lock& lock, Time timeout, Predicate isReady)
+	{
+		Timer timer;
+		while(!isReady())
+		{
+			const Time remaining = timeout - timer.getElapsedTime();
+			if(remaining <= Time()) {
+				return isReady();
+			}
+			wait(lock, remaining);
+		}
+		return true;
+	}
+
+	void notifyOne()
+	{
+		if(advance()) {
+			priv::futexWakeOne(&_sequence);
+		}
+	}
+	void notifyAll()
+	{
+		if(advance()) {
+			priv::futexWakeAll(&_sequence);
+		}
+	}
+
+private:
+	uint32 beginWait()
+	{
+		priv::atomicFetchAdd(&_waiterCount, uint32(1));
+		// pairs with the fence in advance: either the notifier sees the waiter or we see the new sequence
+		priv::atomicThreadFence();
+		return priv::atomicLoadAcquire(&_sequence);
+	}
+	void endWait() { priv::atomicFetchAdd(&_waiterCount, uint32(-1)); }
+
+	/// move to the next sequence, return true if there are threads to wake up
+	bool advance()
+	{
+		priv::atomicFetchAdd(&_sequence, uint32(1));
+		priv::atomicThreadFence();
+		return priv::atomicLoadAcquire(&_waiterCount) > 0;
+	}
+
+	volatile uint32 _sequence;    ///< incremented by each notification
+	volatile uint32 _waiterCount; ///< threads between beginWait and endWait
+};
+
+} // namespace df
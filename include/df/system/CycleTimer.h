@@ -0,0 +1,44 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+/// \brief Low overhead timer for measuring short operations
+/// Reads the processor time stamp counter (rdtsc) when the processor has an invariant one
+/// (constant rate, not stopped in sleep states), and converts cycles to time with a frequency
+/// calibrated against the clock of Timer. The calibration takes about 10 ms, on the first use.
+/// On other processors it falls back to the clock of Timer, and cycles are then nanoseconds.
+class DF_SYSTEM_API CycleTimer
+{
+public:
+	/// The CycleTimer starts automatically after being constructed.
+	CycleTimer();
+
+	/// Return the elapsed time since the last restart (or constructor).
+	Time getElapsedTime() const;
+	int64 getElapsedNanoseconds() const;
+	uint64 getElapsedCycles() const;
+
+	/// Restart the timer, return the elapsed time
+	Time restart();
+
+	/// Return the current value of the counter (its origin is unspecified)
+	static uint64 getCurrentCycles();
+	/// Same as getCurrentCycles, but wait for the previous instructions to complete first (rdtscp):
+	/// use it to end a measure.
+	static uint64 getCurrentCyclesSerialized();
+
+	/// convert a number of cycles to a duration
+	static int64 toNanoseconds(uint64 cycles);
+	static Time toTime(uint64 cycles);
+	/// number of cycles per second
+	static uint64 getFrequency();
+	/// false if the timer falls back to the clock of Timer
+	static bool isTscUsed();
+
+private:
+	uint64 _startCycles;
+};
+
+} // namespace df
@@ -0,0 +1,76 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+
+// Epoch based reclamation: memory of lock-free structures is freed once no thread can read it.
+// Readers access the shared nodes inside a critical section (EpochGuard). A writer unlinking a node
+// retires it instead of deleting it, the node is freed once every thread in a critical section
+// has entered it after the unlink (the global epoch advanced twice since).
+// Threads register with a domain on their first critical section and unregister at exit (as every
+// df::Thread, through ThreadLocal): the objects they retired and did not free yet are handed over
+// to the domain and freed by the next collections.
+
+namespace df
+{
+
+/// \brief A set of threads and of the objects they retired
+/// A thread in a critical section prevents the epoch from advancing: keep critical sections short
+/// and never block in them.
+class DF_SYSTEM_API EpochDomain : NonCopyable
+{
+public:
+	/// retired objects a thread accumulates before it tries to free some
+	static const uint32 COLLECT_THRESHOLD = 64;
+
+	EpochDomain();
+	/// free the objects still retired, no thread may be in a critical section of the domain
+	~EpochDomain();
+
+	/// begin a critical section of the calling thread, critical sections can be nested
+	/// Costs a load and an atomic exchange (and a lookup of the thread record).
+	void enter();
+	/// end a critical section of the calling thread
+	void leave();
+	/// true if the calling thread is in a critical section
+	bool isInCriticalSection();
+
+	/// free object with deleter(object) once no thread can still read it
+	/// object must already be unreachable from the shared structure. Can be called in a critical section.
+	void retire(void* object, void (*deleter)(void*));
+	/// delete object once no thread can still read it
+	template<class T>
+	void retire(T* object) { retire(object, &deleteObject<T>); }
+
+	/// try to advance the epoch, then free the safe objects retired by the calling thread
+	/// and by the exited threads, return the number of objects freed
+	uint32 collect();
+	/// wait until the objects retired by the calling thread and by the exited threads are freed
+	/// Must not be called in a critical section.
+	void synchronize();
+
+	uint32 getEpoch() const;
+	/// number of objects retired and not freed yet, by all the threads
+	uint32 getRetiredCount() const;
+
+	/// domain used by default by EpochGuard
+	static EpochDomain& getDefault();
+
+private:
+	template<class T>
+	static void deleteObject(void* object) { delete (T*) object; }
+
+	class PrivateData;
+	PrivateData* _data;
+};
+
+/// \brief RAII critical section of an EpochDomain
+class EpochGuard : NonCopyable
+{
+public:
+	explicit EpochGuard(EpochDomain& domain = EpochDomain::getDefault()):_domain(domain) { _domain.enter(); }
+	~EpochGuard() { _domain.leave(); }
+private:
+	EpochDomain& _domain;
+};
+
+} // namespace df
@@ -0,0 +1,54 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+
+/// \brief Signal threads waiting for something to happen
+/// An auto reset event releases a single waiter per set() and goes back to non signaled.
+/// A manual reset event releases all the waiters and stays signaled until reset().
+/// Waiting on a signaled event and setting an event without waiter do not make system calls.
+class DF_SYSTEM_API Event : NonCopyable
+{
+public:
+	enum ResetMode { AUTO_RESET, MANUAL_RESET };
+
+	explicit Event(ResetMode mode = AUTO_RESET, bool isSignaled = false)
+		:_isSignaled(isSignaled ? 1 : 0), _waiterCount(0), _mode(mode) {}
+
+	void set();
+	void reset() { priv::atomicStoreRelease(&_isSignaled, uint32(0)); }
+	bool isSet() const { return priv::atomicLoadAcquire(&_isSignaled) != 0; }
+
+	void wait()
+	{
+		if(!tryWait()) {
+			waitContended();
+		}
+	}
+	/// return false if the event is still not signaled after timeout
+	bool wait(Time timeout);
+	/// return true if the event is signaled (and reset it for an auto reset event), never blocks
+	bool tryWait()
+	{
+		if(_mode == MANUAL_RESET) {
+			return isSet();
+		}
+		uint32 expected = 1;
+		return priv::atomicCompareExchange(&_isSignaled, expected, uint32(0));
+	}
+
+	ResetMode getMode() const { return _mode; }
+
+private:
+	void waitContended();
+
+	volatile uint32 _isSignaled;
+	volatile uint32 _waiterCount; ///< threads parked (or about to) on _isSignaled
+	ResetMode _mode;
+};
+
+} // namespace df
@@ -0,0 +1,71 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/ScopedLock.h>
+
+namespace df
+{
+
+/// \brief Non recursive mutex, without heap allocation
+/// Locking and unlocking without contention is a single atomic operation, a waiting thread is
+/// parked on a futex (Linux) or on its emulation (other platforms).
+class DF_SYSTEM_API FastMutex : NonCopyable
+{
+public:
+	FastMutex():_state(UNLOCKED) {}
+
+	void lock()
+	{
+		uint32 expected = UNLOCKED;
+		if(!priv::atomicCompareExchange(&_state, expected, uint32(LOCKED))) {
+			lockContended();
+		}
+	}
+	bool tryLock()
+	{
+		uint32 expected = UNLOCKED;
+		return priv::atomicCompareExchange(&_state, expected, uint32(LOCKED));
+	}
+	void unlock()
+	{
+		if(priv::atomicExchange(&_state, uint32(UNLOCKED)) == CONTENDED) {
+			wakeWaiter();
+		}
+	}
+
+private:
+	friend class AdaptiveMutex;
+	enum State { UNLOCKED, LOCKED, CONTENDED /* locked, with waiters */ };
+	void lockContended();
+	void wakeWaiter();
+
+	volatile uint32 _state;
+};
+
+/// \brief Non recursive mutex that spins a little before parking
+/// Short critical sections are often released before a thread would be parked, so a waiter spins
+/// first. The spin duration adapts to the time the lock was recently held (as glibc adaptive mutexes).
+class DF_SYSTEM_API AdaptiveMutex : NonCopyable
+{
+public:
+	AdaptiveMutex():_spinEstimate(0) {}
+
+	void lock()
+	{
+		if(!_mutex.tryLock()) {
+			lockContended();
+		}
+	}
+	bool tryLock() { return _mutex.tryLock(); }
+	void unlock() { _mutex.unlock(); }
+
+private:
+	static const uint32 MAX_SPIN_COUNT = 1000;
+	void lockContended();
+
+	FastMutex _mutex;
+	volatile uint32 _spinEstimate; ///< average spin count needed to acquire the lock recently
+};
+
+} // namespace df
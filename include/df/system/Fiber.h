@@ -0,0 +1,106 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/SpinLock.h>
+#include <df/system/Event.h>
+
+// Fibers: user-space threads scheduled cooperatively by a FiberScheduler on a fixed set of
+// worker threads (M fibers on N threads). A fiber runs until it yields, blocks on a FiberMutex or
+// a FiberEvent, or returns; switching fiber does not enter the kernel. A suspended fiber may be
+// resumed by another worker: do not keep the address of thread local data across a switch.
+// Blocking a fiber on an OS primitive (Mutex, Event, sleep) blocks its whole worker.
+
+namespace df
+{
+class Runnable;
+namespace priv { struct Fiber; struct FiberWorker; }
+
+/// \brief Runs fibers on a fixed set of worker threads
+/// Fiber stacks are allocated once and reused by the next fibers (the stack of a fiber is
+/// protected by a guard page where the platform allows it). Ready fibers are resumed in FIFO order.
+class DF_SYSTEM_API FiberScheduler : NonCopyable
+{
+public:
+	static const uint32 DEFAULT_STACK_SIZE = 64 * 1024;
+
+	explicit FiberScheduler(uint32 workerCount, uint32 stackSize = DEFAULT_STACK_SIZE);
+	/// wait for the fibers still running then stop the workers
+	~FiberScheduler();
+
+	uint32 getWorkerCount() const;
+
+	/// start a fiber executing functionPtr(userData) (from any thread, including the fibers)
+	void spawn(void (*functionPtr)(void *), void * userData);
+	/// start a fiber executing the run function of the Runnable object
+	void spawn(Runnable* runnable);
+
+	/// block the calling thread until all the spawned fibers have returned (not from a fiber)
+	void waitAll();
+
+private:
+	friend struct priv::Fiber;
+	friend struct priv::FiberWorker;
+	class PrivateData;
+	PrivateData* _data;
+};
+
+namespace this_fiber
+{
+/// Suspend the calling fiber, it is resumed after the fibers already ready.
+/// Yields the thread when not called from a fiber.
+DF_SYSTEM_API void yield();
+
+/// Return true if the caller runs on a fiber.
+DF_SYSTEM_API bool isFiber();
+}
+
+/// \brief Non recursive mutex suspending the waiting fibers instead of their worker
+/// The lock is handed over to the first waiting fiber on unlock. Threads which are not fibers
+/// may also lock it, they poll and yield while it is held.
+class DF_SYSTEM_API FiberMutex : NonCopyable
+{
+public:
+	FiberMutex():_isLocked(false), _firstWaiter(0), _lastWaiter(0) {}
+	~FiberMutex() {}
+
+	void lock();
+	bool tryLock();
+	void unlock();
+
+private:
+	SpinLock _lock;              ///< protects the members below
+	bool _isLocked;
+	priv::Fiber* _firstWaiter;   ///< FIFO of the suspended fibers
+	priv::Fiber* _lastWaiter;
+};
+
+/// \brief Event suspending the waiting fibers instead of their worker
+/// Same semantics as Event: an auto reset event releases a single waiter per set(), a manual
+/// reset event releases all the waiters and stays signaled until reset().
+/// Threads which are not fibers may also wait, they poll and yield.
+class DF_SYSTEM_API FiberEvent : NonCopyable
+{
+public:
+	explicit FiberEvent(Event::ResetMode mode = Event::AUTO_RESET, bool isSignaled = false)
+		:_isSignaled(isSignaled), _mode(mode), _firstWaiter(0), _lastWaiter(0) {}
+	~FiberEvent() {}
+
+	void set();
+	void reset();
+	bool isSet() const;
+
+	void wait();
+	/// return true if the event is signaled (and reset it for an auto reset event), never suspends
+	bool tryWait();
+
+	Event::ResetMode getMode() const { return _mode; }
+
+private:
+	mutable SpinLock _lock;      ///< protects the members below
+	bool _isSignaled;
+	Event::ResetMode _mode;
+	priv::Fiber* _firstWaiter;   ///< FIFO of the suspended fibers
+	priv::Fiber* _lastWaiter;
+};
+
+} // namespace df
@@ -0,0 +1,22 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+namespace priv
+{
+// Wait for a 32 bits value to change, building block of the locks and events.
+// Native futex on Linux, otherwise emulated with a table of condition variables keyed by address.
+// Wake ups may be spurious: always check the value again after a wait.
+
+/// block while *address is equal to expected
+DF_SYSTEM_API void futexWait(volatile uint32* address, uint32 expected);
+/// block while *address is equal to expected, return false if timeout expired
+DF_SYSTEM_API bool futexWait(volatile uint32* address, uint32 expected, Time timeout);
+/// wake up one of the threads waiting on address
+DF_SYSTEM_API void futexWakeOne(volatile uint32* address);
+/// wake up all the threads waiting on address
+DF_SYSTEM_API void futexWakeAll(volatile uint32* address);
+}
+} // namespace df
@@ -0,0 +1,373 @@
+#pragma once
+#include <assert.h>
+#include <new>
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+#include <df/system/Array.h>
+#include <df/system/ThreadPool.h>
+
+// Future / Promise: a value computed asynchronously.
+// A Promise is fulfilled once by the producer, the Futures obtained from it (they can be copied) read
+// the value once it is ready. Continuations can be chained with then() instead of blocking on get().
+// There is no exception in df_base: a Promise destroyed without value leaves its futures ready but
+// without value (hasValue() is false), continuations of such a future are not called and their own
+// futures have no value either.
+// Shared states are allocated from a pool of recycled blocks, not with a heap allocation per call.
+// Functors given to then() and async() must define result_type (as std::unary_function does).
+
+namespace df
+{
+template<class T> class Future;
+template<class T> class Promise;
+
+namespace priv
+{
+/// allocate size bytes from the recycled blocks of the futures
+DF_SYSTEM_API void* allocateFutureBlock(uint32 size);
+/// give back a block allocated with allocateFutureBlock
+DF_SYSTEM_API void freeFutureBlock(void* block, uint32 size);
+
+class FutureStateBase;
+
+/// work to do when a future state becomes ready
+class DF_SYSTEM_API FutureContinuation
+{
+public:
+	FutureContinuation():_next(0) {}
+	/// called once the state is ready, the continuation must destroy itself
+	virtual void run(FutureStateBase& state) = 0;
+protected:
+	virtual ~FutureContinuation() {}
+private:
+	friend class FutureStateBase;
+	FutureContinuation* _next; ///< registration list of the state
+};
+
+/// state shared by a promise and its futures, reference counted
+class DF_SYSTEM_API FutureStateBase : NonCopyable
+{
+public:
+	FutureStateBase();
+
+	void addRef();
+	void release();
+
+	bool isReady() const;
+	/// true if the state is ready with a value
+	bool hasValue() const;
+
+	void wait();
+	/// return false if the state is still not ready after timeout
+	bool wait(Time timeout);
+
+	/// run continuation when the state becomes ready (immediately if it is already ready)
+	void addContinuation(FutureContinuation* continuation);
+
+protected:
+	virtual ~FutureStateBase() {}
+	/// destroy the value and free the state
+	virtual void destroy() = 0;
+	/// make the state ready, wake up the waiters and run the continuations
+	void complete(bool hasValue);
+
+private:
+	volatile uint32 _refCount;
+	volatile uint32 _status;
+	volatile uint32 _waiterCount; ///< threads blocked in wait
+	FutureContinuation* volatile _continuations;
+};
+
+template<class T>
+class FutureState : public FutureStateBase
+{
+public:
+	/// a new state, with one reference
+	static FutureState* create() { return new (allocateFutureBlock(sizeof(FutureState))) FutureState(); }
+
+	void setValue(const T& value)
+	{
+		new (_storage.bytes) T(value);
+		complete(true);
+	}
+	void setBroken() { complete(false); }
+	const T& getValue() const { assert(hasValue()); return *(const T*) _storage.bytes; }
+
+protected:
+	virtual void destroy()
+	{
+		if(hasValue()) {
+			((T*) _storage.bytes)->~T();
+		}
+		this->~FutureState();
+		freeFutureBlock(this, sizeof(FutureState));
+	}
+
+private:
+	FutureState() {}
+	/// storage for the value, constructed when the promise is fulfilled
+	union Storage
+	{
+		char bytes[sizeof(T)];
+		double alignDouble;
+		int64 alignInteger;
+		void* alignPointer;
+	} _storage;
+};
+
+/// access to the state of futures for the helpers below
+struct FutureAccess
+{
+	template<class T>
+	static FutureState<T>* getState(const Future<T>& future) { return future._state; }
+	/// a future sharing state (which gets one more reference)
+	template<class T>
+	static Future<T> makeFuture(FutureState<T>* state) { return Future<T>(state); }
+};
+
+/// continuation of then(): compute the next value from the ready one
+template<class T, class Func>
+class ThenContinuation : public FutureContinuation
+{
+public:
+	typedef typename Func::result_type R;
+
+	ThenContinuation(Func func, FutureState<R>* result, ThreadPool* pool)
+		:_func(func), _result(result), _source(0), _pool(pool) {}
+
+	virtual void run(FutureStateBase& state)
+	{
+		FutureState<T>& source = static_cast<FutureState<T>&>(state);
+		if(!source.hasValue())
+		{
+			_result->setBroken();
+			finish();
+		}
+		else if(_pool)
+		{
+			// keep the source alive until the task runs
+			_source = &source;
+			_source->addRef();
+			_pool->submit(&ThenContinuation::execute, this);
+		}
+		else
+		{
+			_result->setValue(_func(source.getValue()));
+			finish();
+		}
+	}
+
+private:
+	static void execute(void* userData)
+	{
+		ThenContinuation* continuation = (ThenContinuation*) userData;
+		continuation->_result->setValue(continuation->_func(continuation->_source->getValue()));
+		continuation->_source->release();
+		continuation->finish();
+	}
+
+	void finish()
+	{
+		_result->release();
+		this->~ThenContinuation();
+		freeFutureBlock(this, sizeof(ThenContinuation));
+	}
+
+	Func _func;
+	FutureState<R>* _result;
+	FutureState<T>* _source; ///< only set while waiting for the pool
+	ThreadPool* _pool;       ///< NULL to run the functor on the thread completing the source
+};
+
+/// task of async(): compute a value on a pool worker
+template<class Func>
+class AsyncTask
+{
+public:
+	typedef typename Func::result_type R;
+
+	AsyncTask(Func func, FutureState<R>* result):_func(func), _result(result) {}
+
+	static void execute(void* userData)
+	{
+		AsyncTask* task = (AsyncTask*) userData;
+		task->_result->setValue(task->_func());
+		task->_result->release();
+		task->~AsyncTask();
+		freeFutureBlock(task, sizeof(AsyncTask));
+	}
+
+private:
+	Func _func;
+	FutureState<R>* _result;
+};
+
+/// combination of futures, see when_all and when_any
+class WhenAllShared;
+class WhenAnyShared;
+/// result takes over the reference given by create
+DF_SYSTEM_API WhenAllShared* createWhenAll(FutureState<uint32>* result, uint32 count);
+DF_SYSTEM_API void attachWhenAll(WhenAllShared* shared, FutureStateBase* state);
+DF_SYSTEM_API WhenAnyShared* createWhenAny(FutureState<uint32>* result, uint32 count);
+DF_SYSTEM_API void attachWhenAny(WhenAnyShared* shared, FutureStateBase* state, uint32 index);
+}
+
+/// \brief Read side of an asynchronous value
+/// Copies share the same value. A default constructed future is not valid.
+template<class T>
+class Future
+{
+public:
+	typedef T value_type;
+
+	Future():_state(0) {}
+	Future(const Future& other):_state(other._state) { if(_state) _state->addRef(); }
+	~Future() { if(_state) _state->release(); }
+	Future& operator=(const Future& other)
+	{
+		if(other._state) other._state->addRef();
+		if(_state) _state->release();
+		_state = other._state;
+		return *this;
+	}
+
+	/// true if the future is attached to a promise
+	bool isValid() const { return _state != 0; }
+	bool isReady() const { assert(isValid()); return _state->isReady(); }
+	/// true if the future is ready with a value, false if it is not ready or if the promise was broken
+	bool hasValue() const { assert(isValid()); return _state->hasValue(); }
+
+	void wait() const { assert(isValid()); _state->wait(); }
+	/// return false if the future is still not ready after timeout
+	bool wait(Time timeout) const { assert(isValid()); return _state->wait(timeout); }
+
+	/// wait for the value, the promise cannot be broken
+	const T& get() const
+	{
+		wait();
+		assert(_state->hasValue() && "The promise was destroyed without value");
+		return _state->getValue();
+	}
+	/// wait at most timeout for the value, return false on timeout or broken promise
+	bool get(T& value, Time timeout) const
+	{
+		if(!wait(timeout) || !_state->hasValue()) {
+			return false;
+		}
+		value = _state->getValue();
+		return true;
+	}
+
+	/// future of func(value), func is called on the thread fulfilling this future
+	/// (or immediately by the calling thread if this future is already ready)
+	template<class Func>
+	Future<typename Func::result_type> then(Func func) const { return chain(func, 0); }
+	/// future of func(value), func is executed by a task of pool once this future is ready
+	template<class Func>
+	Future<typename Func::result_type> then(ThreadPool& pool, Func func) const { return chain(func, &pool); }
+
+private:
+	template<class U> friend class Future;
+	template<class U> friend class Promise;
+	friend struct priv::FutureAccess;
+
+	explicit Future(priv::FutureState<T>* state):_state(state) { _state->addRef(); }
+
+	template<class Func>
+	Future<typename Func::result_type> chain(Func func, ThreadPool* pool) const
+	{
+		typedef typename Func::result_type R;
+		typedef priv::ThenContinuation<T, Func> Continuation;
+		assert(isValid());
+		priv::FutureState<R>* result = priv::FutureState<R>::create();
+		Future<R> future(result);
+		void* block = priv::allocateFutureBlock(sizeof(Continuation));
+		_state->addContinuation(new (block) Continuation(func, result, pool));
+		return future;
+	}
+
+	priv::FutureState<T>* _state;
+};
+
+/// \brief Write side of an asynchronous value
+template<class T>
+class Promise : NonCopyable
+{
+public:
+	Promise():_state(priv::FutureState<T>::create()) {}
+	/// a promise destroyed without value leaves its futures ready without value
+	~Promise()
+	{
+		if(!_state->isReady()) {
+			_state->setBroken();
+		}
+		_state->release();
+	}
+
+	Future<T> getFuture() const { return Future<T>(_state); }
+
+	/// fulfill the promise: wake up the threads waiting for the value and run the continuations
+	void setValue(const T& value)
+	{
+		assert(!_state->isReady() && "A promise can only be fulfilled once");
+		_state->setValue(value);
+	}
+
+private:
+	priv::FutureState<T>* _state;
+};
+
+/// future of func(), executed by a task of pool
+template<class Func>
+Future<typename Func::result_type> async(ThreadPool& pool, Func func)
+{
+	typedef typename Func::result_type R;
+	typedef priv::AsyncTask<Func> Task;
+	priv::FutureState<R>* result = priv::FutureState<R>::create();
+	Future<R> future = priv::FutureAccess::makeFuture(result);
+	Task* task = new (priv::allocateFutureBlock(sizeof(Task))) Task(func, result);
+	pool.submit(&Task::execute, task);
+	return future;
+}
+
+/// future ready when all the futures are ready, its value is the number of futures having a value
+template<class T>
+Future<uint32> when_all(const Future<T>* futures, uint32 count)
+{
+	priv::FutureState<uint32>* result = priv::FutureState<uint32>::create();
+	Future<uint32> future = priv::FutureAccess::makeFuture(result);
+	priv::WhenAllShared* shared = priv::createWhenAll(result, count);
+	for(uint32 i = 0; i < count; ++i) {
+		priv::attachWhenAll(shared, priv::FutureAccess::getState(futures[i]));
+	}
+	return future;
+}
+
+template<class T, uint32_t ALIGNMENT>
+Future<uint32> when_all(const Array<Future<T>, ALIGNMENT>& futures)
+{
+	return when_all(futures.begin(), futures.size());
+}
+
+/// future ready as soon as one of the futures is ready, its value is the index of this future
+/// count cannot be 0
+template<class T>
+Future<uint32> when_any(const Future<T>* futures, uint32 count)
+{
+	assert(count > 0);
+	priv::FutureState<uint32>* result = priv::FutureState<uint32>::create();
+	Future<uint32> future = priv::FutureAccess::makeFuture(result);
+	priv::WhenAnyShared* shared = priv::createWhenAny(result, count);
+	for(uint32 i = 0; i < count; ++i) {
+		priv::attachWhenAny(shared, priv::FutureAccess::getState(futures[i]), i);
+	}
+	return future;
+}
+
+template<class T, uint32_t ALIGNMENT>
+Future<uint32> when_any(const Array<Future<T>, ALIGNMENT>& futures)
+{
+	return when_any(futures.begin(), futures.size());
+}
+
+} // namespace df
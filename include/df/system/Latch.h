@@ -0,0 +1,49 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+
+/// \brief Single use countdown: threads wait until the count reaches 0
+class DF_SYSTEM_API Latch : NonCopyable
+{
+public:
+	explicit Latch(uint32 count):_count(count) {}
+
+	/// decrement the count, the thread reaching 0 releases the waiters
+	void countDown(uint32 count = 1);
+	bool isReady() const { return priv::atomicLoadAcquire(&_count) == 0; }
+
+	void wait();
+	/// return false if the count is still not 0 after timeout
+	bool wait(Time timeout);
+	/// countDown then wait
+	void arriveAndWait(uint32 count = 1);
+
+private:
+	volatile uint32 _count;
+};
+
+/// \brief Reusable rendezvous of a fixed number of threads
+/// Each thread calling arriveAndWait blocks until all the threads of the phase have arrived,
+/// then the barrier is ready for the next phase.
+class DF_SYSTEM_API Barrier : NonCopyable
+{
+public:
+	explicit Barrier(uint32 threadCount):_threadCount(threadCount), _remaining(threadCount), _phase(0) {}
+
+	/// return true for exactly one thread of each phase (the last to arrive)
+	bool arriveAndWait();
+
+	uint32 getThreadCount() const { return _threadCount; }
+
+private:
+	const uint32 _threadCount;
+	volatile uint32 _remaining; ///< threads not arrived yet in the current phase
+	volatile uint32 _phase;     ///< incremented when all the threads arrived
+};
+
+} // namespace df
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdio.h>
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+/// \brief Distribution of durations, for percentiles of latencies (HDR histogram style)
+/// Counts the samples in logarithmic buckets split in 128 linear sub-buckets: every value from
+/// 1 ns to about 9.7 hours (getHighestTrackableValue) is recorded with a relative error below 1%.
+/// Threads record concurrently without locking, each one in its own shard of the buckets; the shards
+/// are merged when the histogram is read. The first record of a thread allocates its shard, the next
+/// ones neither allocate nor lock and take constant time. Reads are consistent once recording stopped,
+/// and see some of the samples being recorded otherwise.
+class DF_SYSTEM_API LatencyHistogram : NonCopyable
+{
+public:
+	LatencyHistogram();
+	/// must not be destroyed while other threads are recording or exiting
+	~LatencyHistogram();
+
+	/// add count samples of latency, negative latencies count as 0, longer ones than
+	/// getHighestTrackableValue as getHighestTrackableValue
+	void record(Time latency, uint64 count = 1);
+
+	/// add the samples of other
+	void merge(const LatencyHistogram& other);
+	/// remove all the samples (the samples being recorded meanwhile may be kept)
+	void reset();
+
+	uint64 getCount() const;
+	/// exact minimum, maximum and mean of the samples, 0 if there is none
+	Time getMin() const;
+	Time getMax() const;
+	Time getMean() const;
+	/// latency which percentile % of the samples do not exceed (percentile in [0, 100]), 0 if there is no sample
+	Time getPercentile(double percentile) const;
+
+	/// write count, min, mean, max and the usual percentiles (p50 to p99.99) on a few lines
+	void writeText(FILE* file) const;
+	/// write "latency_ns,count,percentile" and one line per non empty bucket, with its highest value
+	/// and the percentage of samples up to it
+	void writeCsv(FILE* file) const;
+
+	static Time getHighestTrackableValue();
+
+private:
+	class PrivateData;
+	PrivateData* _data;
+};
+
+} // namespace df
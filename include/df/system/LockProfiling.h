@@ -0,0 +1,70 @@
+#pragma once
+#include <stdio.h>
+#include <df/system/Export.h>
+#include <df/system/Atomic.h>
+#include <df/system/Time.h>
+
+// Contention profiling of df::Mutex, enabled by defining DF_MUTEX_PROFILING for the whole build
+// (premake4 --mutex-profiling). Each Mutex then registers itself (with the name given to its
+// constructor) and counts its acquisitions, the contended ones and the time spent waiting for it.
+// An uncontended lock only adds a thread local read and a few relaxed stores; a contended one
+// also reads the clock twice. Without DF_MUTEX_PROFILING, Mutex is not instrumented at all and the
+// functions below report nothing.
+
+namespace df
+{
+
+/// \brief Snapshot of the statistics of a profiled Mutex
+struct DF_SYSTEM_API LockStatistics
+{
+	LockStatistics():lock(0), acquisitionCount(0), contentionCount(0), holderThreadID(0) { name[0] = 0; }
+
+	char name[32];           ///< empty for a mutex constructed without name
+	const void* lock;        ///< address of the mutex
+	uint64 acquisitionCount; ///< successful lock and tryLock, recursive ones included
+	uint64 contentionCount;  ///< lock calls which had to wait
+	Time totalWaitTime;
+	Time maxWaitTime;
+	uint32 holderThreadID;   ///< this_thread::getID() of the thread holding the mutex, 0 if it is free
+};
+
+namespace lock_profiling
+{
+/// true if the build defines DF_MUTEX_PROFILING
+DF_SYSTEM_API bool isEnabled();
+
+/// copy the statistics of up to maxCount live mutexes, return the number of live mutexes
+DF_SYSTEM_API uint32 getStatistics(LockStatistics* statistics, uint32 maxCount);
+
+/// zero the counters of all the mutexes (a mutex locked meanwhile may keep some of its counts)
+DF_SYSTEM_API void reset();
+
+/// print one line per mutex acquired at least once, the longest total wait first
+DF_SYSTEM_API void dump(FILE* file);
+}
+
+namespace priv
+{
+/// statistics of a profiled mutex, only written by the thread holding it
+struct DF_SYSTEM_API LockRecord
+{
+	LockRecord():lock(0), depth(0), previous(0), next(0) { name[0] = 0; }
+
+	char name[32];
+	const void* lock;
+	Atomic<uint64> acquisitionCount;
+	Atomic<uint64> contentionCount;
+	Atomic<int64> totalWaitTime;  ///< in nanoseconds
+	Atomic<int64> maxWaitTime;    ///< in nanoseconds
+	Atomic<uint32> holderThreadID;
+	uint32 depth;                 ///< recursion depth of the holder
+	LockRecord* previous;         ///< registry of the live mutexes
+	LockRecord* next;
+};
+
+/// add a mutex to the registry, name can be NULL
+DF_SYSTEM_API LockRecord* registerLock(const void* lock, const char* name);
+DF_SYSTEM_API void unregisterLock(LockRecord* record);
+}
+
+} // namespace df
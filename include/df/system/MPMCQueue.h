@@ -0,0 +1,305 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <new>
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/BitOps.h>
+#include <df/system/Atomic.h>
+#include <df/system/Event.h>
+#include <df/system/Timer.h>
+
+namespace df
+{
+
+/// Fixed capacity, lock-free, multiple producers / multiple consumers queue (D. Vyukov bounded queue).
+/// Each cell holds a sequence number telling whether it is ready to be written or read for the
+/// current lap, so producers and consumers only contend on their own position counter and never
+/// take a lock. Elements are popped in push order (per producer).
+template<class T>
+class MPMCQueue : NonCopyable
+{
+public:
+	/// capacity is rounded up to the next power of two
+	explicit MPMCQueue(uint32_t capacity);
+	~MPMCQueue();
+
+	uint32_t capacity() const { return _mask + 1; }
+	/// approximate number of elements, exact when no thread is pushing or popping
+	uint32_t size() const;
+	bool empty() const { return size() == 0; }
+
+	/// Pushes value, return false if the queue is full.
+	bool try_push(const T& value);
+	/// Pushes up to count values in a row, return the number of values pushed.
+	uint32_t try_push(const T* values, uint32_t count);
+
+	/// Pops the front value into value, return false if the queue is empty.
+	bool try_pop(T& value);
+	/// Pops up to maxCount values in a row into values, return the number of values popped.
+	uint32_t try_pop(T* values, uint32_t maxCount);
+
+private:
+	struct Cell
+	{
+		/// position + 1 once written, position + capacity once read (ready for the next lap)
+		Atomic<uint32_t> sequence;
+		union Storage
+		{
+			char bytes[sizeof(T)];
+			double alignDouble;
+			int64 alignInteger;
+			void* alignPointer;
+		} storage;
+		T* get() { return (T*) storage.bytes; }
+	};
+
+	/// claim up to count cells from position, whose sequence is position + offset
+	uint32_t claim(Atomic<uint32_t>& position, uint32_t offset, uint32_t count, uint32_t& first);
+
+	char _pad0[DF_CACHE_LINE_SIZE];
+	Atomic<uint32_t> _enqueuePosition;
+	char _pad1[DF_CACHE_LINE_SIZE - sizeof(Atomic<uint32_t>)];
+	Atomic<uint32_t> _dequeuePosition;
+	char _pad2[DF_CACHE_LINE_SIZE - sizeof(Atomic<uint32_t>)];
+
+	// read-only after construction
+	Cell* _cells;
+	uint32_t _mask;
+	char _pad3[DF_CACHE_LINE_SIZE - sizeof(Cell*) - sizeof(uint32_t)];
+};
+
+template<class T>
+MPMCQueue<T>::MPMCQueue(uint32_t capacity)
+{
+	capacity = nextPowerOfTwo(capacity > 2 ? capacity : 2);
+	assert(capacity <= 0x80000000u && "MPMCQueue capacity is too large");
+	_cells = new Cell[capacity];
+	for(uint32_t i = 0; i < capacity; ++i) {
+		_cells[i].sequence.store(i, MEMORY_ORDER_RELAXED);
+	}
+	_mask = capacity - 1;
+}
+
+template<class T>
+MPMCQueue<T>::~MPMCQueue()
+{
+	const uint32_t end = _enqueuePosition.load(MEMORY_ORDER_RELAXED);
+	for(uint32_t i = _dequeuePosition.load(MEMORY_ORDER_RELAXED); i != end; ++i) {
+		_cells[i & _mask].get()->~T();
+	}
+	delete [] _cells;
+}
+
+template<class T>
+uint32_t MPMCQueue<T>::size() const
+{
+	const uint32_t dequeuePosition = _dequeuePosition.load(MEMORY_ORDER_ACQUIRE);
+	const int32_t size = int32_t(_enqueuePosition.load(MEMORY_ORDER_ACQUIRE) - dequeuePosition);
+	return (size > 0) ? uint32_t(size) : 0;
+}
+
+template<class T>
+uint32_t MPMCQueue<T>::claim(Atomic<uint32_t>& position, uint32_t offset, uint32_t count, uint32_t& first)
+{
+	if(count == 0) {
+		return 0;
+	}
+	uint32_t current = position.load(MEMORY_ORDER_RELAXED);
+	for(;;)
+	{
+		// count the ready cells in a row: they stay ready as long as position does not move
+		uint32_t readyCount = 0;
+		for(; readyCount < count; ++readyCount)
+		{
+			const uint32_t sequence = _cells[(current + readyCount) & _mask].sequence.load(MEMORY_ORDER_ACQUIRE);
+			const int32_t difference = int32_t(sequence - (current + readyCount + offset));
+			if(difference != 0) {
+				break;
+			}
+		}
+		if(readyCount == 0)
+		{
+			const uint32_t sequence = _cells[current & _mask].sequence.load(MEMORY_ORDER_ACQUIRE);
+			if(int32_t(sequence - (current + offset)) < 0) {
+				// the cell is still used by the previous lap: full (or empty)
+				return 0;
+			}
+			// another thread took the cell, try the next position
+			current = position.load(MEMORY_ORDER_RELAXED);
+			continue;
+		}
+		if(position.compareExchangeWeak(current, current + readyCount, MEMORY_ORDER_RELAXED))
+		{
+			first = current;
+			return readyCount;
+		}
+	}
+}
+
+template<class T>
+bool MPMCQueue<T>::try_push(const T& value)
+{
+	return try_push(&value, 1) == 1;
+}
+
+template<class T>
+uint32_t MPMCQueue<T>::try_push(const T* values, uint32_t count)
+{
+	uint32_t first = 0;
+	count = claim(_enqueuePosition, 0, count, first);
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		Cell& cell = _cells[(first + i) & _mask];
+		new (cell.get()) T(values[i]);
+		cell.sequence.store(first + i + 1, MEMORY_ORDER_RELEASE);
+	}
+	return count;
+}
+
+template<class T>
+bool MPMCQueue<T>::try_pop(T& value)
+{
+	return try_pop(&value, 1) == 1;
+}
+
+template<class T>
+uint32_t MPMCQueue<T>::try_pop(T* values, uint32_t maxCount)
+{
+	uint32_t first = 0;
+	const uint32_t count = claim(_dequeuePosition, 1, maxCount, first);
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		Cell& cell = _cells[(first + i) & _mask];
+		values[i] = *cell.get();
+		cell.get()->~T();
+		cell.sequence.store(first + i + _mask + 1, MEMORY_ORDER_RELEASE);
+	}
+	return count;
+}
+
+/// \brief MPMCQueue whose push and pop block while the queue is full or empty
+/// The try variants stay available. Waiting threads are parked on an event, the uncontended
+/// push and pop only add an atomic load of the waiter count.
+template<class T>
+class BlockingMPMCQueue : NonCopyable
+{
+public:
+	explicit BlockingMPMCQueue(uint32_t capacity):_queue(capacity) {}
+
+	uint32_t capacity() const { return _queue.capacity(); }
+	uint32_t size() const { return _queue.size(); }
+	bool empty() const { return _queue.empty(); }
+
+	bool try_push(const T& value)
+	{
+		if(!_queue.try_push(value)) {
+			return false;
+		}
+		onPushed();
+		return true;
+	}
+	uint32_t try_push(const T* values, uint32_t count)
+	{
+		count = _queue.try_push(values, count);
+		if(count > 0) {
+			onPushed();
+		}
+		return count;
+	}
+	bool try_pop(T& value)
+	{
+		if(!_queue.try_pop(value)) {
+			return false;
+		}
+		onPopped();
+		return true;
+	}
+	uint32_t try_pop(T* values, uint32_t maxCount)
+	{
+		const uint32_t count = _queue.try_pop(values, maxCount);
+		if(count > 0) {
+			onPopped();
+		}
+		return count;
+	}
+
+	/// wait for a free cell
+	void push(const T& value)
+	{
+		while(!try_push(value))
+		{
+			_pushWaiterCount.fetchAdd(1);
+			// pairs with the fence in onPopped: either the consumer sees the waiter or we see the free cell
+			priv::atomicThreadFence();
+			if(_queue.size() >= _queue.capacity()) {
+				_notFull.wait();
+			}
+			_pushWaiterCount.fetchSub(1);
+		}
+	}
+	/// wait for an element
+	void pop(T& value)
+	{
+		while(!try_pop(value))
+		{
+			_popWaiterCount.fetchAdd(1);
+			priv::atomicThreadFence();
+			if(_queue.empty()) {
+				_notEmpty.wait();
+			}
+			_popWaiterCount.fetchSub(1);
+		}
+	}
+	/// wait at most timeout for an element, return false if there was none
+	bool pop(T& value, Time timeout)
+	{
+		Timer timer;
+		while(!try_pop(value))
+		{
+			const Time remaining = timeout - timer.getElapsedTime();
+			if(remaining <= Time()) {
+				return false;
+			}
+			_popWaiterCount.fetchAdd(1);
+			priv::atomicThreadFence();
+			if(_queue.empty()) {
+				_notEmpty.wait(remaining);
+			}
+			_popWaiterCount.fetchSub(1);
+		}
+		return true;
+	}
+
+private:
+	void onPushed()
+	{
+		priv::atomicThreadFence();
+		if(_popWaiterCount.load(MEMORY_ORDER_RELAXED) > 0) {
+			_notEmpty.set();
+		}
+		// an auto reset event releases a single waiter per set: pass the signal on if there is more room
+		if(_queue.size() < _queue.capacity() && _pushWaiterCount.load(MEMORY_ORDER_RELAXED) > 0) {
+			_notFull.set();
+		}
+	}
+	void onPopped()
+	{
+		priv::atomicThreadFence();
+		if(_pushWaiterCount.load(MEMORY_ORDER_RELAXED) > 0) {
+			_notFull.set();
+		}
+		// an auto reset event releases a single waiter per set: pass the signal on if there is more to pop
+		if(!_queue.empty() && _popWaiterCount.load(MEMORY_ORDER_RELAXED) > 0) {
+			_notEmpty.set();
+		}
+	}
+
+	MPMCQueue<T> _queue;
+	Atomic<uint32> _pushWaiterCount;
+	Atomic<uint32> _popWaiterCount;
+	Event _notFull;
+	Event _notEmpty;
+};
+
+} // namespace df
@@ -0,0 +1,250 @@
+#pragma once
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/MappedFile.h>
+
+namespace df
+{
+namespace priv
+{
+/// header at the start of a MappedArray file, the elements follow it
+struct MappedArrayHeader
+{
+	static const uint32 MAGIC = 0x414D4644; ///< "DFMA"
+	static const uint32 VERSION = 1;
+
+	uint32 magic;
+	uint32 version;
+	uint32 elementSize; ///< sizeof(T) of the writer
+	uint32 alignment;   ///< ALIGNMENT of the writer
+	uint64 size;        ///< number of elements in use
+	uint64 capacity;    ///< number of elements the file can hold
+	uint8 reserved[32]; ///< pad to 64 bytes, so that elements are aligned on up to 64 bytes
+};
+}
+
+/// An array stored in a memory mapped file.
+/// Opening the file maps it: the content is available without being parsed or copied,
+/// and in MAP_READ_WRITE mode every modification goes to the file.
+/// Only suitable for plain data types (no pointer, no constructor/destructor), since the
+/// elements are written to disk as raw bytes. The file layout depends on the machine endianness.
+/// Any growth may remap the file: pointers and references to elements are invalidated as with Array.
+template<class T, uint32_t ALIGNMENT = 4>
+class MappedArray : NonCopyable
+{
+	static const uint32_t MINIMAL_SIZE = 8;
+	static const uint32_t HEADER_SIZE = sizeof(priv::MappedArrayHeader);
+	/// elements start right after the header, it cannot satisfy a larger alignment
+	typedef char alignment_check[(HEADER_SIZE % ALIGNMENT == 0) ? 1 : -1];
+public:
+	MappedArray():_header(0), _data(0) {}
+
+	/*! open and map the file
+	 *  /remark in MAP_READ_WRITE mode a missing or empty file is initialized as an empty array
+	 *  /return false if the file cannot be mapped or was not written by a MappedArray of the same element size and alignment
+	*/
+	bool open(const char* path, MappedFile::MapMode mode);
+	void close();
+	bool isOpen() const { return _header != 0; }
+	/// write the modified elements back to the file
+	bool flush() { return _file.flush(); }
+
+	uint32_t size() const { return isOpen() ? uint32_t(_header->size) : 0; }
+	uint32_t reserved_size() const { return isOpen() ? uint32_t(_header->capacity) : 0; }
+	bool empty() const { return size() == 0; }
+
+	/// Makes sure that the file has at least the specified capacity. (If not, the file is grown and remapped.)
+	bool reserve(uint32_t reserved_size);
+	/// Changes the size of the array, new elements are zero filled.
+	bool resize(uint32_t new_size);
+	bool resize(uint32_t new_size, const T& default_value);
+	/// set size to 0 (the file keeps its capacity)
+	void clear() { assert(isWritable()); _header->size = 0; }
+	/// Shrinks the file so that its capacity matches its size.
+	bool trim();
+
+	// *** element operations ***
+	T& operator[](uint32_t idx)             { assert(idx < size()); return _data[idx]; }
+	const T& operator[](uint32_t idx) const { assert(idx < size()); return _data[idx]; }
+	//just for convenience
+	T& operator[](int idx)             { assert(idx >= 0); return operator[](uint32_t(idx)); }
+	const T& operator[](int idx) const { assert(idx >= 0); return operator[](uint32_t(idx)); }
+
+	/// Used to iterate over the array.
+	T* begin() { return _data; }
+	T* end()   { return _data + size(); }
+	const T* begin() const  { return _data; }
+	const T* end() const    { return _data + size(); }
+
+	/// Pushes the item to the end of the array.
+	bool push_back(const T& value);
+	/// Pops the last item from the array. The array cannot be empty.
+	void pop_back() { assert(isWritable() && !empty()); --_header->size; }
+
+private:
+	bool isWritable() const { return isOpen() && _file.getMode() == MappedFile::MAP_READ_WRITE; }
+	/// resize the file to hold capacity elements and refresh the pointers
+	bool remap(uint32_t capacity);
+	void updatePointers();
+
+	MappedFile _file;
+	priv::MappedArrayHeader* _header; ///< start of the mapping, NULL when closed
+	T* _data;
+};
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::open(const char* path, MappedFile::MapMode mode)
+{
+	close();
+	if(!_file.open(path, mode)) {
+		return false;
+	}
+
+	if(_file.getSize() == 0 && mode == MappedFile::MAP_READ_WRITE)
+	{
+		// new file
+		if(!_file.resize(HEADER_SIZE)) {
+			_file.close();
+			return false;
+		}
+		priv::MappedArrayHeader* header = (priv::MappedArrayHeader*) _file.getData();
+		memset(header, 0, HEADER_SIZE);
+		header->magic = priv::MappedArrayHeader::MAGIC;
+		header->version = priv::MappedArrayHeader::VERSION;
+		header->elementSize = sizeof(T);
+		header->alignment = ALIGNMENT;
+	}
+
+	// validate the header before trusting it
+	const priv::MappedArrayHeader* header = (const priv::MappedArrayHeader*) _file.getData();
+	const bool isValid = _file.getSize() >= HEADER_SIZE
+		&& header->magic == priv::MappedArrayHeader::MAGIC
+		&& header->version == priv::MappedArrayHeader::VERSION
+		&& header->elementSize == sizeof(T)
+		&& header->alignment == ALIGNMENT
+		&& header->size <= header->capacity
+		&& header->capacity <= 0xFFFFFFFF
+		&& HEADER_SIZE + header->capacity * sizeof(T) <= _file.getSize();
+	if(!isValid)
+	{
+		_file.close();
+		return false;
+	}
+	updatePointers();
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void MappedArray<T, ALIGNMENT>::close()
+{
+	_file.close();
+	_header = 0;
+	_data = 0;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void MappedArray<T, ALIGNMENT>::updatePointers()
+{
+	_header = (priv::MappedArrayHeader*) _file.getData();
+	_data = (T*) ((char*) _header + HEADER_SIZE);
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::remap(uint32_t capacity)
+{
+	if(!_file.resize(HEADER_SIZE + uint64(capacity) * sizeof(T)))
+	{
+		// the file may have been unmapped
+		if(_file.getData() == 0) {
+			close();
+		} else {
+			updatePointers();
+		}
+		return false;
+	}
+	updatePointers();
+	_header->capacity = capacity;
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::reserve(uint32_t new_size)
+{
+	assert(isWritable());
+	const uint32_t reserved = reserved_size();
+	if (new_size <= reserved) {
+		return true;
+	}
+	// same growth strategy as Array: grow aggressively up to 64k, less aggressively up to 400k,
+	// and then 1.5x per resize. Growing the file is costlier than a reallocation, so the first
+	// reservation is not exact.
+	const size_t old_size_bytes = reserved * sizeof(T);
+	uint32_t new_reserved_size = (reserved * 3);
+	if (old_size_bytes > 400000) {
+		new_reserved_size >>= 1;
+	} else if (old_size_bytes > 64000) {
+		new_reserved_size = reserved << 1;
+	}
+	if(new_reserved_size < MINIMAL_SIZE) new_reserved_size = MINIMAL_SIZE;
+	if(new_reserved_size < new_size) new_reserved_size = new_size;
+
+	return remap(new_reserved_size);
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::resize(uint32_t new_size)
+{
+	const uint32_t old_size = size();
+	if(!reserve(new_size)) {
+		return false;
+	}
+	if(new_size > old_size) {
+		memset(_data + old_size, 0, (new_size - old_size) * sizeof(T));
+	}
+	_header->size = new_size;
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::resize(uint32_t new_size, const T& default_value)
+{
+	const uint32_t old_size = size();
+	if(!reserve(new_size)) {
+		return false;
+	}
+	for(uint32_t i = old_size; i < new_size; ++i) {
+		_data[i] = default_value;
+	}
+	_header->size = new_size;
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::trim()
+{
+	assert(isWritable());
+	return size() == reserved_size() || remap(size());
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool MappedArray<T, ALIGNMENT>::push_back(const T& value)
+{
+	const uint32_t old_size = size();
+	if(old_size == reserved_size())
+	{
+		// value may live in the array, keep a copy across the remap
+		const T copy = value;
+		if(!reserve(old_size + 1)) {
+			return false;
+		}
+		_data[old_size] = copy;
+	} else {
+		_data[old_size] = value;
+	}
+	_header->size = old_size + 1;
+	return true;
+}
+
+} // namespace df
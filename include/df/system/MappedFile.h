@@ -0,0 +1,51 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+
+namespace df
+{
+namespace priv
+{
+    class MappedFileImpl;
+}
+
+/// \brief A file mapped in memory
+/// The whole file is mapped, its content is accessed through getData().
+class DF_SYSTEM_API MappedFile : NonCopyable
+{
+public:
+	//! access mode of the mapping
+	enum MapMode{ MAP_READ_ONLY, MAP_READ_WRITE };
+
+	MappedFile();
+	/// unmap and close the file
+	~MappedFile();
+
+	/*! open and map the file
+	 *  /remark in MAP_READ_WRITE mode the file is created if it does not exist
+	 *  /return false if the file cannot be opened or mapped
+	*/
+	bool open(const char* path, MapMode mode);
+	void close();
+
+	bool isOpen() const;
+	MapMode getMode() const;
+
+	/// start of the mapping, NULL when the file is empty
+	void* getData() const;
+	uint64 getSize() const;
+
+	/*! change the size of the file and remap it (MAP_READ_WRITE only)
+	 *  /remark the mapping address may change, previous pointers to the data are invalidated
+	*/
+	bool resize(uint64 size);
+
+	/// write the modified pages back to the file
+	bool flush();
+
+private:
+	priv::MappedFileImpl* _mappedFileImpl; ///< OS-specific implementation
+	MapMode _mode;
+};
+
+} // namespace df
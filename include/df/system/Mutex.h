@@ -1,19 +1,24 @@
 #pragma once
 #include <df/system/Export.h>
 #include <df/system/NonCopyable.h>
+#include <df/system/ScopedLock.h>
 
 namespace df
 {
 namespace priv
 {
     class MutexImpl;
+    struct LockRecord;
 }
 
 /// \brief Recursive mutex
+/// Builds defining DF_MUTEX_PROFILING record its contention statistics (see LockProfiling.h).
 class DF_SYSTEM_API Mutex : NonCopyable
 {
 public :
     Mutex();
+    /// name of the mutex in the lock profiling reports, ignored without DF_MUTEX_PROFILING
+    explicit Mutex(const char* name);
     ~Mutex();
 
     void lock();
@@ -22,16 +27,9 @@ public :
 
 private :    
     priv::MutexImpl* _mutexImpl; ///< OS-specific implementation
-};
-
-/// RAII scoped lock
-class DF_SYSTEM_API ScopedLock : NonCopyable
-{
-public :
-	explicit ScopedLock(Mutex& mutex):_mutex(mutex) { _mutex.lock(); }
-    ~ScopedLock(){ _mutex.unlock(); }
-private :
-    Mutex& _mutex;
+#if defined(DF_MUTEX_PROFILING)
+    priv::LockRecord* _lockRecord;
+#endif
 };
 
 } // namespace df
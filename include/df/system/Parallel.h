@@ -0,0 +1,309 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <df/system/Export.h>
+#include <df/system/ThreadPool.h>
+#include <df/system/Array.h>
+#include <df/system/ArrayView.h>
+
+// Parallel algorithms over Array / ArrayView.
+// The range is split in chunks of grainSize elements (0 = automatic) which are processed
+// by the pool workers and by the calling thread. All the functions return once the whole range is processed.
+// Functors are copied (as with the standard algorithms) and must be safe to call concurrently.
+// They can be nested: a task running on the pool may call them with the same pool.
+
+namespace df
+{
+namespace priv
+{
+/// a piece of work on a sub range [begin, end)
+class RangeTask
+{
+public:
+	virtual void run(uint32 begin, uint32 end) = 0;
+	virtual ~RangeTask(){}
+};
+
+/// split [0, count) in chunks of grainSize and run them on the pool workers and the calling thread
+DF_SYSTEM_API void parallelRun(ThreadPool& pool, RangeTask& task, uint32 count, uint32 grainSize);
+/// grain size actually used by parallelRun
+DF_SYSTEM_API uint32 parallelGrainSize(const ThreadPool& pool, uint32 count, uint32 grainSize);
+
+template<class Func>
+class ForRangeTask : public RangeTask
+{
+public:
+	ForRangeTask(Func& func):_func(func) {}
+	virtual void run(uint32 begin, uint32 end) { _func(begin, end); }
+private:
+	Func& _func;
+};
+
+template<class T, class Func>
+class ForEachTask : public RangeTask
+{
+public:
+	ForEachTask(T* data, Func& func):_data(data), _func(func) {}
+	virtual void run(uint32 begin, uint32 end) { for(uint32 i = begin; i < end; ++i) _func(_data[i]); }
+private:
+	T* _data;
+	Func& _func;
+};
+
+template<class T, class U, class Func>
+class TransformTask : public RangeTask
+{
+public:
+	TransformTask(const T* src, U* dst, Func& func):_src(src), _dst(dst), _func(func) {}
+	virtual void run(uint32 begin, uint32 end) { for(uint32 i = begin; i < end; ++i) _dst[i] = _func(_src[i]); }
+private:
+	const T* _src;
+	U* _dst;
+	Func& _func;
+};
+
+template<class T, class Func>
+class ReduceTask : public RangeTask
+{
+public:
+	ReduceTask(const T* data, const T& identity, Func& func, T* partials, uint32 grainSize)
+		:_data(data), _identity(identity), _func(func), _partials(partials), _grainSize(grainSize) {}
+	virtual void run(uint32 begin, uint32 end)
+	{
+		T acc = _identity;
+		for(uint32 i = begin; i < end; ++i) {
+			acc = _func(acc, _data[i]);
+		}
+		_partials[begin / _grainSize] = acc;
+	}
+private:
+	const T* _data;
+	const T& _identity;
+	Func& _func;
+	T* _partials;
+	uint32 _grainSize;
+};
+
+/// sort each chunk independently
+template<class T, class Compare>
+class SortChunkTask : public RangeTask
+{
+public:
+	SortChunkTask(T* data, Compare& comp):_data(data), _comp(comp) {}
+	virtual void run(uint32 begin, uint32 end) { std::sort(_data + begin, _data + end, _comp); }
+private:
+	T* _data;
+	Compare& _comp;
+};
+
+/// merge pairs of sorted runs of width elements from src into dst
+template<class T, class Compare>
+class MergeTask : public RangeTask
+{
+public:
+	MergeTask(const T* src, T* dst, uint32 width, Compare& comp):_src(src), _dst(dst), _width(width), _comp(comp) {}
+	virtual void run(uint32 begin, uint32 end)
+	{
+		const uint32 middle = (end - begin > _width) ? begin + _width : end;
+		std::merge(_src + begin, _src + middle, _src + middle, _src + end, _dst + begin, _comp);
+	}
+private:
+	const T* _src;
+	T* _dst;
+	uint32 _width;
+	Compare& _comp;
+};
+
+/// radix sort pass, step 1: per chunk histogram of the current digit
+template<class T>
+class RadixHistogramTask : public RangeTask
+{
+public:
+	RadixHistogramTask(const T* src, uint32* histograms, uint32 shift, uint32 grainSize)
+		:_src(src), _histograms(histograms), _shift(shift), _grainSize(grainSize) {}
+	virtual void run(uint32 begin, uint32 end)
+	{
+		uint32* histogram = _histograms + (begin / _grainSize) * 256;
+		for(uint32 i = 0; i < 256; ++i) histogram[i] = 0;
+		for(uint32 i = begin; i < end; ++i) {
+			++histogram[(_src[i] >> _shift) & 0xFF];
+		}
+	}
+private:
+	const T* _src;
+	uint32* _histograms;
+	uint32 _shift;
+	uint32 _grainSize;
+};
+
+/// radix sort pass, step 2: scatter each chunk at its offsets (computed from the histograms)
+template<class T>
+class RadixScatterTask : public RangeTask
+{
+public:
+	RadixScatterTask(const T* src, T* dst, uint32* offsets, uint32 shift, uint32 grainSize)
+		:_src(src), _dst(dst), _offsets(offsets), _shift(shift), _grainSize(grainSize) {}
+	virtual void run(uint32 begin, uint32 end)
+	{
+		uint32* offsets = _offsets + (begin / _grainSize) * 256;
+		for(uint32 i = begin; i < end; ++i) {
+			_dst[offsets[(_src[i] >> _shift) & 0xFF]++] = _src[i];
+		}
+	}
+private:
+	const T* _src;
+	T* _dst;
+	uint32* _offsets;
+	uint32 _shift;
+	uint32 _grainSize;
+};
+}
+
+/// call func(begin, end) on sub ranges of [0, count)
+template<class Func>
+void parallel_for(ThreadPool& pool, uint32 count, Func func, uint32 grainSize = 0)
+{
+	priv::ForRangeTask<Func> task(func);
+	priv::parallelRun(pool, task, count, grainSize);
+}
+
+/// call func(element) on each element of the view
+template<class T, class Func>
+void parallel_for_each(ThreadPool& pool, ArrayView<T> view, Func func, uint32 grainSize = 0)
+{
+	priv::ForEachTask<T, Func> task(view.begin(), func);
+	priv::parallelRun(pool, task, view.size(), grainSize);
+}
+
+/// dst[i] = func(src[i]), dst must be at least as large as src (src and dst may be the same range)
+template<class T, class U, class Func>
+void parallel_transform(ThreadPool& pool, ArrayView<T> src, ArrayView<U> dst, Func func, uint32 grainSize = 0)
+{
+	assert(dst.size() >= src.size());
+	priv::TransformTask<typename ArrayView<T>::value_type, U, Func> task(src.begin(), dst.begin(), func);
+	priv::parallelRun(pool, task, src.size(), grainSize);
+}
+
+/// reduce the view with func(accumulator, element), identity being the neutral element of func
+/// func must be associative, the order in which chunks are combined is deterministic for a given grain size
+template<class T, class Func>
+typename ArrayView<T>::value_type parallel_reduce(ThreadPool& pool, ArrayView<T> view, const typename ArrayView<T>::value_type& identity, Func func, uint32 grainSize = 0)
+{
+	typedef typename ArrayView<T>::value_type V;
+	if(view.empty()) {
+		return identity;
+	}
+	grainSize = priv::parallelGrainSize(pool, view.size(), grainSize);
+	Array<V> partials;
+	partials.resize((view.size() + grainSize - 1) / grainSize, identity);
+
+	priv::ReduceTask<V, Func> task(view.begin(), identity, func, partials.begin(), grainSize);
+	priv::parallelRun(pool, task, view.size(), grainSize);
+
+	V result = identity;
+	for(uint32 i = 0; i < partials.size(); ++i) {
+		result = func(result, partials[i]);
+	}
+	return result;
+}
+
+/// sort the view with comp: chunks are sorted in parallel then merged pairwise (stable merge of unstable chunks)
+template<class T, class Compare>
+void parallel_sort(ThreadPool& pool, ArrayView<T> view, Compare comp)
+{
+	const uint32 count = view.size();
+	const uint32 threadCount = pool.getWorkerCount() + 1;
+	if(threadCount == 1 || count < 4096)
+	{
+		std::sort(view.begin(), view.end(), comp);
+		return;
+	}
+
+	// a power of two number of chunks, so that merge passes stay balanced
+	uint32 chunkCount = 1;
+	while(chunkCount < threadCount) chunkCount <<= 1;
+	uint32 width = (count + chunkCount - 1) / chunkCount;
+
+	priv::SortChunkTask<T, Compare> sortTask(view.begin(), comp);
+	priv::parallelRun(pool, sortTask, count, width);
+
+	Array<T> buffer;
+	buffer.resize(count);
+	T* src = view.begin();
+	T* dst = buffer.begin();
+	for(; width < count; width <<= 1)
+	{
+		priv::MergeTask<T, Compare> mergeTask(src, dst, width, comp);
+		priv::parallelRun(pool, mergeTask, count, width * 2);
+		std::swap(src, dst);
+	}
+	if(src != view.begin()) {
+		std::copy(src, src + count, view.begin());
+	}
+}
+
+/// sort the view in ascending order
+template<class T>
+void parallel_sort(ThreadPool& pool, ArrayView<T> view)
+{
+	parallel_sort(pool, view, std::less<T>());
+}
+
+/// LSD radix sort on 8 bits digits, T must be an unsigned integer type
+/// Histograms and scatters of each pass are computed in parallel, one chunk per thread.
+template<class T>
+void parallel_radix_sort(ThreadPool& pool, ArrayView<T> view)
+{
+	const uint32 count = view.size();
+	if(count < 2) {
+		return;
+	}
+	const uint32 threadCount = pool.getWorkerCount() + 1;
+	const uint32 grainSize = (count + threadCount - 1) / threadCount;
+	const uint32 chunkCount = (count + grainSize - 1) / grainSize;
+
+	Array<T> buffer;
+	buffer.resize(count);
+	Array<uint32> histograms;
+	histograms.resize(chunkCount * 256);
+
+	T* src = view.begin();
+	T* dst = buffer.begin();
+	for(uint32 shift = 0; shift < sizeof(T) * 8; shift += 8)
+	{
+		priv::RadixHistogramTask<T> histogramTask(src, histograms.begin(), shift, grainSize);
+		priv::parallelRun(pool, histogramTask, count, grainSize);
+
+		// exclusive prefix sum, digit major then chunk: gives the first output index of each (chunk, digit)
+		uint32 offset = 0;
+		bool isSingleDigit = false;
+		for(uint32 digit = 0; digit < 256; ++digit)
+		{
+			uint32 digitCount = 0;
+			for(uint32 chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				uint32& bucket = histograms[chunk * 256 + digit];
+				const uint32 bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+				digitCount += bucketCount;
+			}
+			isSingleDigit |= (digitCount == count);
+		}
+		// all the keys share this digit, the pass would not change the order
+		if(isSingleDigit) {
+			continue;
+		}
+
+		priv::RadixScatterTask<T> scatterTask(src, dst, histograms.begin(), shift, grainSize);
+		priv::parallelRun(pool, scatterTask, count, grainSize);
+		std::swap(src, dst);
+	}
+	if(src != view.begin()) {
+		std::copy(src, src + count, view.begin());
+	}
+}
+
+} // namespace df
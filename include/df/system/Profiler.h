@@ -0,0 +1,64 @@
+#pragma once
+#include <stdio.h>
+#include <df/system/Export.h>
+#include <df/system/CycleTimer.h>
+
+// Instrumentation zones: DF_PROFILE_SCOPE("name") records the time spent in the enclosing scope,
+// with the thread it ran on. Each thread appends its zones to its own buffer without locking, and
+// profiler::writeChromeTrace exports them for chrome://tracing or Perfetto (ui.perfetto.dev).
+// The zones are recorded when the build defines DF_PROFILING (premake4 --profiling), otherwise
+// DF_PROFILE_SCOPE expands to nothing. Recording a zone reads the CycleTimer counter twice.
+
+#define DF_PROFILE_CONCATENATE_IMPL(left, right) left##right
+#define DF_PROFILE_CONCATENATE(left, right) DF_PROFILE_CONCATENATE_IMPL(left, right)
+
+#if defined(DF_PROFILING)
+	/// record the time spent in the enclosing scope, name must be a string literal (it is not copied)
+	#define DF_PROFILE_SCOPE(name) ::df::ProfileScope DF_PROFILE_CONCATENATE(dfProfileScope, __LINE__)(name)
+#else
+	#define DF_PROFILE_SCOPE(name) ((void) 0)
+#endif
+
+namespace df
+{
+
+namespace priv
+{
+DF_SYSTEM_API void recordProfileZone(const char* name, uint64 beginCycles, uint64 endCycles);
+}
+
+/// \brief Records a zone from its construction to its destruction, whether DF_PROFILING is defined or not
+class ProfileScope
+{
+public:
+	/// name must outlive the export of the zone (a string literal)
+	explicit ProfileScope(const char* name):_name(name), _beginCycles(CycleTimer::getCurrentCycles()) {}
+	~ProfileScope() { priv::recordProfileZone(_name, _beginCycles, CycleTimer::getCurrentCycles()); }
+
+private:
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+	const char* _name;
+	uint64 _beginCycles;
+};
+
+namespace profiler
+{
+/// true if the build defines DF_PROFILING
+DF_SYSTEM_API bool isEnabled();
+
+/// number of zones recorded since the start (or the last clear)
+DF_SYSTEM_API uint64 getZoneCount();
+
+/// forget the zones recorded so far (the zones being recorded meanwhile may be kept)
+/// The memory of the buffers is kept for the next zones.
+DF_SYSTEM_API void clear();
+
+/// write the zones recorded so far as Chrome trace event JSON, return false on a write error
+/// Threads can keep recording meanwhile: their new zones may be left out.
+DF_SYSTEM_API bool writeChromeTrace(FILE* file);
+DF_SYSTEM_API bool writeChromeTrace(const char* path);
+}
+
+} // namespace df
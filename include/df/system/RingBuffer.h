@@ -0,0 +1,314 @@
+#pragma once
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <new>
+#include <df/system/BitOps.h>
+
+namespace df
+{
+
+/// A double ended queue stored in a power of two circular buffer.
+/// push and pop are O(1) at both ends. When the buffer is full it either grows
+/// (growable buffer, the default) or refuses new elements (see try_push_back / try_push_front).
+/// As Array, it guarantees move semantic on growth: elements are memcpy'ed, never copied.
+template<class T, uint32_t ALIGNMENT = 4>
+class RingBuffer
+{
+	static const uint32_t MINIMAL_SIZE = 8;
+public:
+	RingBuffer();
+	/// capacity is rounded up to the next power of two
+	RingBuffer(uint32_t capacity, bool growable = true);
+	~RingBuffer();
+	RingBuffer(const RingBuffer& other);
+	RingBuffer& operator=(const RingBuffer& other);
+
+	uint32_t size() const { return _size; }
+	uint32_t capacity() const { return _capacity; }
+	bool empty() const { return _size == 0; }
+	bool full() const { return _size == _capacity; }
+	bool growable() const { return _growable; }
+
+	/// Makes sure that the buffer can hold at least the specified number of elements.
+	void reserve(uint32_t capacity);
+
+	/// Destroy all the elements, memory is kept.
+	void clear();
+
+	// *** element operations ***
+	/// Access the idx-th element starting from the front.
+	T& operator[](uint32_t idx)             { assert(idx < _size); return _data[(_head + idx) & (_capacity-1)]; }
+	const T& operator[](uint32_t idx) const { assert(idx < _size); return _data[(_head + idx) & (_capacity-1)]; }
+
+	T& front()             { assert(_size > 0); return _data[_head]; }
+	const T& front() const { assert(_size > 0); return _data[_head]; }
+	T& back()              { assert(_size > 0); return _data[(_head + _size - 1) & (_capacity-1)]; }
+	const T& back() const  { assert(_size > 0); return _data[(_head + _size - 1) & (_capacity-1)]; }
+
+	/// Pushes the item at the end of the buffer. A non growable buffer must not be full.
+	void push_back(const T& value);
+	/// Pushes the item at the front of the buffer. A non growable buffer must not be full.
+	void push_front(const T& value);
+	/// Pushes the item at the end of the buffer, return false if the buffer is full and cannot grow.
+	bool try_push_back(const T& value);
+	/// Pushes the item at the front of the buffer, return false if the buffer is full and cannot grow.
+	bool try_push_front(const T& value);
+
+	/// Pops the last item. The buffer cannot be empty.
+	void pop_back();
+	/// Pops the first item. The buffer cannot be empty.
+	void pop_front();
+	/// Pops the count first items.
+	void pop_front(uint32_t count);
+
+	/// Retrieve the content as (at most) two contiguous spans, from front to back.
+	/// secondCount is 0 when the content does not wrap around the end of the storage.
+	void spans(T*& first, uint32_t& firstCount, T*& second, uint32_t& secondCount);
+	void spans(const T*& first, uint32_t& firstCount, const T*& second, uint32_t& secondCount) const;
+
+protected:
+	void* allocate(uint32_t size);
+	void deallocate(void* alignedPtr);
+
+	/// grow the storage to new_capacity (power of two) and unwrap the content at the start of the storage
+	void reallocate(uint32_t new_capacity);
+	bool makeRoom();
+
+	uint32_t _head; ///< storage index of the front element
+	uint32_t _size;
+	uint32_t _capacity; ///< always a power of two (or 0)
+	bool _growable;
+	T* _data;
+};
+
+template<class T, uint32_t ALIGNMENT>
+inline void* RingBuffer<T, ALIGNMENT>::allocate(uint32_t size)
+{
+	const size_t pointerSize = sizeof(void*) + sizeof(size_t);
+	const size_t requestedSize = size + ALIGNMENT - 1 + pointerSize;
+	void* raw = malloc(requestedSize);
+	void* start = (char*)raw + pointerSize;
+	void* aligned = (void*)(((size_t)((char*)start+ALIGNMENT-1)) & ~(size_t)(ALIGNMENT-1));
+	*(size_t*)((char*)aligned-pointerSize) = size;
+	*(void**)((char*)aligned-sizeof(void*)) = raw;
+	return aligned;
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline void RingBuffer<T, ALIGNMENT>::deallocate(void* alignedPtr)
+{
+	assert(alignedPtr != NULL);
+	void* raw = *(void**)((char*)alignedPtr-sizeof(void*));
+	free(raw);
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline RingBuffer<T, ALIGNMENT>::RingBuffer() : _head(0), _size(0), _capacity(0), _growable(true), _data(NULL)
+{
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline RingBuffer<T, ALIGNMENT>::RingBuffer(uint32_t capacity, bool growable) : _head(0), _size(0), _capacity(0), _growable(growable), _data(NULL)
+{
+	reallocate(nextPowerOfTwo(capacity > MINIMAL_SIZE ? capacity : MINIMAL_SIZE));
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline RingBuffer<T, ALIGNMENT>::RingBuffer(const RingBuffer& other) : _head(0), _size(0), _capacity(0), _growable(other._growable), _data(NULL)
+{
+	*this = other;
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline RingBuffer<T, ALIGNMENT>& RingBuffer<T, ALIGNMENT>::operator=(const RingBuffer& other)
+{
+	// ensure we don't try to assign buffer to itself
+	assert(this != &other);
+	clear();
+	if(other._capacity > _capacity) {
+		reallocate(other._capacity);
+	}
+	for(uint32_t i = 0; i < other._size; ++i) {
+		new (_data + i) T(other[i]);
+	}
+	_head = 0;
+	_size = other._size;
+	_growable = other._growable;
+	return *this;
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline RingBuffer<T, ALIGNMENT>::~RingBuffer()
+{
+	if(_data != NULL)
+	{
+		clear();
+		deallocate(_data);
+		// Set to 0 in case this RingBuffer is global and gets referenced during app exit
+		_data = NULL;
+		_capacity = 0;
+	}
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::reallocate(uint32_t new_capacity)
+{
+	assert(isPowerOfTwo(new_capacity) && new_capacity >= _size);
+	T* new_data = (T*) allocate(new_capacity * sizeof(T));
+	if(_data != NULL)
+	{
+		// unwrap the content at the start of the new storage
+		T* first; uint32_t firstCount;
+		T* second; uint32_t secondCount;
+		spans(first, firstCount, second, secondCount);
+		memcpy(new_data, first, firstCount * sizeof(T));
+		memcpy(new_data + firstCount, second, secondCount * sizeof(T));
+		deallocate(_data);
+	}
+	_data = new_data;
+	_capacity = new_capacity;
+	_head = 0;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::reserve(uint32_t capacity)
+{
+	if(capacity > _capacity) {
+		reallocate(nextPowerOfTwo(capacity > MINIMAL_SIZE ? capacity : MINIMAL_SIZE));
+	}
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::clear()
+{
+	while(_size > 0) {
+		pop_back();
+	}
+	_head = 0;
+}
+
+template<class T, uint32_t ALIGNMENT>
+inline bool RingBuffer<T, ALIGNMENT>::makeRoom()
+{
+	if(_size < _capacity) {
+		return true;
+	}
+	if(!_growable && _capacity != 0) {
+		return false;
+	}
+	// capacity is a power of two, doubling keeps it that way
+	reallocate(_capacity ? _capacity << 1 : MINIMAL_SIZE);
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::push_back(const T& value)
+{
+	if(_size == _capacity && (&value >= _data) && (&value < _data + _capacity))
+	{
+		// this is a reference to a data inside the buffer
+		// if we reallocate the buffer we may invalidate the reference
+		// push a copy instead
+		T tmp = value;
+		push_back(tmp);
+		return;
+	}
+	bool hasRoom = makeRoom();
+	assert(hasRoom && "RingBuffer is full");
+	(void)hasRoom;
+	new (_data + ((_head + _size) & (_capacity-1))) T(value);
+	++_size;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::push_front(const T& value)
+{
+	if(_size == _capacity && (&value >= _data) && (&value < _data + _capacity))
+	{
+		// see push_back
+		T tmp = value;
+		push_front(tmp);
+		return;
+	}
+	bool hasRoom = makeRoom();
+	assert(hasRoom && "RingBuffer is full");
+	(void)hasRoom;
+	_head = (_head - 1) & (_capacity-1);
+	new (_data + _head) T(value);
+	++_size;
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool RingBuffer<T, ALIGNMENT>::try_push_back(const T& value)
+{
+	if(_size == _capacity && !_growable && _capacity != 0) {
+		return false;
+	}
+	push_back(value);
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+bool RingBuffer<T, ALIGNMENT>::try_push_front(const T& value)
+{
+	if(_size == _capacity && !_growable && _capacity != 0) {
+		return false;
+	}
+	push_front(value);
+	return true;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::pop_back()
+{
+	assert(_size > 0);
+	(_data + ((_head + _size - 1) & (_capacity-1)))->~T();
+	--_size;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::pop_front()
+{
+	assert(_size > 0);
+	(_data + _head)->~T();
+	_head = (_head + 1) & (_capacity-1);
+	--_size;
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::pop_front(uint32_t count)
+{
+	assert(count <= _size);
+	for(uint32_t i = 0; i < count; ++i) {
+		pop_front();
+	}
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::spans(T*& first, uint32_t& firstCount, T*& second, uint32_t& secondCount)
+{
+	first = _data + _head;
+	second = _data;
+	if(_head + _size <= _capacity)
+	{
+		firstCount = _size;
+		secondCount = 0;
+	}else
+	{
+		firstCount = _capacity - _head;
+		secondCount = _size - firstCount;
+	}
+}
+
+template<class T, uint32_t ALIGNMENT>
+void RingBuffer<T, ALIGNMENT>::spans(const T*& first, uint32_t& firstCount, const T*& second, uint32_t& secondCount) const
+{
+	T* mutableFirst; T* mutableSecond;
+	const_cast<RingBuffer*>(this)->spans(mutableFirst, firstCount, mutableSecond, secondCount);
+	first = mutableFirst;
+	second = mutableSecond;
+}
+
+}
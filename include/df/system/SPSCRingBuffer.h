@@ -0,0 +1,194 @@
+#pragma once
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/BitOps.h>
+#include <df/system/Atomic.h>
+
+namespace df
+{
+
+/// Fixed capacity, lock-free, single producer / single consumer queue.
+/// Exactly one thread may push and exactly one (other) thread may pop.
+/// Producer and consumer indices live on their own cache line, and each side keeps a
+/// cached copy of the other side index so that the shared lines are only read when needed.
+template<class T>
+class SPSCRingBuffer : NonCopyable
+{
+public:
+	/// capacity is rounded up to the next power of two
+	explicit SPSCRingBuffer(uint32_t capacity);
+	~SPSCRingBuffer();
+
+	uint32_t capacity() const { return _mask + 1; }
+	/// approximate number of elements (exact when called from the producer or the consumer while the other side is idle)
+	uint32_t size() const { return _tail.load(MEMORY_ORDER_ACQUIRE) - _head.load(MEMORY_ORDER_ACQUIRE); }
+	bool empty() const { return size() == 0; }
+
+	// *** producer side ***
+	/// Pushes value, return false if the queue is full.
+	bool try_push(const T& value);
+	/// Pushes up to count values, return the number of values pushed.
+	uint32_t try_push(const T* values, uint32_t count);
+
+	// *** consumer side ***
+	/// Pops the front value into value, return false if the queue is empty.
+	bool try_pop(T& value);
+	/// Pops up to maxCount values into values, return the number of values popped.
+	uint32_t try_pop(T* values, uint32_t maxCount);
+
+	/// Retrieve the readable content as (at most) two contiguous spans, from front to back.
+	/// The elements stay in the queue until consume is called. Return the total count.
+	uint32_t peek(const T*& first, uint32_t& firstCount, const T*& second, uint32_t& secondCount);
+	/// Pops the count first elements, typically after a call to peek.
+	void consume(uint32_t count);
+
+private:
+	char _pad0[DF_CACHE_LINE_SIZE];
+
+	// written by the producer
+	Atomic<uint32_t> _tail; ///< index of the next written element (not wrapped)
+	uint32_t _cachedHead;   ///< last head value seen by the producer
+	char _pad1[DF_CACHE_LINE_SIZE - sizeof(Atomic<uint32_t>) - sizeof(uint32_t)];
+
+	// written by the consumer
+	Atomic<uint32_t> _head; ///< index of the next read element (not wrapped)
+	uint32_t _cachedTail;   ///< last tail value seen by the consumer
+	char _pad2[DF_CACHE_LINE_SIZE - sizeof(Atomic<uint32_t>) - sizeof(uint32_t)];
+
+	// read-only after construction
+	T* _data;
+	uint32_t _mask;
+	char _pad3[DF_CACHE_LINE_SIZE - sizeof(T*) - sizeof(uint32_t)];
+};
+
+template<class T>
+SPSCRingBuffer<T>::SPSCRingBuffer(uint32_t capacity) : _cachedHead(0), _cachedTail(0)
+{
+	capacity = nextPowerOfTwo(capacity > 2 ? capacity : 2);
+	_data = (T*) malloc(capacity * sizeof(T));
+	_mask = capacity - 1;
+}
+
+template<class T>
+SPSCRingBuffer<T>::~SPSCRingBuffer()
+{
+	for(uint32_t i = _head.load(MEMORY_ORDER_RELAXED); i != _tail.load(MEMORY_ORDER_RELAXED); ++i) {
+		(_data + (i & _mask))->~T();
+	}
+	free(_data);
+}
+
+template<class T>
+bool SPSCRingBuffer<T>::try_push(const T& value)
+{
+	const uint32_t tail = _tail.load(MEMORY_ORDER_RELAXED); // only the producer writes it
+	if(tail - _cachedHead > _mask)
+	{
+		_cachedHead = _head.load(MEMORY_ORDER_ACQUIRE);
+		if(tail - _cachedHead > _mask) {
+			return false;
+		}
+	}
+	new (_data + (tail & _mask)) T(value);
+	_tail.store(tail + 1, MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+template<class T>
+uint32_t SPSCRingBuffer<T>::try_push(const T* values, uint32_t count)
+{
+	const uint32_t tail = _tail.load(MEMORY_ORDER_RELAXED);
+	uint32_t available = _mask + 1 - (tail - _cachedHead);
+	if(available < count)
+	{
+		_cachedHead = _head.load(MEMORY_ORDER_ACQUIRE);
+		available = _mask + 1 - (tail - _cachedHead);
+	}
+	if(count > available) {
+		count = available;
+	}
+	for(uint32_t i = 0; i < count; ++i) {
+		new (_data + ((tail + i) & _mask)) T(values[i]);
+	}
+	// publish the whole batch at once
+	_tail.store(tail + count, MEMORY_ORDER_RELEASE);
+	return count;
+}
+
+template<class T>
+bool SPSCRingBuffer<T>::try_pop(T& value)
+{
+	const uint32_t head = _head.load(MEMORY_ORDER_RELAXED); // only the consumer writes it
+	if(head == _cachedTail)
+	{
+		_cachedTail = _tail.load(MEMORY_ORDER_ACQUIRE);
+		if(head == _cachedTail) {
+			return false;
+		}
+	}
+	T* element = _data + (head & _mask);
+	value = *element;
+	element->~T();
+	_head.store(head + 1, MEMORY_ORDER_RELEASE);
+	return true;
+}
+
+template<class T>
+uint32_t SPSCRingBuffer<T>::try_pop(T* values, uint32_t maxCount)
+{
+	const uint32_t head = _head.load(MEMORY_ORDER_RELAXED);
+	uint32_t available = _cachedTail - head;
+	if(available < maxCount)
+	{
+		_cachedTail = _tail.load(MEMORY_ORDER_ACQUIRE);
+		available = _cachedTail - head;
+	}
+	const uint32_t count = (maxCount < available) ? maxCount : available;
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		T* element = _data + ((head + i) & _mask);
+		values[i] = *element;
+		element->~T();
+	}
+	_head.store(head + count, MEMORY_ORDER_RELEASE);
+	return count;
+}
+
+template<class T>
+uint32_t SPSCRingBuffer<T>::peek(const T*& first, uint32_t& firstCount, const T*& second, uint32_t& secondCount)
+{
+	const uint32_t head = _head.load(MEMORY_ORDER_RELAXED);
+	_cachedTail = _tail.load(MEMORY_ORDER_ACQUIRE);
+	const uint32_t available = _cachedTail - head;
+	const uint32_t start = head & _mask;
+
+	first = _data + start;
+	second = _data;
+	if(start + available <= _mask + 1)
+	{
+		firstCount = available;
+		secondCount = 0;
+	}else
+	{
+		firstCount = _mask + 1 - start;
+		secondCount = available - firstCount;
+	}
+	return available;
+}
+
+template<class T>
+void SPSCRingBuffer<T>::consume(uint32_t count)
+{
+	const uint32_t head = _head.load(MEMORY_ORDER_RELAXED);
+	assert(count <= _cachedTail - head && "Cannot consume more than what has been peeked");
+	for(uint32_t i = 0; i < count; ++i) {
+		(_data + ((head + i) & _mask))->~T();
+	}
+	_head.store(head + count, MEMORY_ORDER_RELEASE);
+}
+
+} // namespace df
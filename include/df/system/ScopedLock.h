@@ -0,0 +1,35 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+
+namespace df
+{
+
+/// RAII scoped lock
+/// Works with any lock providing lock() and unlock() (Mutex, FastMutex, SpinLock, AdaptiveMutex ...).
+class ScopedLock : NonCopyable
+{
+public :
+	template<class Lock>
+	explicit ScopedLock(Lock& lock):_lock(&lock), _unlock(&unlockFunction<Lock>) { lock.lock(); }
+	~ScopedLock(){ _unlock(_lock); }
+private :
+	template<class Lock>
+	static void unlockFunction(void* lock) { ((Lock*)lock)->unlock(); }
+
+	void* _lock;
+	void (*_unlock)(void*);
+};
+
+/// RAII scoped lock without indirection, for a known lock type
+template<class Lock>
+class ScopedLockT : NonCopyable
+{
+public :
+	explicit ScopedLockT(Lock& lock):_lock(lock) { _lock.lock(); }
+	~ScopedLockT(){ _lock.unlock(); }
+private :
+	Lock& _lock;
+};
+
+} // namespace df
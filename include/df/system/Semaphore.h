@@ -0,0 +1,51 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Time.h>
+
+namespace df
+{
+
+/// \brief Counting semaphore
+/// wait blocks until the count is positive and decrements it, post increments it.
+/// Without contention both are a single atomic operation, a waiting thread is parked on a futex.
+class DF_SYSTEM_API Semaphore : NonCopyable
+{
+public:
+	explicit Semaphore(uint32 initialCount = 0):_count(initialCount), _waiterCount(0) {}
+
+	void wait()
+	{
+		if(!tryWait()) {
+			waitContended();
+		}
+	}
+	/// return false if the count is still 0 after timeout
+	bool wait(Time timeout);
+	/// decrement the count if it is positive, never blocks
+	bool tryWait()
+	{
+		uint32 count = priv::atomicLoadRelaxed(&_count);
+		while(count > 0)
+		{
+			if(priv::atomicCompareExchange(&_count, count, count - 1)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// add count to the semaphore, waking up as many waiters
+	void post(uint32 count = 1);
+
+	uint32 getCount() const { return priv::atomicLoadRelaxed(&_count); }
+
+private:
+	void waitContended();
+
+	volatile uint32 _count;
+	volatile uint32 _waiterCount; ///< threads parked (or about to) on _count
+};
+
+} // namespace df
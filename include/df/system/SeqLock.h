@@ -0,0 +1,86 @@
+#pragma once
+#include <string.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Atomic.h>
+#include <df/system/SpinLock.h>
+
+namespace df
+{
+
+/// \brief A small value readable concurrently without lock (sequence lock)
+/// Readers never write shared memory: they copy the value and retry if a writer modified it meanwhile,
+/// so reads scale with the number of threads. Writes are serialized and make the readers retry.
+/// T must be a plain data type (copied as raw bytes) and small, as readers copy it entirely.
+template<class T>
+class SeqLock : NonCopyable
+{
+public:
+	SeqLock() {}
+	explicit SeqLock(const T& value)
+	{
+		uint32 words[WORD_COUNT];
+		toWords(value, words);
+		for(uint32 i = 0; i < WORD_COUNT; ++i) {
+			_words[i].store(words[i], MEMORY_ORDER_RELAXED);
+		}
+	}
+
+	/// copy of the value, consistent even if a writer is active
+	T load() const
+	{
+		uint32 words[WORD_COUNT];
+		for(;;)
+		{
+			const uint32 sequence = _sequence.load(MEMORY_ORDER_ACQUIRE);
+			if(sequence & 1)
+			{
+				// write in progress
+				priv::cpuPause();
+				continue;
+			}
+			// the words are read atomically: a concurrent write gives a torn copy, never undefined behavior
+			for(uint32 i = 0; i < WORD_COUNT; ++i) {
+				words[i] = _words[i].load(MEMORY_ORDER_RELAXED);
+			}
+			// the copy cannot be reordered after the check of the sequence
+			priv::atomicThreadFence();
+			if(_sequence.load(MEMORY_ORDER_RELAXED) == sequence) {
+				break;
+			}
+		}
+		T value;
+		memcpy(&value, words, sizeof(T));
+		return value;
+	}
+
+	void store(const T& value)
+	{
+		uint32 words[WORD_COUNT];
+		toWords(value, words);
+
+		ScopedLockT<SpinLock> lock(_writeLock);
+		const uint32 sequence = _sequence.load(MEMORY_ORDER_RELAXED);
+		// odd sequence: write in progress
+		_sequence.store(sequence + 1, MEMORY_ORDER_RELAXED);
+		priv::atomicThreadFence();
+		for(uint32 i = 0; i < WORD_COUNT; ++i) {
+			_words[i].store(words[i], MEMORY_ORDER_RELAXED);
+		}
+		_sequence.store(sequence + 2, MEMORY_ORDER_RELEASE);
+	}
+
+private:
+	static const uint32 WORD_COUNT = (sizeof(T) + sizeof(uint32) - 1) / sizeof(uint32);
+
+	static void toWords(const T& value, uint32* words)
+	{
+		words[WORD_COUNT - 1] = 0;
+		memcpy(words, &value, sizeof(T));
+	}
+
+	Atomic<uint32> _sequence; ///< odd while a write is in progress
+	Atomic<uint32> _words[WORD_COUNT];
+	SpinLock _writeLock;      ///< serializes the writers
+};
+
+} // namespace df
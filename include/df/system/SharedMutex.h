@@ -0,0 +1,47 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/ScopedLock.h>
+
+namespace df
+{
+namespace priv
+{
+    class SharedMutexImpl;
+}
+
+/// \brief Reader-writer lock (non recursive)
+/// Any number of threads can hold the lock in shared mode, or a single thread in exclusive mode.
+/// Writers have priority over new readers, so that a stream of readers cannot starve them.
+/// Shared lock/unlock still write the lock word: for tiny read sections under heavy read load, prefer SeqLock.
+class DF_SYSTEM_API SharedMutex : NonCopyable
+{
+public :
+    SharedMutex();
+    ~SharedMutex();
+
+    /// exclusive lock (use ScopedLock)
+    void lock();
+    void unlock();
+    bool tryLock();
+
+    /// shared lock (use ScopedSharedLock)
+    void lockShared();
+    void unlockShared();
+    bool tryLockShared();
+
+private :
+    priv::SharedMutexImpl* _sharedMutexImpl; ///< OS-specific implementation
+};
+
+/// RAII scoped lock in shared mode
+class ScopedSharedLock : NonCopyable
+{
+public :
+	explicit ScopedSharedLock(SharedMutex& mutex):_mutex(mutex) { _mutex.lockShared(); }
+    ~ScopedSharedLock(){ _mutex.unlockShared(); }
+private :
+    SharedMutex& _mutex;
+};
+
+} // namespace df
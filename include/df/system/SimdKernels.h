@@ -0,0 +1,448 @@
+#pragma once
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <new>
+#include <df/platform.h>
+#if defined(DF_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(DF_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace df
+{
+namespace priv
+{
+
+/// true for the builtin arithmetic types (their copy is a memcpy and their construction a plain store)
+template<class T> struct IsArithmetic { enum { value = 0 }; };
+template<> struct IsArithmetic<bool> { enum { value = 1 }; };
+template<> struct IsArithmetic<char> { enum { value = 1 }; };
+template<> struct IsArithmetic<signed char> { enum { value = 1 }; };
+template<> struct IsArithmetic<unsigned char> { enum { value = 1 }; };
+template<> struct IsArithmetic<short> { enum { value = 1 }; };
+template<> struct IsArithmetic<unsigned short> { enum { value = 1 }; };
+template<> struct IsArithmetic<int> { enum { value = 1 }; };
+template<> struct IsArithmetic<unsigned int> { enum { value = 1 }; };
+template<> struct IsArithmetic<long> { enum { value = 1 }; };
+template<> struct IsArithmetic<unsigned long> { enum { value = 1 }; };
+template<> struct IsArithmetic<long long> { enum { value = 1 }; };
+template<> struct IsArithmetic<unsigned long long> { enum { value = 1 }; };
+template<> struct IsArithmetic<float> { enum { value = 1 }; };
+template<> struct IsArithmetic<double> { enum { value = 1 }; };
+
+template<class T> struct RemoveConst { typedef T type; };
+template<class T> struct RemoveConst<const T> { typedef T type; };
+
+template<class T, class U> struct IsSame { enum { value = 0 }; };
+template<class T> struct IsSame<T, T> { enum { value = 1 }; };
+
+// *** vector traits ***
+// A vector trait exposes a vector of WIDTH elements of type T (BYTES wide) and the operations used by the kernels.
+// The scalar trait is a vector of a single element so that kernels are written only once.
+
+template<class T>
+struct ScalarVec
+{
+	typedef T Vec;
+	enum { WIDTH = 1, BYTES = sizeof(T) };
+	static Vec load(const T* ptr) { return *ptr; }
+	static Vec loadu(const T* ptr) { return *ptr; }
+	static void store(T* ptr, Vec v) { *ptr = v; }
+	static Vec set1(T value) { return value; }
+	/// one bit per element, set if a[i] == b[i]
+	static uint32 eqMask(Vec a, Vec b) { return (a == b) ? 1u : 0u; }
+	static Vec add(Vec a, Vec b) { return a + b; }
+	static Vec min(Vec a, Vec b) { return (b < a) ? b : a; }
+	static Vec max(Vec a, Vec b) { return (a < b) ? b : a; }
+	static T reduceAdd(Vec v) { return v; }
+	static T reduceMin(Vec v) { return v; }
+	static T reduceMax(Vec v) { return v; }
+};
+
+/// trait used by fill, find, count and equal (bitwise comparisons)
+template<class T> struct SimdEqVec : ScalarVec<T> {};
+/// trait used by sum, min and max
+template<class T> struct SimdArithVec : ScalarVec<T> {};
+
+/// horizontal reductions done through memory, only used once per kernel call
+template<class T, int WIDTH, class Store>
+struct VecReduce
+{
+	typedef typename Store::Vec Vec;
+	static T add(Vec v) { DF_ALIGN_PRE(32) T lanes[WIDTH] DF_ALIGN_POST(32); Store::store(lanes, v); T r = lanes[0]; for(int i = 1; i < WIDTH; ++i) r += lanes[i]; return r; }
+	static T min(Vec v) { DF_ALIGN_PRE(32) T lanes[WIDTH] DF_ALIGN_POST(32); Store::store(lanes, v); T r = lanes[0]; for(int i = 1; i < WIDTH; ++i) r = (lanes[i] < r) ? lanes[i] : r; return r; }
+	static T max(Vec v) { DF_ALIGN_PRE(32) T lanes[WIDTH] DF_ALIGN_POST(32); Store::store(lanes, v); T r = lanes[0]; for(int i = 1; i < WIDTH; ++i) r = (r < lanes[i]) ? lanes[i] : r; return r; }
+};
+
+#if defined(DF_SIMD_AVX2)
+
+template<class T>
+struct Avx2Int32Vec
+{
+	typedef __m256i Vec;
+	enum { WIDTH = 8, BYTES = 32 };
+	static Vec load(const T* ptr) { return _mm256_load_si256((const __m256i*)ptr); }
+	static Vec loadu(const T* ptr) { return _mm256_loadu_si256((const __m256i*)ptr); }
+	static void store(T* ptr, Vec v) { _mm256_store_si256((__m256i*)ptr, v); }
+	static Vec set1(T value) { return _mm256_set1_epi32(int(value)); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))); }
+	// arithmetic is signed (only used for int32)
+	static Vec add(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+	static T reduceAdd(Vec v) { return VecReduce<T, WIDTH, Avx2Int32Vec>::add(v); }
+	static T reduceMin(Vec v) { return VecReduce<T, WIDTH, Avx2Int32Vec>::min(v); }
+	static T reduceMax(Vec v) { return VecReduce<T, WIDTH, Avx2Int32Vec>::max(v); }
+};
+
+template<class T>
+struct Avx2Int64Vec
+{
+	typedef __m256i Vec;
+	enum { WIDTH = 4, BYTES = 32 };
+	static Vec load(const T* ptr) { return _mm256_load_si256((const __m256i*)ptr); }
+	static Vec loadu(const T* ptr) { return _mm256_loadu_si256((const __m256i*)ptr); }
+	static void store(T* ptr, Vec v) { _mm256_store_si256((__m256i*)ptr, v); }
+	static Vec set1(T value) { return _mm256_set1_epi64x((long long)value); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)))); }
+	static Vec add(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+	static T reduceAdd(Vec v) { return VecReduce<T, WIDTH, Avx2Int64Vec>::add(v); }
+};
+
+struct Avx2FloatVec
+{
+	typedef __m256 Vec;
+	enum { WIDTH = 8, BYTES = 32 };
+	static Vec load(const float* ptr) { return _mm256_load_ps(ptr); }
+	static Vec loadu(const float* ptr) { return _mm256_loadu_ps(ptr); }
+	static void store(float* ptr, Vec v) { _mm256_store_ps(ptr, v); }
+	static Vec set1(float value) { return _mm256_set1_ps(value); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+	static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+	static float reduceAdd(Vec v) { return VecReduce<float, WIDTH, Avx2FloatVec>::add(v); }
+	static float reduceMin(Vec v) { return VecReduce<float, WIDTH, Avx2FloatVec>::min(v); }
+	static float reduceMax(Vec v) { return VecReduce<float, WIDTH, Avx2FloatVec>::max(v); }
+};
+
+struct Avx2DoubleVec
+{
+	typedef __m256d Vec;
+	enum { WIDTH = 4, BYTES = 32 };
+	static Vec load(const double* ptr) { return _mm256_load_pd(ptr); }
+	static Vec loadu(const double* ptr) { return _mm256_loadu_pd(ptr); }
+	static void store(double* ptr, Vec v) { _mm256_store_pd(ptr, v); }
+	static Vec set1(double value) { return _mm256_set1_pd(value); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+	static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+	static double reduceAdd(Vec v) { return VecReduce<double, WIDTH, Avx2DoubleVec>::add(v); }
+	static double reduceMin(Vec v) { return VecReduce<double, WIDTH, Avx2DoubleVec>::min(v); }
+	static double reduceMax(Vec v) { return VecReduce<double, WIDTH, Avx2DoubleVec>::max(v); }
+};
+
+template<> struct SimdEqVec<int32> : Avx2Int32Vec<int32> {};
+template<> struct SimdEqVec<uint32> : Avx2Int32Vec<uint32> {};
+template<> struct SimdEqVec<int64> : Avx2Int64Vec<int64> {};
+template<> struct SimdEqVec<uint64> : Avx2Int64Vec<uint64> {};
+template<> struct SimdEqVec<float> : Avx2FloatVec {};
+template<> struct SimdEqVec<double> : Avx2DoubleVec {};
+template<> struct SimdArithVec<int32> : Avx2Int32Vec<int32> {};
+template<> struct SimdArithVec<float> : Avx2FloatVec {};
+template<> struct SimdArithVec<double> : Avx2DoubleVec {};
+
+#elif defined(DF_SIMD_SSE2)
+
+template<class T>
+struct Sse2Int32Vec
+{
+	typedef __m128i Vec;
+	enum { WIDTH = 4, BYTES = 16 };
+	static Vec load(const T* ptr) { return _mm_load_si128((const __m128i*)ptr); }
+	static Vec loadu(const T* ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
+	static void store(T* ptr, Vec v) { _mm_store_si128((__m128i*)ptr, v); }
+	static Vec set1(T value) { return _mm_set1_epi32(int(value)); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))); }
+	// arithmetic is signed (only used for int32), SSE2 has no min/max on 32 bits integers
+	static Vec add(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+	static Vec min(Vec a, Vec b) { Vec gt = _mm_cmpgt_epi32(a, b); return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a)); }
+	static Vec max(Vec a, Vec b) { Vec gt = _mm_cmpgt_epi32(a, b); return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b)); }
+	static T reduceAdd(Vec v) { return VecReduce<T, WIDTH, Sse2Int32Vec>::add(v); }
+	static T reduceMin(Vec v) { return VecReduce<T, WIDTH, Sse2Int32Vec>::min(v); }
+	static T reduceMax(Vec v) { return VecReduce<T, WIDTH, Sse2Int32Vec>::max(v); }
+};
+
+template<class T>
+struct Sse2Int64Vec
+{
+	typedef __m128i Vec;
+	enum { WIDTH = 2, BYTES = 16 };
+	static Vec load(const T* ptr) { return _mm_load_si128((const __m128i*)ptr); }
+	static Vec loadu(const T* ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
+	static void store(T* ptr, Vec v) { _mm_store_si128((__m128i*)ptr, v); }
+	static Vec set1(T value) { DF_ALIGN_PRE(16) T lanes[2] DF_ALIGN_POST(16); lanes[0] = lanes[1] = value; return _mm_load_si128((const __m128i*)lanes); }
+	static uint32 eqMask(Vec a, Vec b)
+	{
+		// no 64 bits compare in SSE2: both 32 bits halves must be equal
+		Vec eq32 = _mm_cmpeq_epi32(a, b);
+		Vec eq64 = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+		return uint32(_mm_movemask_pd(_mm_castsi128_pd(eq64)));
+	}
+	static Vec add(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+	static T reduceAdd(Vec v) { return VecReduce<T, WIDTH, Sse2Int64Vec>::add(v); }
+};
+
+struct Sse2FloatVec
+{
+	typedef __m128 Vec;
+	enum { WIDTH = 4, BYTES = 16 };
+	static Vec load(const float* ptr) { return _mm_load_ps(ptr); }
+	static Vec loadu(const float* ptr) { return _mm_loadu_ps(ptr); }
+	static void store(float* ptr, Vec v) { _mm_store_ps(ptr, v); }
+	static Vec set1(float value) { return _mm_set1_ps(value); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm_movemask_ps(_mm_cmpeq_ps(a, b))); }
+	static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+	static float reduceAdd(Vec v) { return VecReduce<float, WIDTH, Sse2FloatVec>::add(v); }
+	static float reduceMin(Vec v) { return VecReduce<float, WIDTH, Sse2FloatVec>::min(v); }
+	static float reduceMax(Vec v) { return VecReduce<float, WIDTH, Sse2FloatVec>::max(v); }
+};
+
+struct Sse2DoubleVec
+{
+	typedef __m128d Vec;
+	enum { WIDTH = 2, BYTES = 16 };
+	static Vec load(const double* ptr) { return _mm_load_pd(ptr); }
+	static Vec loadu(const double* ptr) { return _mm_loadu_pd(ptr); }
+	static void store(double* ptr, Vec v) { _mm_store_pd(ptr, v); }
+	static Vec set1(double value) { return _mm_set1_pd(value); }
+	static uint32 eqMask(Vec a, Vec b) { return uint32(_mm_movemask_pd(_mm_cmpeq_pd(a, b))); }
+	static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+	static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+	static double reduceAdd(Vec v) { return VecReduce<double, WIDTH, Sse2DoubleVec>::add(v); }
+	static double reduceMin(Vec v) { return VecReduce<double, WIDTH, Sse2DoubleVec>::min(v); }
+	static double reduceMax(Vec v) { return VecReduce<double, WIDTH, Sse2DoubleVec>::max(v); }
+};
+
+template<> struct SimdEqVec<int32> : Sse2Int32Vec<int32> {};
+template<> struct SimdEqVec<uint32> : Sse2Int32Vec<uint32> {};
+template<> struct SimdEqVec<int64> : Sse2Int64Vec<int64> {};
+template<> struct SimdEqVec<uint64> : Sse2Int64Vec<uint64> {};
+template<> struct SimdEqVec<float> : Sse2FloatVec {};
+template<> struct SimdEqVec<double> : Sse2DoubleVec {};
+template<> struct SimdArithVec<int32> : Sse2Int32Vec<int32> {};
+template<> struct SimdArithVec<float> : Sse2FloatVec {};
+template<> struct SimdArithVec<double> : Sse2DoubleVec {};
+
+#endif
+
+/// return popcount of a mask of at most 8 bits
+inline uint32 maskCount(uint32 mask) { mask = mask - ((mask >> 1) & 0x55); mask = (mask & 0x33) + ((mask >> 2) & 0x33); return (mask + (mask >> 4)) & 0x0F; }
+/// return index of the lowest bit set of a non null mask
+inline uint32 maskFirst(uint32 mask) { uint32 idx = 0; while(!(mask & 1)) { mask >>= 1; ++idx; } return idx; }
+
+// *** kernels ***
+// V is the vector trait, ALIGNMENT the known alignment of the first pointer (1 if unknown).
+// Leading elements are processed one by one until the first pointer is aligned on a vector,
+// which is skipped at compile time when ALIGNMENT already guarantees it.
+template<class T, class V, uint32_t ALIGNMENT>
+struct SimdKernels
+{
+	/// number of leading elements to process before ptr is aligned on V::BYTES
+	static uint32_t peel(const T* ptr, uint32_t count)
+	{
+		if(ALIGNMENT >= uint32_t(V::BYTES)) {
+			return 0;
+		}
+		const uint32_t misalignment = uint32_t((size_t)ptr % V::BYTES);
+		if(misalignment % sizeof(T) != 0) {
+			return count; // element not naturally aligned, no vector load possible
+		}
+		const uint32_t leading = misalignment ? (uint32_t(V::BYTES) - misalignment) / sizeof(T) : 0;
+		return (leading < count) ? leading : count;
+	}
+
+	static void fill(T* dst, uint32_t count, T value)
+	{
+		uint32_t i = peel(dst, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			dst[j] = value;
+		}
+		const typename V::Vec v = V::set1(value);
+		for(; i + V::WIDTH <= count; i += V::WIDTH) {
+			V::store(dst + i, v);
+		}
+		for(; i < count; ++i) {
+			dst[i] = value;
+		}
+	}
+
+	/// index of the first element equal to value, count if none
+	static uint32_t find(const T* src, uint32_t count, T value)
+	{
+		uint32_t i = peel(src, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			if(src[j] == value) return j;
+		}
+		const typename V::Vec v = V::set1(value);
+		for(; i + V::WIDTH <= count; i += V::WIDTH)
+		{
+			const uint32 mask = V::eqMask(V::load(src + i), v);
+			if(mask != 0) {
+				return i + maskFirst(mask);
+			}
+		}
+		for(; i < count; ++i) {
+			if(src[i] == value) return i;
+		}
+		return count;
+	}
+
+	static uint32_t count(const T* src, uint32_t count, T value)
+	{
+		uint32_t result = 0;
+		uint32_t i = peel(src, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			result += (src[j] == value);
+		}
+		const typename V::Vec v = V::set1(value);
+		for(; i + V::WIDTH <= count; i += V::WIDTH) {
+			result += maskCount(V::eqMask(V::load(src + i), v));
+		}
+		for(; i < count; ++i) {
+			result += (src[i] == value);
+		}
+		return result;
+	}
+
+	/// compare count elements of a (aligned on ALIGNMENT) with b (unknown alignment)
+	static bool equal(const T* a, const T* b, uint32_t count)
+	{
+		uint32_t i = peel(a, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			if(!(a[j] == b[j])) return false;
+		}
+		const uint32 allEqual = (1u << V::WIDTH) - 1;
+		for(; i + V::WIDTH <= count; i += V::WIDTH) {
+			if(V::eqMask(V::load(a + i), V::loadu(b + i)) != allEqual) return false;
+		}
+		for(; i < count; ++i) {
+			if(!(a[i] == b[i])) return false;
+		}
+		return true;
+	}
+
+	static T sum(const T* src, uint32_t count)
+	{
+		T result = T(0);
+		uint32_t i = peel(src, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			result += src[j];
+		}
+		if(i + V::WIDTH <= count)
+		{
+			typename V::Vec acc = V::load(src + i);
+			for(i += V::WIDTH; i + V::WIDTH <= count; i += V::WIDTH) {
+				acc = V::add(acc, V::load(src + i));
+			}
+			result += V::reduceAdd(acc);
+		}
+		for(; i < count; ++i) {
+			result += src[i];
+		}
+		return result;
+	}
+
+	static T min(const T* src, uint32_t count)
+	{
+		assert(count > 0);
+		T result = src[0];
+		uint32_t i = peel(src, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			result = (src[j] < result) ? src[j] : result;
+		}
+		if(i + V::WIDTH <= count)
+		{
+			typename V::Vec acc = V::load(src + i);
+			for(i += V::WIDTH; i + V::WIDTH <= count; i += V::WIDTH) {
+				acc = V::min(acc, V::load(src + i));
+			}
+			const T vecResult = V::reduceMin(acc);
+			result = (vecResult < result) ? vecResult : result;
+		}
+		for(; i < count; ++i) {
+			result = (src[i] < result) ? src[i] : result;
+		}
+		return result;
+	}
+
+	static T max(const T* src, uint32_t count)
+	{
+		assert(count > 0);
+		T result = src[0];
+		uint32_t i = peel(src, count);
+		for(uint32_t j = 0; j < i; ++j) {
+			result = (result < src[j]) ? src[j] : result;
+		}
+		if(i + V::WIDTH <= count)
+		{
+			typename V::Vec acc = V::load(src + i);
+			for(i += V::WIDTH; i + V::WIDTH <= count; i += V::WIDTH) {
+				acc = V::max(acc, V::load(src + i));
+			}
+			const T vecResult = V::reduceMax(acc);
+			result = (result < vecResult) ? vecResult : result;
+		}
+		for(; i < count; ++i) {
+			result = (result < src[i]) ? src[i] : result;
+		}
+		return result;
+	}
+};
+
+// *** element construction used by Array ***
+// Generic types are constructed one by one, arithmetic types are filled / memcpy'ed in bulk.
+// Destination may be anywhere inside an array, so its alignment is checked at runtime.
+
+template<class T, bool ARITHMETIC = (IsArithmetic<T>::value != 0)>
+struct ConstructOps
+{
+	static void fill(T* dst, uint32_t count, const T& value)
+	{
+		for(T* ptr = dst; ptr < dst + count; ++ptr) {
+			new (ptr) T(value);
+		}
+	}
+	static void copy(T* dst, const T* src, uint32_t count)
+	{
+		for(uint32_t i = 0; i < count; ++i) {
+			new (dst + i) T(src[i]);
+		}
+	}
+};
+
+template<class T>
+struct ConstructOps<T, true>
+{
+	static void fill(T* dst, uint32_t count, const T& value)
+	{
+		if(sizeof(T) == 1) {
+			memset(dst, *(const unsigned char*)&value, count);
+		} else {
+			SimdKernels<T, SimdEqVec<T>, 1>::fill(dst, count, value);
+		}
+	}
+	static void copy(T* dst, const T* src, uint32_t count)
+	{
+		memcpy(dst, src, count * sizeof(T));
+	}
+};
+
+} // namespace priv
+} // namespace df
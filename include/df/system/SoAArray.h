@@ -0,0 +1,410 @@
+#pragma once
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <new>
+
+namespace df
+{
+
+/// Placeholder type for the unused columns of a SoAArray
+struct NoColumn {};
+
+namespace priv
+{
+/// Retrieve the type of the Nth column of a SoAArray
+template<int N, class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType;
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<0, T0, T1, T2, T3, T4, T5> { typedef T0 type; };
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<1, T0, T1, T2, T3, T4, T5> { typedef T1 type; };
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<2, T0, T1, T2, T3, T4, T5> { typedef T2 type; };
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<3, T0, T1, T2, T3, T4, T5> { typedef T3 type; };
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<4, T0, T1, T2, T3, T4, T5> { typedef T4 type; };
+template<class T0, class T1, class T2, class T3, class T4, class T5> struct SoAColumnType<5, T0, T1, T2, T3, T4, T5> { typedef T5 type; };
+
+/// Element operations applied on a single column (raw memory) of a SoAArray
+template<class T>
+struct SoAColumnOps
+{
+	static uint32_t elementSize() { return sizeof(T); }
+
+	static void construct(void* column, uint32_t first, uint32_t last)
+	{
+		T* data = (T*)column;
+		for(T* ptr = data+first; ptr < data+last; ++ptr) {
+			new (ptr) T();
+		}
+	}
+
+	static void construct(void* column, uint32_t first, uint32_t last, const T& value)
+	{
+		T* data = (T*)column;
+		for(T* ptr = data+first; ptr < data+last; ++ptr) {
+			new (ptr) T(value);
+		}
+	}
+
+	static void copy(void* dstColumn, const void* srcColumn, uint32_t count)
+	{
+		T* dst = (T*)dstColumn;
+		const T* src = (const T*)srcColumn;
+		for(uint32_t i = 0; i < count; ++i) {
+			new (dst+i) T(src[i]);
+		}
+	}
+
+	static void destroy(void* column, uint32_t first, uint32_t last)
+	{
+		T* data = (T*)column;
+		for(T* ptr = data+first; ptr < data+last; ++ptr) {
+			ptr->~T();
+		}
+	}
+
+	/// move semantic: the destination must have been destroyed, the source is left as raw memory
+	static void move(void* column, uint32_t dst, uint32_t src)
+	{
+		T* data = (T*)column;
+		memcpy(data+dst, data+src, sizeof(T));
+	}
+};
+
+template<>
+struct SoAColumnOps<NoColumn>
+{
+	static uint32_t elementSize() { return 0; }
+	static void construct(void*, uint32_t, uint32_t) {}
+	static void construct(void*, uint32_t, uint32_t, const NoColumn&) {}
+	static void copy(void*, const void*, uint32_t) {}
+	static void destroy(void*, uint32_t, uint32_t) {}
+	static void move(void*, uint32_t, uint32_t) {}
+};
+}
+
+/// A structure of arrays container: each field is stored in its own column.
+/// All the columns share a single allocation, a single size and a single capacity.
+/// Each column start is aligned on ALIGNMENT bytes so that per column loops can use aligned vector loads.
+/// As Array, it guarantees move semantic on reserve, resize and remove.
+/// Unused columns must be left to NoColumn.
+template<class T0, class T1 = NoColumn, class T2 = NoColumn, class T3 = NoColumn, class T4 = NoColumn, class T5 = NoColumn>
+class SoAArray
+{
+	static const uint32_t MINIMAL_SIZE = 8;
+	static const uint32_t MAX_COLUMNS = 6;
+public:
+	/// alignment of each column (large enough for AVX loads)
+	static const uint32_t ALIGNMENT = 32;
+
+	/// type of the Nth column
+	template<int N>
+	struct Column { typedef typename priv::SoAColumnType<N, T0, T1, T2, T3, T4, T5>::type type; };
+
+	/// Proxy on a single row of the array. Invalidated by any reallocation.
+	class Row
+	{
+	public:
+		Row(SoAArray* array, uint32_t idx):_array(array), _idx(idx) {}
+		template<int N>
+		typename Column<N>::type& get() const { return _array->template column<N>()[_idx]; }
+		uint32_t index() const { return _idx; }
+	private:
+		SoAArray* _array;
+		uint32_t _idx;
+	};
+
+	/// Read only proxy on a single row of the array. Invalidated by any reallocation.
+	class ConstRow
+	{
+	public:
+		ConstRow(const SoAArray* array, uint32_t idx):_array(array), _idx(idx) {}
+		template<int N>
+		const typename Column<N>::type& get() const { return _array->template column<N>()[_idx]; }
+		uint32_t index() const { return _idx; }
+	private:
+		const SoAArray* _array;
+		uint32_t _idx;
+	};
+
+	SoAArray();
+	SoAArray(uint32_t reserved_size);
+	~SoAArray();
+	SoAArray(const SoAArray& src);
+	SoAArray& operator=(const SoAArray& other);
+
+	uint32_t size() const { return _size ; }
+	uint32_t reserved_size() const { return _reserved_size; }
+
+	/// Makes sure that the array has at least the specified capacity. (If not, all the columns are grown.)
+	void reserve(uint32_t reserved_size);
+
+	/// Changes the size of the array (does not reallocate memory unless necessary).
+	void resize(uint32_t new_size);
+
+	//set size to 0 and free memory (reserved size = 0)
+	void clear();
+
+	// *** column operations ***
+	/// Pointer on the first element of the Nth column, aligned on ALIGNMENT. Invalidated by any reallocation.
+	template<int N>
+	typename Column<N>::type* column()             { return (typename Column<N>::type*)_columns[N]; }
+	template<int N>
+	const typename Column<N>::type* column() const { return (const typename Column<N>::type*)_columns[N]; }
+
+	// *** row operations ***
+	Row operator[](uint32_t idx)             { assert(idx < _size); return Row(this, idx); }
+	ConstRow operator[](uint32_t idx) const  { assert(idx < _size); return ConstRow(this, idx); }
+
+	/// Access the field N of the row idx
+	template<int N>
+	typename Column<N>::type& get(uint32_t idx)             { assert(idx < _size); return column<N>()[idx]; }
+	template<int N>
+	const typename Column<N>::type& get(uint32_t idx) const { assert(idx < _size); return column<N>()[idx]; }
+
+	/// Pushes a row to the end of the array. Values must not reference an element of this array.
+	void push_back(const T0& v0, const T1& v1 = T1(), const T2& v2 = T2(), const T3& v3 = T3(), const T4& v4 = T4(), const T5& v5 = T5());
+	/// Pops the last row from the array. The array cannot be empty.
+	void pop_back();
+
+	//Swaps row index with the last row and shrink by 1
+	void unsorted_remove(uint32_t idx);
+
+protected:
+	static uint32_t alignedColumnSize(uint32_t elementSize, uint32_t count) { return (elementSize*count + ALIGNMENT-1) & ~(ALIGNMENT-1); }
+	static uint32_t rowSize();
+
+	void* allocate(uint32_t size);
+	void deallocate(void* alignedPtr);
+
+	void destroyRows(uint32_t first, uint32_t last);
+
+	uint32_t _size;
+	uint32_t _reserved_size;
+	char* _columns[MAX_COLUMNS]; ///< first column starts the allocation
+};
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline uint32_t SoAArray<T0, T1, T2, T3, T4, T5>::rowSize()
+{
+	return priv::SoAColumnOps<T0>::elementSize() + priv::SoAColumnOps<T1>::elementSize() + priv::SoAColumnOps<T2>::elementSize()
+		+ priv::SoAColumnOps<T3>::elementSize() + priv::SoAColumnOps<T4>::elementSize() + priv::SoAColumnOps<T5>::elementSize();
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline void* SoAArray<T0, T1, T2, T3, T4, T5>::allocate(uint32_t size)
+{
+	const size_t pointerSize = sizeof(void*) + sizeof(size_t);
+	const size_t requestedSize = size + ALIGNMENT - 1 + pointerSize;
+	void* raw = malloc(requestedSize);
+	void* start = (char*)raw + pointerSize;
+	void* aligned = (void*)(((size_t)((char*)start+ALIGNMENT-1)) & ~(size_t)(ALIGNMENT-1));
+	*(size_t*)((char*)aligned-pointerSize) = size;
+	*(void**)((char*)aligned-sizeof(void*)) = raw;
+	return aligned;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline void SoAArray<T0, T1, T2, T3, T4, T5>::deallocate(void* alignedPtr)
+{
+	assert(alignedPtr != NULL);
+	void* raw = *(void**)((char*)alignedPtr-sizeof(void*));
+	free(raw);
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline SoAArray<T0, T1, T2, T3, T4, T5>::SoAArray() : _size(0), _reserved_size(0)
+{
+	memset(_columns, 0, sizeof(_columns));
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline SoAArray<T0, T1, T2, T3, T4, T5>::SoAArray(uint32_t reserved_size) : _size(0), _reserved_size(0)
+{
+	memset(_columns, 0, sizeof(_columns));
+	reserve((reserved_size > MINIMAL_SIZE) ? reserved_size : MINIMAL_SIZE);
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline SoAArray<T0, T1, T2, T3, T4, T5>::SoAArray(const SoAArray& other) : _size(0), _reserved_size(0)
+{
+	memset(_columns, 0, sizeof(_columns));
+	*this = other;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline SoAArray<T0, T1, T2, T3, T4, T5>& SoAArray<T0, T1, T2, T3, T4, T5>::operator=(const SoAArray& other)
+{
+	// ensure we don't try to assign array to itself
+	assert(this != &other);
+	destroyRows(0, _size);
+	_size = 0;
+	reserve(other._size);
+	priv::SoAColumnOps<T0>::copy(_columns[0], other._columns[0], other._size);
+	priv::SoAColumnOps<T1>::copy(_columns[1], other._columns[1], other._size);
+	priv::SoAColumnOps<T2>::copy(_columns[2], other._columns[2], other._size);
+	priv::SoAColumnOps<T3>::copy(_columns[3], other._columns[3], other._size);
+	priv::SoAColumnOps<T4>::copy(_columns[4], other._columns[4], other._size);
+	priv::SoAColumnOps<T5>::copy(_columns[5], other._columns[5], other._size);
+	_size = other._size;
+	return *this;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline SoAArray<T0, T1, T2, T3, T4, T5>::~SoAArray()
+{
+	if(_columns[0] != NULL)
+	{
+		destroyRows(0, _size);
+		deallocate(_columns[0]);
+		// Set to 0 in case this SoAArray is global and gets referenced during app exit
+		memset(_columns, 0, sizeof(_columns));
+		_size = 0;
+		_reserved_size = 0;
+	}
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+inline void SoAArray<T0, T1, T2, T3, T4, T5>::destroyRows(uint32_t first, uint32_t last)
+{
+	priv::SoAColumnOps<T0>::destroy(_columns[0], first, last);
+	priv::SoAColumnOps<T1>::destroy(_columns[1], first, last);
+	priv::SoAColumnOps<T2>::destroy(_columns[2], first, last);
+	priv::SoAColumnOps<T3>::destroy(_columns[3], first, last);
+	priv::SoAColumnOps<T4>::destroy(_columns[4], first, last);
+	priv::SoAColumnOps<T5>::destroy(_columns[5], first, last);
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::reserve(uint32_t new_size)
+{
+	if (new_size <= _reserved_size) {
+		return;
+	}
+
+	uint32_t new_reserved_size = new_size;
+	if (_reserved_size != 0)
+	{
+		// same growth strategy as Array, based on the size of a whole row
+		size_t old_size_bytes = _reserved_size * rowSize();
+		new_reserved_size = (_reserved_size * 3);
+		if (old_size_bytes > 400000) {
+			new_reserved_size >>= 1; // Avoid bloat ( *= 1.5)
+		} else if (old_size_bytes > 64000) {
+			new_reserved_size = _reserved_size << 1; // classic *= 2
+		}
+
+		//ensure minimal size
+		if(new_reserved_size < MINIMAL_SIZE) new_reserved_size = MINIMAL_SIZE;
+		else if(new_reserved_size < new_size) new_reserved_size = new_size;
+	}
+
+	// compute the column layout of the new allocation
+	const uint32_t elementSizes[MAX_COLUMNS] = {
+		priv::SoAColumnOps<T0>::elementSize(), priv::SoAColumnOps<T1>::elementSize(), priv::SoAColumnOps<T2>::elementSize(),
+		priv::SoAColumnOps<T3>::elementSize(), priv::SoAColumnOps<T4>::elementSize(), priv::SoAColumnOps<T5>::elementSize() };
+	uint32_t offsets[MAX_COLUMNS];
+	uint32_t total_size = 0;
+	for(uint32_t i = 0; i < MAX_COLUMNS; ++i)
+	{
+		offsets[i] = total_size;
+		total_size += alignedColumnSize(elementSizes[i], new_reserved_size);
+	}
+
+	//reallocate, the first column always starts the allocation
+	char* old_block = _columns[0];
+	char* block = (char*) allocate(total_size);
+	for(uint32_t i = 0; i < MAX_COLUMNS; ++i)
+	{
+		char* new_column = (elementSizes[i] != 0) ? block + offsets[i] : NULL;
+		if(_columns[i] != NULL) {
+			memcpy(new_column, _columns[i], _size * elementSizes[i]);
+		}
+		_columns[i] = new_column;
+	}
+	_reserved_size = new_reserved_size;
+
+	//deallocate
+	if(old_block != NULL) {
+		deallocate(old_block);
+	}
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::resize(uint32_t new_size)
+{
+	if (new_size == _size) {
+		return;
+	}
+
+	if(new_size < _size)
+	{
+		// Call destructor on newly hidden rows
+		destroyRows(new_size, _size);
+	}else
+	{
+		//ensure there is enough place for the leftovers
+		reserve(new_size);
+		// Call the constructors on newly revealed rows
+		priv::SoAColumnOps<T0>::construct(_columns[0], _size, new_size);
+		priv::SoAColumnOps<T1>::construct(_columns[1], _size, new_size);
+		priv::SoAColumnOps<T2>::construct(_columns[2], _size, new_size);
+		priv::SoAColumnOps<T3>::construct(_columns[3], _size, new_size);
+		priv::SoAColumnOps<T4>::construct(_columns[4], _size, new_size);
+		priv::SoAColumnOps<T5>::construct(_columns[5], _size, new_size);
+	}
+	_size = new_size;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::clear()
+{
+	if(_columns[0] == NULL) {
+		return;
+	}
+	destroyRows(0, _size);
+	deallocate(_columns[0]);
+	memset(_columns, 0, sizeof(_columns));
+	_size = 0;
+	_reserved_size = 0;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::push_back(const T0& v0, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5)
+{
+	reserve(_size + 1);
+	priv::SoAColumnOps<T0>::construct(_columns[0], _size, _size+1, v0);
+	priv::SoAColumnOps<T1>::construct(_columns[1], _size, _size+1, v1);
+	priv::SoAColumnOps<T2>::construct(_columns[2], _size, _size+1, v2);
+	priv::SoAColumnOps<T3>::construct(_columns[3], _size, _size+1, v3);
+	priv::SoAColumnOps<T4>::construct(_columns[4], _size, _size+1, v4);
+	priv::SoAColumnOps<T5>::construct(_columns[5], _size, _size+1, v5);
+	++_size;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::pop_back()
+{
+	assert(_size>0);
+	destroyRows(_size-1, _size);
+	--_size;
+}
+
+template<class T0, class T1, class T2, class T3, class T4, class T5>
+void SoAArray<T0, T1, T2, T3, T4, T5>::unsorted_remove(uint32_t idx)
+{
+	assert(idx < _size);
+
+	destroyRows(idx, idx+1);
+	const uint32_t last = _size-1;
+	if(idx != last)
+	{
+		priv::SoAColumnOps<T0>::move(_columns[0], idx, last);
+		priv::SoAColumnOps<T1>::move(_columns[1], idx, last);
+		priv::SoAColumnOps<T2>::move(_columns[2], idx, last);
+		priv::SoAColumnOps<T3>::move(_columns[3], idx, last);
+		priv::SoAColumnOps<T4>::move(_columns[4], idx, last);
+		priv::SoAColumnOps<T5>::move(_columns[5], idx, last);
+	}
+	--_size;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <df/system/NonCopyable.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+
+namespace df
+{
+
+/// \brief Non recursive lock that busy waits
+/// Only suitable for very short critical sections: a waiting thread keeps its core busy.
+/// Waiters spin on a plain load (no cache line ping-pong) with an exponential backoff of pause
+/// instructions, and yield their time slice once the backoff is at its maximum.
+class SpinLock : NonCopyable
+{
+public:
+	SpinLock() {}
+
+	void lock()
+	{
+		uint32 backoff = 1;
+		for(;;)
+		{
+			if(tryLock()) {
+				return;
+			}
+			do
+			{
+				if(backoff <= MAX_BACKOFF)
+				{
+					for(uint32 i = 0; i < backoff; ++i) {
+						priv::cpuPause();
+					}
+					backoff <<= 1;
+				}
+				else {
+					this_thread::yield();
+				}
+			}
+			while(_isLocked.load(MEMORY_ORDER_RELAXED));
+		}
+	}
+
+	bool tryLock() { return _isLocked.exchange(1, MEMORY_ORDER_ACQUIRE) == 0; }
+	void unlock() { _isLocked.store(0, MEMORY_ORDER_RELEASE); }
+
+private:
+	static const uint32 MAX_BACKOFF = 64; ///< pause instructions between two polls, before yielding
+	Atomic<uint32> _isLocked;
+};
+
+} // namespace df
@@ -0,0 +1,56 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+#include <df/system/Array.h>
+
+namespace df
+{
+class Runnable;
+class ThreadPool;
+
+/// \brief A set of tasks with dependencies executed on a ThreadPool.
+/// A task is dispatched as soon as all its predecessors are done. The graph is built once and
+/// can be run any number of times: only the first run after a modification allocates memory.
+/// Each run measures the duration of the tasks and the critical path (the longest chain of
+/// dependent tasks), which is the lower bound of the run time whatever the number of workers.
+class DF_SYSTEM_API TaskGraph : NonCopyable
+{
+public:
+	typedef uint32 TaskId;
+
+	TaskGraph();
+	~TaskGraph();
+
+	/// add a task, name is only kept for instrumentation (the string is not copied)
+	TaskId addTask(void (*functionPtr)(void *), void * userData, const char* name = 0);
+	TaskId addTask(Runnable* runnable, const char* name = 0);
+	/// successor cannot start before predecessor is done
+	void addDependency(TaskId predecessor, TaskId successor);
+	/// add a task that runs after predecessor
+	TaskId addContinuation(TaskId predecessor, void (*functionPtr)(void *), void * userData, const char* name = 0);
+
+	uint32 getTaskCount() const;
+	const char* getTaskName(TaskId task) const;
+	/// remove all tasks and dependencies, keeping the storage for the next graph
+	void clear();
+
+	/// execute all the tasks and return when they are done
+	/// The calling thread takes part in the execution. The graph must not contain cycles.
+	void run(ThreadPool& pool);
+
+	// *** instrumentation of the last run ***
+	/// wall clock time of the whole run
+	Time getRunTime() const;
+	/// sum of the durations of the tasks on the longest dependency chain
+	Time getCriticalPathTime() const;
+	/// tasks of the longest dependency chain, in execution order
+	void getCriticalPath(Array<TaskId>& path) const;
+	Time getTaskTime(TaskId task) const;
+
+private:
+	class PrivateData;
+	PrivateData* _data;
+};
+
+} // namespace df
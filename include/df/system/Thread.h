@@ -14,14 +14,38 @@ public:
 	virtual ~Runnable(){}
 };
 
+/// \brief Options of a new thread, the defaults leave the OS defaults
+/// The options are applied by the new thread before calling its function. They are best effort:
+/// an option refused by the OS (a real-time priority without the privilege, an affinity on a
+/// platform without affinity such as OSX) is ignored.
+struct DF_SYSTEM_API ThreadOptions
+{
+	enum Priority
+	{
+		PRIORITY_LOWEST,
+		PRIORITY_LOW,
+		PRIORITY_NORMAL,
+		PRIORITY_HIGH,
+		PRIORITY_HIGHEST,
+		PRIORITY_REALTIME ///< real-time scheduling policy (SCHED_FIFO, TIME_CRITICAL on windows)
+	};
+
+	ThreadOptions():affinityMask(0), name(0), priority(PRIORITY_NORMAL), stackSize(0) {}
+
+	uint64 affinityMask; ///< bit i allows the thread to run on cpu i, 0 for any cpu
+	const char* name;    ///< shown by debuggers, top and perf (15 characters on Linux), copied by Thread
+	Priority priority;
+	uint32 stackSize;    ///< in bytes, 0 for the OS default (raised to the minimum the OS accepts)
+};
+
 /// \brief Thread class: 
 class DF_SYSTEM_API Thread : NonCopyable
 {
 public:
 	/// create a thread that will execute the run function of the Runnable object
-    Thread(Runnable* runnable);
+    Thread(Runnable* runnable, const ThreadOptions& options = ThreadOptions());
 	/// create a thread that will execute the function given as argument
-	Thread(void (*functionPtr)(void *), void * userData);
+	Thread(void (*functionPtr)(void *), void * userData, const ThreadOptions& options = ThreadOptions());
     ~Thread();
 
 	/// wait for a thread to terminate
@@ -43,6 +67,16 @@ namespace this_thread
 ///Make the current thread sleep for a given duration
 DF_SYSTEM_API void sleep(Time time);
 
+/// Make the current thread sleep until deadline, a time of the monotonic clock (see Timer::getCurrentTime).
+/// The deadline is absolute: an interrupted sleep does not drift, and a loop sleeping until
+/// regular deadlines does not accumulate the wake up latencies. Returns at once if deadline is past.
+DF_SYSTEM_API void sleepUntil(Time deadline);
+
+/// Sleep until spinTime before deadline, then spin on the clock until deadline.
+/// Wakes up within a few microseconds of the deadline, at the cost of keeping a core busy during
+/// spinTime. The default spinTime (Time()) covers the usual wake up latency of the OS scheduler.
+DF_SYSTEM_API void sleepUntilPrecise(Time deadline, Time spinTime = Time());
+
 /// Yield execution to another thread.
 /// Offers the operating system the opportunity to schedule another thread
 /// that is ready to run on the current processor.
@@ -50,6 +84,22 @@ DF_SYSTEM_API void yield();
 
 /// Return the thread ID of the calling thread.
 DF_SYSTEM_API uint32 getID();
+
+/// Return the cpu the calling thread is running on (it may have moved by the time the value is used).
+/// Return 0 on platforms without this information.
+DF_SYSTEM_API uint32 getCurrentCPU();
+
+/// Return the number of hardware threads.
+DF_SYSTEM_API uint32 getHardwareConcurrency();
+
+/// Restrict the calling thread to the cpus of mask (bit i for cpu i), return false if refused.
+DF_SYSTEM_API bool setAffinity(uint64 affinityMask);
+
+/// Name the calling thread for debuggers and profilers, return false if refused.
+DF_SYSTEM_API bool setName(const char* name);
+
+/// Change the scheduling priority of the calling thread, return false if refused.
+DF_SYSTEM_API bool setPriority(ThreadOptions::Priority priority);
 }
 
 } // namespace df
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Mutex.h>
+
+namespace df
+{
+namespace priv
+{
+class ThreadLocalImpl;
+
+/// \brief Part of ThreadLocal independent of the value type
+/// Keeps the list of the per-thread instances and destroys them at thread exit.
+class DF_SYSTEM_API ThreadLocalBase : NonCopyable
+{
+public:
+	/// header of a per-thread instance
+	struct Slot
+	{
+		ThreadLocalBase* owner;
+		Slot* previous;
+		Slot* next;
+	};
+
+protected:
+	explicit ThreadLocalBase(void (*destroySlot)(Slot*));
+	/// destroy the instances of all the threads
+	~ThreadLocalBase();
+
+	/// instance of the calling thread, NULL if it was not created yet
+	Slot* getSlot() const;
+	/// make slot the instance of the calling thread
+	void addSlot(Slot* slot);
+
+	/// the instances cannot be created nor destroyed while the list is locked
+	void lockSlots() const { _mutex.lock(); }
+	void unlockSlots() const { _mutex.unlock(); }
+	Slot* getFirstSlot() const { return _slots; }
+	uint32 getSlotCount() const { return _slotCount; }
+
+private:
+	static void onThreadExit(void* slot);
+	void removeSlot(Slot* slot);
+
+	ThreadLocalImpl* _threadLocalImpl; ///< OS-specific implementation
+	mutable Mutex _mutex;              ///< protects the list of slots
+	Slot* _slots;
+	uint32 _slotCount;
+	void (*_destroySlot)(Slot*);
+};
+}
+
+/// \brief A value with one instance per thread
+/// The instance of a thread is constructed by its first call to get() (as a copy of the initial value)
+/// and destroyed when the thread exits, or with the ThreadLocal. Unlike DF_THREAD_LOCAL, T can be any
+/// copyable type and each ThreadLocal object has its own instances.
+/// The instances of all the threads can be enumerated, to aggregate per-thread counters or buffers.
+/// A ThreadLocal must not be destroyed while other threads are using it or exiting.
+/// On Windows the instances are per fiber (fiber local storage, the only one calling a destructor):
+/// a fiber created with CreateFiber gets its own instance, destroyed when the fiber is deleted.
+/// Code running on fibers must not keep a reference to the instance across a fiber switch.
+template<class T>
+class ThreadLocal : private priv::ThreadLocalBase
+{
+public:
+	ThreadLocal():priv::ThreadLocalBase(&destroyInstance), _initialValue() {}
+	explicit ThreadLocal(const T& initialValue):priv::ThreadLocalBase(&destroyInstance), _initialValue(initialValue) {}
+
+	/// instance of the calling thread
+	T& get()
+	{
+		Slot* slot = getSlot();
+		if(!slot)
+		{
+			slot = new Instance(_initialValue);
+			addSlot(slot);
+		}
+		return static_cast<Instance*>(slot)->value;
+	}
+	T& operator*() { return get(); }
+	T* operator->() { return &get(); }
+
+	/// true if the calling thread has created its instance
+	bool hasInstance() const { return getSlot() != 0; }
+
+	/// call func(T&) for the instance of each thread, return func (as std::for_each)
+	/// Threads can keep modifying their instance meanwhile, but they cannot exit.
+	template<class Func>
+	Func forEach(Func func)
+	{
+		lockSlots();
+		for(Slot* slot = getFirstSlot(); slot; slot = slot->next) {
+			func(static_cast<Instance*>(slot)->value);
+		}
+		unlockSlots();
+		return func;
+	}
+
+	/// number of threads having created their instance
+	uint32 getInstanceCount() const
+	{
+		lockSlots();
+		const uint32 count = getSlotCount();
+		unlockSlots();
+		return count;
+	}
+
+private:
+	struct Instance : public Slot
+	{
+		explicit Instance(const T& initialValue):value(initialValue) {}
+		T value;
+	};
+
+	static void destroyInstance(Slot* slot) { delete static_cast<Instance*>(slot); }
+
+	T _initialValue;
+};
+
+} // namespace df
@@ -0,0 +1,69 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/AtomicOps.h>
+
+namespace df
+{
+class Runnable;
+
+/// \brief A set of tasks that can be waited for together.
+/// Tasks are added to a group when they are submitted with it. A group must outlive its tasks.
+class DF_SYSTEM_API TaskGroup : NonCopyable
+{
+public:
+	TaskGroup():_pendingCount(0) {}
+	~TaskGroup() {}
+
+	/// true when all the tasks submitted with this group have been executed
+	bool isDone() const { return (priv::atomicLoadAcquire(&_pendingCount) & ~WAITER_FLAG) == 0; }
+
+private:
+	friend class ThreadPool;
+	/// set in _pendingCount when a thread may be parked on it: the last task wakes it up
+	static const uint32 WAITER_FLAG = 0x80000000;
+	volatile uint32 _pendingCount; ///< number of submitted tasks not executed yet, and WAITER_FLAG
+};
+
+/// \brief A fixed set of worker threads executing submitted tasks.
+/// Workers are created once and parked while there is no work, so submitting a task
+/// does not cost a thread creation.
+/// Each worker owns a work-stealing deque (Chase-Lev): tasks submitted by a worker go to its own deque
+/// and are executed in LIFO order, idle workers steal the oldest tasks of the others.
+/// Tasks submitted by other threads go to a shared queue.
+class DF_SYSTEM_API ThreadPool : NonCopyable
+{
+public:
+	/// one worker per hardware thread, minus one for the thread submitting the work
+	static const uint32 DEFAULT_WORKER_COUNT = 0xFFFFFFFF;
+
+	explicit ThreadPool(uint32 workerCount = DEFAULT_WORKER_COUNT);
+	/// execute the tasks still queued then stop the workers
+	~ThreadPool();
+
+	uint32 getWorkerCount() const;
+
+	/// queue a task, it will be executed by one of the workers (from any thread, including the workers)
+	/// A pool without worker executes the task immediately on the calling thread.
+	void submit(void (*functionPtr)(void *), void * userData);
+	/// queue a task as part of group
+	void submit(TaskGroup& group, void (*functionPtr)(void *), void * userData);
+	/// queue the execution of the run function of the Runnable object
+	void submit(Runnable* runnable);
+	void submit(TaskGroup& group, Runnable* runnable);
+
+	/// wait until all the tasks of the group are executed
+	/// The calling thread executes queued tasks meanwhile, so it is safe to wait from a task.
+	/// When there is nothing left to execute, a worker keeps looking for tasks while another thread
+	/// spins a little then sleeps until the last task of the group wakes it up.
+	void wait(TaskGroup& group);
+
+	/// return the number of hardware threads of the machine
+	static uint32 getHardwareConcurrency();
+
+private:
+	class PrivateData;
+	PrivateData* _data;
+};
+
+} // namespace df
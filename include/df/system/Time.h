@@ -4,50 +4,66 @@
 namespace df
 {
 /// Represents a high precision Time/ TimeSpan, can represent a negative timespan.
+/// Stored as an integer number of nanoseconds (about 292 years either way): integer arithmetic is
+/// exact, and the float ones are computed in double precision.
 class DF_SYSTEM_API Time
 {
 public:
-	Time():_microseconds(0){}
+	Time():_nanoseconds(0){}
 
-	float asSeconds() const { return _microseconds / 1000000.f; }
-	float asMilliseconds() const { return _microseconds / 1000.f; }
-	int64 asMicroseconds() const { return _microseconds; }
+	float asSeconds() const { return float(_nanoseconds / 1000000000.0); }
+	float asMilliseconds() const { return float(_nanoseconds / 1000000.0); }
+	/// truncated toward zero
+	int64 asMicroseconds() const { return _nanoseconds / 1000; }
+	int64 asNanoseconds() const { return _nanoseconds; }
 
 private:
-	explicit Time(int64 microseconds): _microseconds(microseconds) {}
+	explicit Time(int64 nanoseconds): _nanoseconds(nanoseconds) {}
     friend DF_SYSTEM_API Time seconds(float);
     friend DF_SYSTEM_API Time milliseconds(float);
     friend DF_SYSTEM_API Time microseconds(int64);
-    int64 _microseconds;
+    friend DF_SYSTEM_API Time nanoseconds(int64);
+    int64 _nanoseconds;
 };
 
 ///return a Time from a number of seconds
-inline DF_SYSTEM_API Time seconds(float seconds) { return Time(static_cast<int64>(seconds * 1000000)); }
+inline DF_SYSTEM_API Time seconds(float seconds) { return Time(static_cast<int64>(seconds * 1000000000.0)); }
 ///return a Time from a number of milliseconds
-inline DF_SYSTEM_API Time milliseconds(float milliseconds) { return Time(static_cast<int64>(milliseconds) * 1000); }
+inline DF_SYSTEM_API Time milliseconds(float milliseconds) { return Time(static_cast<int64>(milliseconds * 1000000.0)); }
 ///return a Time from a number of microseconds
-inline DF_SYSTEM_API Time microseconds(int64 microseconds) { return Time(microseconds); }
+inline DF_SYSTEM_API Time microseconds(int64 microseconds) { return Time(microseconds * 1000); }
+///return a Time from a number of nanoseconds
+inline DF_SYSTEM_API Time nanoseconds(int64 nanoseconds) { return Time(nanoseconds); }
 
-inline DF_SYSTEM_API bool operator ==(Time left, Time right) { return left.asMicroseconds() == right.asMicroseconds(); }
-inline DF_SYSTEM_API bool operator !=(Time left, Time right) { return left.asMicroseconds() != right.asMicroseconds(); }
-inline DF_SYSTEM_API bool operator <(Time left, Time right) { return left.asMicroseconds() < right.asMicroseconds(); }
-inline DF_SYSTEM_API bool operator >(Time left, Time right) { return left.asMicroseconds() > right.asMicroseconds(); }
-inline DF_SYSTEM_API bool operator <=(Time left, Time right) { return left.asMicroseconds() <= right.asMicroseconds(); }
-inline DF_SYSTEM_API bool operator >=(Time left, Time right) { return left.asMicroseconds() >= right.asMicroseconds(); }
-inline DF_SYSTEM_API Time operator -(Time right) { return microseconds(-right.asMicroseconds()); }
-inline DF_SYSTEM_API Time operator +(Time left, Time right) { return microseconds(left.asMicroseconds() + right.asMicroseconds()); }
+inline DF_SYSTEM_API bool operator ==(Time left, Time right) { return left.asNanoseconds() == right.asNanoseconds(); }
+inline DF_SYSTEM_API bool operator !=(Time left, Time right) { return left.asNanoseconds() != right.asNanoseconds(); }
+inline DF_SYSTEM_API bool operator <(Time left, Time right) { return left.asNanoseconds() < right.asNanoseconds(); }
+inline DF_SYSTEM_API bool operator >(Time left, Time right) { return left.asNanoseconds() > right.asNanoseconds(); }
+inline DF_SYSTEM_API bool operator <=(Time left, Time right) { return left.asNanoseconds() <= right.asNanoseconds(); }
+inline DF_SYSTEM_API bool operator >=(Time left, Time right) { return left.asNanoseconds() >= right.asNanoseconds(); }
+inline DF_SYSTEM_API Time operator -(Time right) { return nanoseconds(-right.asNanoseconds()); }
+inline DF_SYSTEM_API Time operator +(Time left, Time right) { return nanoseconds(left.asNanoseconds() + right.asNanoseconds()); }
 inline DF_SYSTEM_API Time& operator +=(Time& left, Time right) { return left = left + right; }
-inline DF_SYSTEM_API Time operator -(Time left, Time right) { return microseconds(left.asMicroseconds() - right.asMicroseconds()); }
+inline DF_SYSTEM_API Time operator -(Time left, Time right) { return nanoseconds(left.asNanoseconds() - right.asNanoseconds()); }
 inline DF_SYSTEM_API Time& operator -=(Time& left, Time right) { return left = left - right; }
-inline DF_SYSTEM_API Time operator *(Time left, float right) { return seconds(left.asSeconds() * right); }
-inline DF_SYSTEM_API Time operator *(Time left, int64 right) { return microseconds(left.asMicroseconds() * right); }
+inline DF_SYSTEM_API Time operator *(Time left, float right) { return nanoseconds(static_cast<int64>(left.asNanoseconds() * double(right))); }
+inline DF_SYSTEM_API Time operator *(Time left, int64 right) { return nanoseconds(left.asNanoseconds() * right); }
+inline DF_SYSTEM_API Time operator *(Time left, int32 right) { return nanoseconds(left.asNanoseconds() * right); }
 inline DF_SYSTEM_API Time operator *(float left, Time right) { return right * left; }
 inline DF_SYSTEM_API Time operator *(int64 left, Time right) { return right * left; }
+inline DF_SYSTEM_API Time operator *(int32 left, Time right) { return right * left; }
 inline DF_SYSTEM_API Time& operator *=(Time& left, float right) { return left = left * right; }
 inline DF_SYSTEM_API Time& operator *=(Time& left, int64 right) { return left = left * right; }
-inline DF_SYSTEM_API Time operator /(Time left, float right) { return seconds(left.asSeconds() / right); }
-inline DF_SYSTEM_API Time operator /(Time left, int64 right) { return microseconds(left.asMicroseconds() / right); }
+inline DF_SYSTEM_API Time& operator *=(Time& left, int32 right) { return left = left * right; }
+inline DF_SYSTEM_API Time operator /(Time left, float right) { return nanoseconds(static_cast<int64>(left.asNanoseconds() / double(right))); }
+inline DF_SYSTEM_API Time operator /(Time left, int64 right) { return nanoseconds(left.asNanoseconds() / right); }
+inline DF_SYSTEM_API Time operator /(Time left, int32 right) { return nanoseconds(left.asNanoseconds() / right); }
 inline DF_SYSTEM_API Time& operator /=(Time& left, float right) { return left = left / right; }
 inline DF_SYSTEM_API Time& operator /=(Time& left, int64 right) { return left = left / right; }
+inline DF_SYSTEM_API Time& operator /=(Time& left, int32 right) { return left = left / right; }
+/// number of times right fits in left, truncated toward zero
+inline DF_SYSTEM_API int64 operator /(Time left, Time right) { return left.asNanoseconds() / right.asNanoseconds(); }
+inline DF_SYSTEM_API Time operator %(Time left, Time right) { return nanoseconds(left.asNanoseconds() % right.asNanoseconds()); }
+inline DF_SYSTEM_API Time& operator %=(Time& left, Time right) { return left = left % right; }
 
 } // namespace df
@@ -16,6 +16,10 @@ public :
 
     /// Restart the timer
     Time restart();
+
+    /// Return the time of the monotonic clock used by the timers (its origin is unspecified).
+    /// Deadlines for this_thread::sleepUntil are expressed on this clock.
+    static Time getCurrentTime();
 private :
     Time _startTime;
 };
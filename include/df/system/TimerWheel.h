@@ -0,0 +1,105 @@
+#pragma once
+#include <df/system/Export.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+#include <df/system/Array.h>
+
+namespace df
+{
+/// identifies a scheduled timer, 0 is never a valid timer
+typedef uint64 TimerId;
+
+/// \brief Hierarchical timing wheel: schedules and cancels timers in constant time
+/// Time is cut in ticks of a fixed resolution, timers fire at the first tick at or after their
+/// deadline. 4 levels of 256 slots each cover 2^32 ticks (49 days at 1 ms), farther timers are
+/// parked in the last level and placed again as time passes. Timers of a level are moved to the
+/// level below when time reaches their slot, so advancing costs O(1) per tick plus O(1) per timer,
+/// and the ticks which can neither fire nor move a timer are skipped.
+/// Timers live in a pool which grows to the largest number of timers scheduled at once and is
+/// then reused: scheduling does not allocate once the pool is large enough (see reserve).
+/// Not thread safe: see TimerWheelThread for a wheel driven by its own thread.
+class DF_SYSTEM_API TimerWheel : NonCopyable
+{
+public:
+	/// deadlines are times of the Timer clock (see Timer::getCurrentTime)
+	explicit TimerWheel(Time resolution = milliseconds(1.0f));
+	/// timers still scheduled are dropped without being called
+	~TimerWheel();
+
+	Time getResolution() const { return _resolution; }
+	/// number of timers scheduled
+	uint32 getCount() const { return _count; }
+	/// make room for count timers
+	void reserve(uint32 count);
+
+	/// call functionPtr(userData) once deadline is reached (at the next advance if it is already past)
+	TimerId schedule(Time deadline, void (*functionPtr)(void *), void * userData);
+	/// unschedule a timer, return false if it already fired or was cancelled
+	bool cancel(TimerId timer);
+
+	/// fire the timers whose deadline is before now, return the number of timers fired
+	/// Callbacks are called in deadline order (tick by tick) and can schedule and cancel timers.
+	uint32 advance(Time now);
+
+	/// time of the next tick which may fire a timer (a lower bound when only far timers are left)
+	/// Return a time in the past if there is no timer.
+	Time getNextDeadline() const;
+
+private:
+	static const uint32 LEVEL_COUNT = 4;
+	static const uint32 SLOT_BITS = 8;
+	static const uint32 SLOT_COUNT = 1 << SLOT_BITS;
+	static const uint32 NONE = 0xFFFFFFFF;
+
+	struct Node
+	{
+		uint64 tick;                   ///< tick at which the timer fires
+		void (*functionPtr)(void *);   ///< NULL for a free node
+		void * userData;
+		uint32 previous;               ///< in its slot, or in the free list (next only)
+		uint32 next;
+		uint32 slot;                   ///< level * SLOT_COUNT + slot index
+		uint32 generation;             ///< incremented when the node is freed, invalidates the old ids
+	};
+
+	uint32 allocateNode();
+	void freeNode(uint32 index);
+	/// put a node in the slot of its tick
+	void insert(uint32 index);
+	void unlink(uint32 index);
+	/// move the timers of a slot to the lower levels
+	void cascade(uint32 level);
+	/// lowest level having timers, LEVEL_COUNT if there is none
+	uint32 getLowestLevel() const;
+
+	Time _resolution;
+	Time _origin;          ///< time of tick 0
+	uint64 _currentTick;   ///< last tick processed
+	uint32 _count;
+	uint32 _firstFree;
+	uint32 _levelCounts[LEVEL_COUNT]; ///< timers in the slots of each level
+	Array<Node> _nodes;
+	uint32 _slots[LEVEL_COUNT * SLOT_COUNT]; ///< first node of each slot
+};
+
+/// \brief TimerWheel driven by a dedicated thread
+/// Timers can be scheduled and cancelled from any thread, their callbacks run on the driver thread
+/// (and can schedule and cancel timers too). The driver sleeps until the next tick having timers.
+class DF_SYSTEM_API TimerWheelThread : NonCopyable
+{
+public:
+	explicit TimerWheelThread(Time resolution = milliseconds(1.0f));
+	/// stop the driver, timers still scheduled are dropped without being called
+	~TimerWheelThread();
+
+	TimerId schedule(Time deadline, void (*functionPtr)(void *), void * userData);
+	/// return false if the timer already fired (or is being fired) or was cancelled
+	bool cancel(TimerId timer);
+	uint32 getCount() const;
+
+private:
+	class PrivateData;
+	PrivateData* _data;
+};
+
+} // namespace df
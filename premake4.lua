@@ -3,6 +3,16 @@
 
 -- Dependencies overview
 
+newoption {
+  trigger     = "mutex-profiling",
+  description = "Record the contention statistics of df::Mutex (DF_MUTEX_PROFILING)"
+}
+
+newoption {
+  trigger     = "profiling",
+  description = "Record the DF_PROFILE_SCOPE zones (DF_PROFILING)"
+}
+
 solution "df"
   configurations { "Debug", "Release" }
   platforms { "x32", "x64" }
@@ -30,6 +40,15 @@ solution "df"
       "_CRT_SECURE_NO_WARNINGS",
       "_CRT_SECURE_NO_DEPRECATE" }
  
+  -- changes the layout of df::Mutex: the library and its users must agree
+  if _OPTIONS["mutex-profiling"] then
+    defines { "DF_MUTEX_PROFILING" }
+  end
+
+  if _OPTIONS["profiling"] then
+    defines { "DF_PROFILING" }
+  end
+
   if _ACTION == "clean" then
     os.rmdir("_bin")
     os.rmdir("_build")
@@ -0,0 +1,213 @@
+#include <df/system/CycleTimer.h>
+
+#if defined(DF_PLATFORM_WIN)
+	#include <df/system/win32/TimerImpl.h>
+#else
+	#include <df/system/posix/TimerImpl.h>
+#endif
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+	#define DF_CYCLE_TIMER_TSC
+	#if defined(DF_COMPILER_MSVC)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace df
+{
+
+namespace
+{
+const int64 CALIBRATION_TIME = 10000000; ///< in nanoseconds
+
+struct Calibration
+{
+	bool isTscUsed;
+	bool hasRdtscp;
+	uint64 frequency;           ///< cycles per second
+	double nanosecondsPerCycle;
+};
+
+/// time of the Timer clock in nanoseconds
+inline uint64 readClock()
+{
+	return uint64(priv::TimerImpl::getCurrentTime().asNanoseconds());
+}
+
+#if defined(DF_CYCLE_TIMER_TSC)
+inline uint64 readTsc()
+{
+#if defined(DF_COMPILER_MSVC)
+	return __rdtsc();
+#else
+	uint32 low, high;
+	__asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+	return (uint64(high) << 32) | low;
+#endif
+}
+
+inline uint64 readTscSerialized()
+{
+#if defined(DF_COMPILER_MSVC)
+	unsigned int processor;
+	return __rdtscp(&processor);
+#else
+	uint32 low, high, processor;
+	__asm__ __volatile__("rdtscp" : "=a"(low), "=d"(high), "=c"(processor) : : "memory");
+	return (uint64(high) << 32) | low;
+#endif
+}
+
+/// registers eax, ebx, ecx, edx of cpuid leaf, false if the leaf is not supported
+bool readCpuid(uint32 leaf, uint32 registers[4])
+{
+#if defined(DF_COMPILER_MSVC)
+	int result[4];
+	__cpuid(result, int(leaf & 0x80000000));
+	if(uint32(result[0]) < leaf) {
+		return false;
+	}
+	__cpuid(result, int(leaf));
+	for(int i = 0; i < 4; ++i) {
+		registers[i] = uint32(result[i]);
+	}
+	return true;
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if(!__get_cpuid(leaf, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+	registers[0] = eax;
+	registers[1] = ebx;
+	registers[2] = ecx;
+	registers[3] = edx;
+	return true;
+#endif
+}
+
+/// wait for the Timer clock to tick, return its new time (in nanoseconds) and the TSC read just after
+int64 waitClockTick(uint64& tsc)
+{
+	const int64 start = priv::TimerImpl::getCurrentTime().asNanoseconds();
+	int64 now;
+	do {
+		now = priv::TimerImpl::getCurrentTime().asNanoseconds();
+		tsc = readTsc();
+	} while(now == start);
+	return now;
+}
+#endif
+
+Calibration calibrate()
+{
+	Calibration calibration;
+	calibration.isTscUsed = false;
+	calibration.hasRdtscp = false;
+	calibration.frequency = 1000000000;
+	calibration.nanosecondsPerCycle = 1.0;
+
+#if defined(DF_CYCLE_TIMER_TSC)
+	// invariant TSC: cpuid 0x80000007, edx bit 8. rdtscp: cpuid 0x80000001, edx bit 27
+	uint32 registers[4];
+	if(!readCpuid(0x80000007, registers) || !(registers[3] & (1 << 8))) {
+		return calibration;
+	}
+	calibration.hasRdtscp = readCpuid(0x80000001, registers) && (registers[3] & (1 << 27));
+
+	// count the cycles between two ticks of the Timer clock about CALIBRATION_TIME apart
+	uint64 startTsc, endTsc;
+	const int64 startTime = waitClockTick(startTsc);
+	int64 endTime;
+	do {
+		endTime = waitClockTick(endTsc);
+	} while(endTime - startTime < CALIBRATION_TIME);
+	if(endTsc <= startTsc) {
+		return calibration;
+	}
+
+	calibration.isTscUsed = true;
+	calibration.frequency = uint64(double(endTsc - startTsc) * 1000000000.0 / double(endTime - startTime));
+	calibration.nanosecondsPerCycle = 1000000000.0 / double(calibration.frequency);
+#endif
+	return calibration;
+}
+
+const Calibration& getCalibration()
+{
+	static const Calibration calibration = calibrate();
+	return calibration;
+}
+}
+
+CycleTimer::CycleTimer()
+	:_startCycles(getCurrentCycles())
+{
+}
+
+Time CycleTimer::getElapsedTime() const
+{
+	return toTime(getCurrentCycles() - _startCycles);
+}
+
+int64 CycleTimer::getElapsedNanoseconds() const
+{
+	return toNanoseconds(getCurrentCycles() - _startCycles);
+}
+
+uint64 CycleTimer::getElapsedCycles() const
+{
+	return getCurrentCycles() - _startCycles;
+}
+
+Time CycleTimer::restart()
+{
+	const uint64 now = getCurrentCycles();
+	const uint64 elapsed = now - _startCycles;
+	_startCycles = now;
+	return toTime(elapsed);
+}
+
+uint64 CycleTimer::getCurrentCycles()
+{
+#if defined(DF_CYCLE_TIMER_TSC)
+	if(getCalibration().isTscUsed) {
+		return readTsc();
+	}
+#endif
+	return readClock();
+}
+
+uint64 CycleTimer::getCurrentCyclesSerialized()
+{
+#if defined(DF_CYCLE_TIMER_TSC)
+	const Calibration& calibration = getCalibration();
+	if(calibration.hasRdtscp && calibration.isTscUsed) {
+		return readTscSerialized();
+	}
+#endif
+	return getCurrentCycles();
+}
+
+int64 CycleTimer::toNanoseconds(uint64 cycles)
+{
+	return int64(double(cycles) * getCalibration().nanosecondsPerCycle);
+}
+
+Time CycleTimer::toTime(uint64 cycles)
+{
+	return nanoseconds(toNanoseconds(cycles));
+}
+
+uint64 CycleTimer::getFrequency()
+{
+	return getCalibration().frequency;
+}
+
+bool CycleTimer::isTscUsed()
+{
+	return getCalibration().isTscUsed;
+}
+
+} // namespace df
@@ -0,0 +1,255 @@
+#include <df/system/EpochReclamation.h>
+#include <df/system/ThreadLocal.h>
+#include <df/system/Atomic.h>
+#include <df/system/Mutex.h>
+#include <df/system/RingBuffer.h>
+#include <df/system/Thread.h>
+#include <cassert>
+
+namespace df
+{
+
+namespace
+{
+struct RetiredObject
+{
+	void* object;
+	void (*deleter)(void*);
+	uint32 epoch; ///< global epoch when the object was retired
+};
+
+/// objects retired in epoch can be freed once the global epoch is 2 ahead: every thread in a
+/// critical section then entered it after the object was unlinked
+bool isSafe(const RetiredObject& retired, uint32 globalEpoch)
+{
+	return int32(globalEpoch - retired.epoch) >= 2;
+}
+
+/// state of a thread record: 0 when outside of a critical section, (epoch << 1) | 1 inside
+const uint32 ACTIVE = 1;
+const uint32 EPOCH_MASK = 0x7FFFFFFF;
+}
+
+class EpochDomain::PrivateData
+{
+public:
+	/// participation of a thread in the domain
+	struct ThreadRecord
+	{
+		explicit ThreadRecord(PrivateData* domain):domain(domain), nesting(0) {}
+		/// ThreadLocal creates the record of each thread as a copy of an initial record
+		ThreadRecord(const ThreadRecord& other):domain(other.domain), nesting(0) {}
+		/// at thread exit, hand the objects over to the domain
+		~ThreadRecord()
+		{
+			if(!retired.empty()) {
+				domain->adoptOrphans(retired);
+			}
+		}
+
+		PrivateData* domain;
+		Atomic<uint32> state;
+		uint32 nesting;                  ///< depth of nested critical sections
+		RingBuffer<RetiredObject> retired; ///< in retirement order, so in epoch order
+	private:
+		ThreadRecord& operator=(const ThreadRecord&);
+	};
+
+	/// looks for an active thread which did not enter the current epoch
+	struct FindLaggard
+	{
+		explicit FindLaggard(uint32 epoch):epoch(epoch & EPOCH_MASK), isFound(false) {}
+		void operator()(ThreadRecord& record)
+		{
+			// acquire: what a thread read in its previous critical section happens before the objects are freed
+			const uint32 state = record.state.load(MEMORY_ORDER_ACQUIRE);
+			if((state & ACTIVE) && (state >> 1) != epoch) {
+				isFound = true;
+			}
+		}
+		uint32 epoch;
+		bool isFound;
+	};
+
+	PrivateData():records(NULL), orphansMutex("df::EpochDomain orphans")
+	{
+		records = new ThreadLocal<ThreadRecord>(ThreadRecord(this));
+	}
+	~PrivateData()
+	{
+		// destroys the remaining records, their objects become orphans
+		delete records;
+		while(!orphans.empty())
+		{
+			const RetiredObject retired = orphans.front();
+			orphans.pop_front();
+			retired.deleter(retired.object);
+		}
+	}
+
+	Atomic<uint32> globalEpoch;
+	Atomic<uint32> retiredCount;
+	ThreadLocal<ThreadRecord>* records;
+
+	Mutex orphansMutex;
+	RingBuffer<RetiredObject> orphans; ///< retired by exited threads, protected by orphansMutex
+
+	void adoptOrphans(RingBuffer<RetiredObject>& retired)
+	{
+		ScopedLock lock(orphansMutex);
+		while(!retired.empty())
+		{
+			orphans.push_back(retired.front());
+			retired.pop_front();
+		}
+	}
+
+	/// advance the epoch if all the threads in a critical section entered the current one
+	void tryAdvance()
+	{
+		uint32 epoch = globalEpoch.load(MEMORY_ORDER_ACQUIRE);
+		// pairs with the exchange in enter: either we see the thread active or it sees the new epoch
+		priv::atomicThreadFence();
+		if(records->forEach(FindLaggard(epoch)).isFound) {
+			return;
+		}
+		globalEpoch.compareExchange(epoch, epoch + 1);
+	}
+
+	/// free the safe objects at the front of retired, return how many
+	uint32 freeSafe(RingBuffer<RetiredObject>& retired)
+	{
+		const uint32 epoch = globalEpoch.load(MEMORY_ORDER_ACQUIRE);
+		uint32 count = 0;
+		while(!retired.empty() && isSafe(retired.front(), epoch))
+		{
+			// the deleter may retire more objects (children of a node)
+			const RetiredObject object = retired.front();
+			retired.pop_front();
+			object.deleter(object.object);
+			++count;
+		}
+		return count;
+	}
+
+	uint32 freeSafeOrphans()
+	{
+		RingBuffer<RetiredObject> safe;
+		{
+			ScopedLock lock(orphansMutex);
+			const uint32 epoch = globalEpoch.load(MEMORY_ORDER_ACQUIRE);
+			// orphans are in adoption order, not in epoch order: check them all
+			for(uint32 i = orphans.size(); i > 0; --i)
+			{
+				const RetiredObject retired = orphans.front();
+				orphans.pop_front();
+				if(isSafe(retired, epoch)) {
+					safe.push_back(retired);
+				} else {
+					orphans.push_back(retired);
+				}
+			}
+		}
+		// freed without the lock, a deleter may retire more objects
+		const uint32 count = safe.size();
+		while(!safe.empty())
+		{
+			safe.front().deleter(safe.front().object);
+			safe.pop_front();
+		}
+		return count;
+	}
+};
+
+EpochDomain::EpochDomain()
+{
+	_data = new PrivateData();
+}
+
+EpochDomain::~EpochDomain()
+{
+	delete _data;
+}
+
+void EpochDomain::enter()
+{
+	PrivateData::ThreadRecord& record = _data->records->get();
+	if(record.nesting++ == 0)
+	{
+		const uint32 epoch = _data->globalEpoch.load(MEMORY_ORDER_RELAXED);
+		// sequentially consistent: the announcement is visible before any read of the critical section
+		record.state.exchange(((epoch & EPOCH_MASK) << 1) | ACTIVE);
+	}
+}
+
+void EpochDomain::leave()
+{
+	PrivateData::ThreadRecord& record = _data->records->get();
+	assert(record.nesting > 0 && "Leaving an epoch critical section that was not entered");
+	if(--record.nesting == 0) {
+		record.state.store(0, MEMORY_ORDER_RELEASE);
+	}
+}
+
+bool EpochDomain::isInCriticalSection()
+{
+	return _data->records->hasInstance() && _data->records->get().nesting > 0;
+}
+
+void EpochDomain::retire(void* object, void (*deleter)(void*))
+{
+	assert(deleter != NULL && "A retired object needs a deleter");
+	PrivateData::ThreadRecord& record = _data->records->get();
+	RetiredObject retired = { object, deleter, _data->globalEpoch.load(MEMORY_ORDER_ACQUIRE) };
+	record.retired.push_back(retired);
+	_data->retiredCount.fetchAdd(1, MEMORY_ORDER_RELAXED);
+	if(record.retired.size() >= COLLECT_THRESHOLD) {
+		collect();
+	}
+}
+
+uint32 EpochDomain::collect()
+{
+	_data->tryAdvance();
+	uint32 count = _data->freeSafe(_data->records->get().retired);
+	count += _data->freeSafeOrphans();
+	_data->retiredCount.fetchSub(count, MEMORY_ORDER_RELAXED);
+	return count;
+}
+
+void EpochDomain::synchronize()
+{
+	assert(!isInCriticalSection() && "synchronize would wait for the calling thread");
+	PrivateData::ThreadRecord& record = _data->records->get();
+	for(;;)
+	{
+		collect();
+		bool hasOrphans = false;
+		{
+			ScopedLock lock(_data->orphansMutex);
+			hasOrphans = !_data->orphans.empty();
+		}
+		if(record.retired.empty() && !hasOrphans) {
+			return;
+		}
+		this_thread::yield();
+	}
+}
+
+uint32 EpochDomain::getEpoch() const
+{
+	return _data->globalEpoch.load(MEMORY_ORDER_ACQUIRE);
+}
+
+uint32 EpochDomain::getRetiredCount() const
+{
+	return _data->retiredCount.load(MEMORY_ORDER_RELAXED);
+}
+
+EpochDomain& EpochDomain::getDefault()
+{
+	static EpochDomain domain;
+	return domain;
+}
+
+} // namespace df
@@ -0,0 +1,54 @@
+#include <df/system/Event.h>
+#include <df/system/Futex.h>
+#include <df/system/Timer.h>
+
+namespace df
+{
+
+void Event::set()
+{
+	if(priv::atomicExchange(&_isSignaled, uint32(1)) == 1) {
+		return;
+	}
+	// the exchange is a full barrier: a waiter either sees the signal or is counted
+	if(priv::atomicLoadAcquire(&_waiterCount) == 0) {
+		return;
+	}
+	if(_mode == AUTO_RESET) {
+		priv::futexWakeOne(&_isSignaled);
+	} else {
+		priv::futexWakeAll(&_isSignaled);
+	}
+}
+
+void Event::waitContended()
+{
+	priv::atomicFetchAdd(&_waiterCount, uint32(1));
+	while(!tryWait()) {
+		priv::futexWait(&_isSignaled, 0);
+	}
+	priv::atomicFetchAdd(&_waiterCount, uint32(-1));
+}
+
+bool Event::wait(Time timeout)
+{
+	if(tryWait()) {
+		return true;
+	}
+	Timer timer;
+	priv::atomicFetchAdd(&_waiterCount, uint32(1));
+	bool isSignaled = tryWait();
+	while(!isSignaled)
+	{
+		const Time remaining = timeout - timer.getElapsedTime();
+		if(remaining <= Time()) {
+			break;
+		}
+		priv::futexWait(&_isSignaled, 0, remaining);
+		isSignaled = tryWait();
+	}
+	priv::atomicFetchAdd(&_waiterCount, uint32(-1));
+	return isSignaled;
+}
+
+} // namespace df
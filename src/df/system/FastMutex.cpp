@@ -0,0 +1,45 @@
+#include <df/system/FastMutex.h>
+#include <df/system/Futex.h>
+
+namespace df
+{
+
+void FastMutex::lockContended()
+{
+	// from "Futexes Are Tricky" (U. Drepper): mark the mutex as contended so that the owner
+	// wakes us up on unlock, and sleep until we grab it
+	while(priv::atomicExchange(&_state, uint32(CONTENDED)) != UNLOCKED) {
+		priv::futexWait(&_state, CONTENDED);
+	}
+}
+
+void FastMutex::wakeWaiter()
+{
+	priv::futexWakeOne(&_state);
+}
+
+void AdaptiveMutex::lockContended()
+{
+	const uint32 estimate = priv::atomicLoadRelaxed(&_spinEstimate);
+	const uint32 maxSpinCount = (estimate * 2 + 10 < MAX_SPIN_COUNT) ? estimate * 2 + 10 : MAX_SPIN_COUNT;
+	uint32 spinCount = 0;
+	bool isLocked = false;
+	for(; spinCount < maxSpinCount; ++spinCount)
+	{
+		priv::cpuPause();
+		// poll with a plain load, the cache line stays shared while the lock is held
+		if(priv::atomicLoadRelaxed(&_mutex._state) == FastMutex::UNLOCKED && _mutex.tryLock())
+		{
+			isLocked = true;
+			break;
+		}
+	}
+	if(!isLocked) {
+		_mutex.lockContended();
+	}
+	// we own the lock: the estimate is protected by it
+	const int32 current = int32(priv::atomicLoadRelaxed(&_spinEstimate));
+	priv::atomicStoreRelaxed(&_spinEstimate, uint32(current + (int32(spinCount) - current) / 8));
+}
+
+} // namespace df
@@ -0,0 +1,452 @@
+#include <df/system/Fiber.h>
+#include <df/system/Thread.h>
+#include <df/system/FastMutex.h>
+#include <df/system/ConditionVariable.h>
+#include <df/system/Semaphore.h>
+#if defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/FiberContextImpl.h>
+#else
+    #include <df/system/posix/FiberContextImpl.h>
+#endif
+#include <cassert>
+
+#if defined(DF_COMPILER_MSVC)
+	#define DF_FIBER_NOINLINE __declspec(noinline)
+#else
+	#define DF_FIBER_NOINLINE __attribute__((noinline))
+#endif
+
+namespace df
+{
+
+namespace priv
+{
+/// what a worker does once the fiber it resumed switches back to it
+enum SwitchAction
+{
+	ACTION_NONE,
+	ACTION_REQUEUE, ///< the fiber yielded: make it ready again
+	ACTION_PARK,    ///< the fiber is in a wait list: release the lock of the list
+	ACTION_FINISH   ///< the fiber returned: recycle it
+};
+
+struct Fiber
+{
+	Fiber():functionPtr(NULL), userData(NULL), scheduler(NULL), next(NULL) {}
+
+	FiberContextImpl context;
+	void (*functionPtr)(void *);
+	void * userData;
+	FiberScheduler::PrivateData* scheduler;
+	Fiber* next; ///< in the ready queue, a wait list or the free list
+};
+
+struct FiberWorker
+{
+	FiberWorker():thread(NULL), scheduler(NULL), currentFiber(NULL), action(ACTION_NONE), lockToRelease(NULL) {}
+
+	FiberContextImpl context; ///< context of the worker thread, resumed between two fibers
+	Thread* thread;
+	FiberScheduler::PrivateData* scheduler;
+	Fiber* currentFiber;
+	SwitchAction action;
+	SpinLock* lockToRelease;  ///< for ACTION_PARK
+};
+}
+
+using namespace priv;
+
+namespace
+{
+/// worker running on the calling thread, NULL for threads which are not fiber workers
+DF_THREAD_LOCAL FiberWorker* t_currentWorker = NULL;
+
+/// A fiber can be resumed by another thread: the address of t_currentWorker must be computed
+/// again after each switch, which the compiler cannot know when the access is inlined.
+DF_FIBER_NOINLINE FiberWorker* getCurrentWorker()
+{
+	return t_currentWorker;
+}
+
+Fiber* getCurrentFiber()
+{
+	FiberWorker* worker = getCurrentWorker();
+	return worker ? worker->currentFiber : NULL;
+}
+
+/// switch from the current fiber back to its worker, which then performs action
+void switchToWorker(Fiber* fiber, SwitchAction action, SpinLock* lockToRelease = NULL)
+{
+	FiberWorker* worker = getCurrentWorker();
+	worker->action = action;
+	worker->lockToRelease = lockToRelease;
+	FiberContextImpl::switchTo(fiber->context, worker->context);
+	// resumed, maybe by another worker
+}
+
+void pushWaiter(Fiber*& first, Fiber*& last, Fiber* fiber)
+{
+	fiber->next = NULL;
+	if(last) {
+		last->next = fiber;
+	} else {
+		first = fiber;
+	}
+	last = fiber;
+}
+
+Fiber* popWaiter(Fiber*& first, Fiber*& last)
+{
+	Fiber* fiber = first;
+	if(fiber)
+	{
+		first = fiber->next;
+		if(!first) {
+			last = NULL;
+		}
+		fiber->next = NULL;
+	}
+	return fiber;
+}
+
+void runnableEntryPoint(void* runnable)
+{
+	((Runnable*)runnable)->run();
+}
+}
+
+class FiberScheduler::PrivateData
+{
+public:
+	PrivateData(uint32 workerCount, uint32 stackSize)
+		:workers(NULL), workerCount(workerCount), stackSize(stackSize),
+		readyHead(NULL), readyTail(NULL), freeFibers(NULL), runningCount(0)
+	{
+		workers = new FiberWorker[workerCount];
+	}
+	~PrivateData()
+	{
+		delete [] workers;
+		while(freeFibers)
+		{
+			Fiber* fiber = freeFibers;
+			freeFibers = fiber->next;
+			delete fiber;
+		}
+	}
+
+	FiberWorker* workers;
+	uint32 workerCount;
+	uint32 stackSize;
+
+	FastMutex readyMutex;
+	Fiber* readyHead;           ///< FIFO of the fibers to resume, protected by readyMutex
+	Fiber* readyTail;
+	Semaphore readyCount;       ///< one token per ready fiber (plus the stop tokens)
+
+	FastMutex poolMutex;
+	Fiber* freeFibers;          ///< returned fibers, their stack is reused, protected by poolMutex
+
+	FastMutex runningMutex;
+	ConditionVariable allDone;
+	uint32 runningCount;        ///< spawned fibers which have not returned, protected by runningMutex
+
+	void makeReady(Fiber* fiber)
+	{
+		{
+			ScopedLock lock(readyMutex);
+			pushWaiter(readyHead, readyTail, fiber);
+		}
+		readyCount.post();
+	}
+
+	/// NULL when the workers have to stop
+	Fiber* popReady()
+	{
+		readyCount.wait();
+		ScopedLock lock(readyMutex);
+		return popWaiter(readyHead, readyTail);
+	}
+
+	void spawn(void (*functionPtr)(void *), void * userData)
+	{
+		{
+			ScopedLock lock(runningMutex);
+			++runningCount;
+		}
+		Fiber* fiber = NULL;
+		{
+			ScopedLock lock(poolMutex);
+			fiber = freeFibers;
+			if(fiber) {
+				freeFibers = fiber->next;
+			}
+		}
+		if(!fiber)
+		{
+			fiber = new Fiber();
+			fiber->scheduler = this;
+			fiber->context.create(stackSize, &fiberEntryPoint, fiber);
+		}
+		fiber->functionPtr = functionPtr;
+		fiber->userData = userData;
+		makeReady(fiber);
+	}
+
+	void recycle(Fiber* fiber)
+	{
+		{
+			ScopedLock lock(poolMutex);
+			fiber->next = freeFibers;
+			freeFibers = fiber;
+		}
+		ScopedLock lock(runningMutex);
+		if(--runningCount == 0) {
+			allDone.notifyAll();
+		}
+	}
+
+	/// a fiber runs one spawned function after the other: its stack is only set up once
+	static void fiberEntryPoint(void* userData)
+	{
+		Fiber* fiber = (Fiber*) userData;
+		for(;;)
+		{
+			fiber->functionPtr(fiber->userData);
+			switchToWorker(fiber, ACTION_FINISH);
+		}
+	}
+
+	static void workerEntryPoint(void* userData);
+};
+
+void FiberScheduler::PrivateData::workerEntryPoint(void* userData)
+{
+	FiberWorker* worker = (FiberWorker*) userData;
+	PrivateData* data = worker->scheduler;
+	t_currentWorker = worker;
+	worker->context.initializeFromThread();
+
+	while(Fiber* fiber = data->popReady())
+	{
+		worker->currentFiber = fiber;
+		worker->action = ACTION_NONE;
+		FiberContextImpl::switchTo(worker->context, fiber->context);
+		worker->currentFiber = NULL;
+
+		// the fiber is not running on its stack anymore, other workers can resume it
+		switch(worker->action)
+		{
+		case ACTION_REQUEUE:
+			data->makeReady(fiber);
+			break;
+		case ACTION_PARK:
+			worker->lockToRelease->unlock();
+			break;
+		case ACTION_FINISH:
+			data->recycle(fiber);
+			break;
+		default:
+			assert(false && "A fiber switched back to its worker without action");
+		}
+	}
+
+	worker->context.releaseFromThread();
+	t_currentWorker = NULL;
+}
+
+FiberScheduler::FiberScheduler(uint32 workerCount, uint32 stackSize)
+{
+	assert(workerCount > 0 && "A fiber scheduler needs at least one worker");
+	_data = new PrivateData(workerCount, stackSize);
+	ThreadOptions options;
+	options.name = "df_fiber";
+	for(uint32 i = 0; i < workerCount; ++i)
+	{
+		FiberWorker& worker = _data->workers[i];
+		worker.scheduler = _data;
+		worker.thread = new Thread(&PrivateData::workerEntryPoint, &worker, options);
+	}
+}
+
+FiberScheduler::~FiberScheduler()
+{
+	waitAll();
+	// the ready queue is empty: each worker takes a stop token and leaves
+	_data->readyCount.post(_data->workerCount);
+	for(uint32 i = 0; i < _data->workerCount; ++i)
+	{
+		_data->workers[i].thread->join();
+		delete _data->workers[i].thread;
+	}
+	delete _data;
+}
+
+uint32 FiberScheduler::getWorkerCount() const
+{
+	return _data->workerCount;
+}
+
+void FiberScheduler::spawn(void (*functionPtr)(void *), void * userData)
+{
+	assert(functionPtr != NULL && "A fiber function cannot be NULL");
+	_data->spawn(functionPtr, userData);
+}
+
+void FiberScheduler::spawn(Runnable* runnable)
+{
+	assert(runnable != NULL && "A Runnable object cannot be NULL");
+	_data->spawn(&runnableEntryPoint, runnable);
+}
+
+void FiberScheduler::waitAll()
+{
+	assert(!this_fiber::isFiber() && "waitAll would block the worker of the calling fiber");
+	ScopedLock lock(_data->runningMutex);
+	while(_data->runningCount > 0) {
+		_data->allDone.wait(_data->runningMutex);
+	}
+}
+
+// *** this_fiber ***
+namespace this_fiber
+{
+void yield()
+{
+	Fiber* fiber = getCurrentFiber();
+	if(fiber) {
+		switchToWorker(fiber, ACTION_REQUEUE);
+	} else {
+		this_thread::yield();
+	}
+}
+
+bool isFiber()
+{
+	return getCurrentFiber() != NULL;
+}
+}
+
+// *** FiberMutex ***
+void FiberMutex::lock()
+{
+	Fiber* fiber = getCurrentFiber();
+	if(!fiber)
+	{
+		while(!tryLock()) {
+			this_thread::yield();
+		}
+		return;
+	}
+	_lock.lock();
+	if(!_isLocked)
+	{
+		_isLocked = true;
+		_lock.unlock();
+		return;
+	}
+	// unlock hands the mutex over to us, the worker releases _lock once we are off our stack
+	pushWaiter(_firstWaiter, _lastWaiter, fiber);
+	switchToWorker(fiber, ACTION_PARK, &_lock);
+}
+
+bool FiberMutex::tryLock()
+{
+	_lock.lock();
+	const bool isAcquired = !_isLocked;
+	_isLocked = true;
+	_lock.unlock();
+	return isAcquired;
+}
+
+void FiberMutex::unlock()
+{
+	_lock.lock();
+	assert(_isLocked && "Unlocking a FiberMutex which is not locked");
+	Fiber* waiter = popWaiter(_firstWaiter, _lastWaiter);
+	if(!waiter) {
+		_isLocked = false;
+	}
+	_lock.unlock();
+	if(waiter) {
+		waiter->scheduler->makeReady(waiter);
+	}
+}
+
+// *** FiberEvent ***
+void FiberEvent::set()
+{
+	_lock.lock();
+	Fiber* waiters = NULL;
+	if(_mode == Event::MANUAL_RESET)
+	{
+		_isSignaled = true;
+		waiters = _firstWaiter;
+		_firstWaiter = _lastWaiter = NULL;
+	}
+	else
+	{
+		// the signal goes straight to the first waiter, if any
+		waiters = popWaiter(_firstWaiter, _lastWaiter);
+		_isSignaled = (waiters == NULL);
+	}
+	_lock.unlock();
+
+	while(waiters)
+	{
+		Fiber* next = waiters->next;
+		waiters->scheduler->makeReady(waiters);
+		waiters = next;
+	}
+}
+
+void FiberEvent::reset()
+{
+	_lock.lock();
+	_isSignaled = false;
+	_lock.unlock();
+}
+
+bool FiberEvent::isSet() const
+{
+	_lock.lock();
+	const bool isSignaled = _isSignaled;
+	_lock.unlock();
+	return isSignaled;
+}
+
+void FiberEvent::wait()
+{
+	Fiber* fiber = getCurrentFiber();
+	if(!fiber)
+	{
+		while(!tryWait()) {
+			this_thread::yield();
+		}
+		return;
+	}
+	_lock.lock();
+	if(_isSignaled)
+	{
+		if(_mode == Event::AUTO_RESET) {
+			_isSignaled = false;
+		}
+		_lock.unlock();
+		return;
+	}
+	pushWaiter(_firstWaiter, _lastWaiter, fiber);
+	switchToWorker(fiber, ACTION_PARK, &_lock);
+}
+
+bool FiberEvent::tryWait()
+{
+	_lock.lock();
+	const bool isSignaled = _isSignaled;
+	if(_mode == Event::AUTO_RESET) {
+		_isSignaled = false;
+	}
+	_lock.unlock();
+	return isSignaled;
+}
+
+} // namespace df
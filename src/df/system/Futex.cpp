@@ -0,0 +1,94 @@
+#include <df/system/Futex.h>
+#include <df/system/AtomicOps.h>
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+    #define DF_NATIVE_FUTEX
+    #include <df/system/posix/FutexImpl.h>
+#elif defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/ConditionImpl.h>
+#else
+    #include <df/system/posix/ConditionImpl.h>
+#endif
+#include <limits.h>
+
+namespace df
+{
+namespace priv
+{
+
+#if defined(DF_NATIVE_FUTEX)
+
+void futexWait(volatile uint32* address, uint32 expected)
+{
+	FutexImpl::wait(address, expected);
+}
+
+bool futexWait(volatile uint32* address, uint32 expected, Time timeout)
+{
+	return FutexImpl::wait(address, expected, timeout);
+}
+
+void futexWakeOne(volatile uint32* address)
+{
+	FutexImpl::wake(address, 1);
+}
+
+void futexWakeAll(volatile uint32* address)
+{
+	FutexImpl::wake(address, INT_MAX);
+}
+
+#else
+
+namespace
+{
+// Emulation: waiters block on a condition picked from the address. The value is checked with the
+// condition mutex locked, and wakers take this mutex after changing the value: no wake up is lost.
+// A slot is shared by several addresses, so every wake up is a broadcast.
+const uint32 WAIT_SLOT_COUNT = 64;
+ConditionImpl g_waitSlots[WAIT_SLOT_COUNT];
+
+ConditionImpl& getWaitSlot(const volatile void* address)
+{
+	return g_waitSlots[(size_t(address) / sizeof(uint32)) % WAIT_SLOT_COUNT];
+}
+}
+
+void futexWait(volatile uint32* address, uint32 expected)
+{
+	ConditionImpl& slot = getWaitSlot(address);
+	slot.lock();
+	if(atomicLoadAcquire(address) == expected) {
+		slot.wait();
+	}
+	slot.unlock();
+}
+
+bool futexWait(volatile uint32* address, uint32 expected, Time timeout)
+{
+	ConditionImpl& slot = getWaitSlot(address);
+	slot.lock();
+	bool isNotified = true;
+	if(atomicLoadAcquire(address) == expected) {
+		isNotified = slot.wait(timeout);
+	}
+	slot.unlock();
+	return isNotified;
+}
+
+void futexWakeOne(volatile uint32* address)
+{
+	futexWakeAll(address);
+}
+
+void futexWakeAll(volatile uint32* address)
+{
+	ConditionImpl& slot = getWaitSlot(address);
+	slot.lock();
+	slot.notifyAll();
+	slot.unlock();
+}
+
+#endif
+
+} // namespace priv
+} // namespace df
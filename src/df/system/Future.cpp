@@ -0,0 +1,296 @@
+#include <df/system/Future.h>
+#include <df/system/Mutex.h>
+#include <df/system/Timer.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Futex.h>
+#include <stdlib.h>
+
+namespace df
+{
+namespace priv
+{
+
+namespace
+{
+enum FutureStatus { STATUS_PENDING, STATUS_VALUE, STATUS_BROKEN };
+
+/// marks the continuation list of a ready state: new continuations run immediately
+FutureContinuation* const CLOSED_LIST = (FutureContinuation*) 1;
+
+// *** block pool ***
+// Freed blocks are kept in a list per size class and reused by the next allocations,
+// the pool never gives memory back.
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+
+const uint32 BLOCK_CLASS_COUNT = 4;
+const uint32 SMALLEST_BLOCK_SIZE = 64;
+
+Mutex g_freeBlocksMutex("df::Future blocks");
+FreeBlock* g_freeBlocks[BLOCK_CLASS_COUNT]; ///< protected by g_freeBlocksMutex
+
+/// size class of a block, BLOCK_CLASS_COUNT if it is too large to be recycled
+uint32 getBlockClass(uint32 size)
+{
+	uint32 blockClass = 0;
+	for(uint32 blockSize = SMALLEST_BLOCK_SIZE; blockClass < BLOCK_CLASS_COUNT && blockSize < size; blockSize <<= 1) {
+		++blockClass;
+	}
+	return blockClass;
+}
+}
+
+void* allocateFutureBlock(uint32 size)
+{
+	const uint32 blockClass = getBlockClass(size);
+	if(blockClass == BLOCK_CLASS_COUNT) {
+		return malloc(size);
+	}
+	{
+		ScopedLock lock(g_freeBlocksMutex);
+		FreeBlock* block = g_freeBlocks[blockClass];
+		if(block)
+		{
+			g_freeBlocks[blockClass] = block->next;
+			return block;
+		}
+	}
+	return malloc(SMALLEST_BLOCK_SIZE << blockClass);
+}
+
+void freeFutureBlock(void* block, uint32 size)
+{
+	const uint32 blockClass = getBlockClass(size);
+	if(blockClass == BLOCK_CLASS_COUNT)
+	{
+		free(block);
+		return;
+	}
+	FreeBlock* freeBlock = (FreeBlock*) block;
+	ScopedLock lock(g_freeBlocksMutex);
+	freeBlock->next = g_freeBlocks[blockClass];
+	g_freeBlocks[blockClass] = freeBlock;
+}
+
+// *** FutureStateBase ***
+FutureStateBase::FutureStateBase():_refCount(1), _status(STATUS_PENDING), _waiterCount(0), _continuations(0)
+{
+}
+
+void FutureStateBase::addRef()
+{
+	atomicFetchAdd(&_refCount, uint32(1));
+}
+
+void FutureStateBase::release()
+{
+	if(atomicFetchAdd(&_refCount, uint32(-1)) == 1) {
+		destroy();
+	}
+}
+
+bool FutureStateBase::isReady() const
+{
+	return atomicLoadAcquire(&_status) != STATUS_PENDING;
+}
+
+bool FutureStateBase::hasValue() const
+{
+	return atomicLoadAcquire(&_status) == STATUS_VALUE;
+}
+
+void FutureStateBase::wait()
+{
+	if(isReady()) {
+		return;
+	}
+	// waiting threads block on the status, so that a state does not own any OS object
+	atomicFetchAdd(&_waiterCount, uint32(1));
+	// pairs with the fence in complete: either we see the status or complete sees the waiter
+	atomicThreadFence();
+	while(!isReady()) {
+		futexWait(&_status, uint32(STATUS_PENDING));
+	}
+	atomicFetchAdd(&_waiterCount, uint32(-1));
+}
+
+bool FutureStateBase::wait(Time timeout)
+{
+	if(isReady()) {
+		return true;
+	}
+	Timer timer;
+	atomicFetchAdd(&_waiterCount, uint32(1));
+	atomicThreadFence();
+	// wake ups may be spurious: wait for the remaining time
+	Time remaining = timeout;
+	while(!isReady() && remaining > Time())
+	{
+		futexWait(&_status, uint32(STATUS_PENDING), remaining);
+		remaining = timeout - timer.getElapsedTime();
+	}
+	atomicFetchAdd(&_waiterCount, uint32(-1));
+	return isReady();
+}
+
+void FutureStateBase::addContinuation(FutureContinuation* continuation)
+{
+	FutureContinuation* head = atomicLoadAcquire(&_continuations);
+	for(;;)
+	{
+		if(head == CLOSED_LIST)
+		{
+			continuation->run(*this);
+			return;
+		}
+		continuation->_next = head;
+		if(atomicCompareExchange(&_continuations, head, continuation)) {
+			return;
+		}
+	}
+}
+
+void FutureStateBase::complete(bool hasValue)
+{
+	atomicStoreRelease(&_status, uint32(hasValue ? STATUS_VALUE : STATUS_BROKEN));
+	atomicThreadFence();
+	if(atomicLoadAcquire(&_waiterCount) > 0) {
+		futexWakeAll(&_status);
+	}
+
+	// close the list, then run the continuations in registration order
+	FutureContinuation* head = atomicLoadAcquire(&_continuations);
+	while(!atomicCompareExchange(&_continuations, head, CLOSED_LIST)) {}
+	FutureContinuation* ordered = 0;
+	while(head)
+	{
+		FutureContinuation* next = head->_next;
+		head->_next = ordered;
+		ordered = head;
+		head = next;
+	}
+	while(ordered)
+	{
+		FutureContinuation* next = ordered->_next;
+		ordered->run(*this);
+		ordered = next;
+	}
+}
+
+// *** when_all / when_any ***
+class WhenAllShared
+{
+public:
+	WhenAllShared(FutureState<uint32>* result, uint32 count):result(result), remainingCount(count), valueCount(0) {}
+
+	/// called by each attached state once ready
+	void onReady(bool hasValue)
+	{
+		if(hasValue) {
+			atomicFetchAdd(&valueCount, uint32(1));
+		}
+		if(atomicFetchAdd(&remainingCount, uint32(-1)) == 1)
+		{
+			result->setValue(atomicLoadAcquire(&valueCount));
+			result->release();
+			this->~WhenAllShared();
+			freeFutureBlock(this, sizeof(WhenAllShared));
+		}
+	}
+
+private:
+	FutureState<uint32>* result;
+	volatile uint32 remainingCount; ///< states not ready yet
+	volatile uint32 valueCount;     ///< ready states having a value
+};
+
+class WhenAnyShared
+{
+public:
+	WhenAnyShared(FutureState<uint32>* result, uint32 count):result(result), remainingCount(count), isDone(0) {}
+
+	void onReady(uint32 index)
+	{
+		uint32 expected = 0;
+		if(atomicCompareExchange(&isDone, expected, uint32(1))) {
+			result->setValue(index);
+		}
+		if(atomicFetchAdd(&remainingCount, uint32(-1)) == 1)
+		{
+			result->release();
+			this->~WhenAnyShared();
+			freeFutureBlock(this, sizeof(WhenAnyShared));
+		}
+	}
+
+private:
+	FutureState<uint32>* result;
+	volatile uint32 remainingCount; ///< states not ready yet, the last one frees the shared data
+	volatile uint32 isDone;         ///< set by the first ready state
+};
+
+namespace
+{
+class WhenAllContinuation : public FutureContinuation
+{
+public:
+	explicit WhenAllContinuation(WhenAllShared* shared):_shared(shared) {}
+	virtual void run(FutureStateBase& state)
+	{
+		WhenAllShared* shared = _shared;
+		this->~WhenAllContinuation();
+		freeFutureBlock(this, sizeof(WhenAllContinuation));
+		shared->onReady(state.hasValue());
+	}
+private:
+	WhenAllShared* _shared;
+};
+
+class WhenAnyContinuation : public FutureContinuation
+{
+public:
+	WhenAnyContinuation(WhenAnyShared* shared, uint32 index):_shared(shared), _index(index) {}
+	virtual void run(FutureStateBase&)
+	{
+		WhenAnyShared* shared = _shared;
+		const uint32 index = _index;
+		this->~WhenAnyContinuation();
+		freeFutureBlock(this, sizeof(WhenAnyContinuation));
+		shared->onReady(index);
+	}
+private:
+	WhenAnyShared* _shared;
+	uint32 _index;
+};
+}
+
+WhenAllShared* createWhenAll(FutureState<uint32>* result, uint32 count)
+{
+	if(count == 0)
+	{
+		result->setValue(0);
+		result->release();
+		return 0;
+	}
+	return new (allocateFutureBlock(sizeof(WhenAllShared))) WhenAllShared(result, count);
+}
+
+void attachWhenAll(WhenAllShared* shared, FutureStateBase* state)
+{
+	state->addContinuation(new (allocateFutureBlock(sizeof(WhenAllContinuation))) WhenAllContinuation(shared));
+}
+
+WhenAnyShared* createWhenAny(FutureState<uint32>* result, uint32 count)
+{
+	return new (allocateFutureBlock(sizeof(WhenAnyShared))) WhenAnyShared(result, count);
+}
+
+void attachWhenAny(WhenAnyShared* shared, FutureStateBase* state, uint32 index)
+{
+	state->addContinuation(new (allocateFutureBlock(sizeof(WhenAnyContinuation))) WhenAnyContinuation(shared, index));
+}
+
+} // namespace priv
+} // namespace df
@@ -0,0 +1,64 @@
+#include <df/system/Latch.h>
+#include <df/system/Futex.h>
+#include <df/system/Timer.h>
+#include <cassert>
+
+namespace df
+{
+
+// *** Latch ***
+void Latch::countDown(uint32 count)
+{
+	const uint32 previous = priv::atomicFetchAdd(&_count, uint32(0) - count);
+	assert(previous >= count && "Latch counted down below 0");
+	if(previous == count) {
+		priv::futexWakeAll(&_count);
+	}
+}
+
+void Latch::wait()
+{
+	for(uint32 count = priv::atomicLoadAcquire(&_count); count != 0; count = priv::atomicLoadAcquire(&_count)) {
+		priv::futexWait(&_count, count);
+	}
+}
+
+bool Latch::wait(Time timeout)
+{
+	Timer timer;
+	for(uint32 count = priv::atomicLoadAcquire(&_count); count != 0; count = priv::atomicLoadAcquire(&_count))
+	{
+		const Time remaining = timeout - timer.getElapsedTime();
+		if(remaining <= Time()) {
+			return false;
+		}
+		priv::futexWait(&_count, count, remaining);
+	}
+	return true;
+}
+
+void Latch::arriveAndWait(uint32 count)
+{
+	countDown(count);
+	wait();
+}
+
+// *** Barrier ***
+bool Barrier::arriveAndWait()
+{
+	const uint32 phase = priv::atomicLoadAcquire(&_phase);
+	if(priv::atomicFetchAdd(&_remaining, uint32(-1)) == 1)
+	{
+		// nobody can arrive for the next phase before it starts: reset, then release the waiters
+		priv::atomicStoreRelaxed(&_remaining, _threadCount);
+		priv::atomicFetchAdd(&_phase, uint32(1));
+		priv::futexWakeAll(&_phase);
+		return true;
+	}
+	while(priv::atomicLoadAcquire(&_phase) == phase) {
+		priv::futexWait(&_phase, phase);
+	}
+	return false;
+}
+
+} // namespace df
@@ -0,0 +1,338 @@
+#include <df/system/LatencyHistogram.h>
+#include <df/system/Atomic.h>
+#include <df/system/Array.h>
+#include <df/system/BitOps.h>
+#include <df/system/Mutex.h>
+#include <df/system/ThreadLocal.h>
+
+namespace df
+{
+
+namespace
+{
+// values below SUB_BUCKET_COUNT have a bucket each, then each power of two [2^e, 2^(e+1)) is
+// split in SUB_BUCKET_COUNT buckets of 2^(e - SUB_BUCKET_BITS) values
+const uint32 SUB_BUCKET_BITS = 7;
+const uint32 SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+const uint32 VALUE_BITS = 45; ///< values are below 2^45 ns, about 9.7 hours
+const uint32 BUCKET_COUNT = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+const uint64 HIGHEST_VALUE = (uint64(1) << VALUE_BITS) - 1;
+const uint64 NO_MIN = ~uint64(0);
+
+inline uint32 getBucketIndex(uint64 value)
+{
+	if(value < SUB_BUCKET_COUNT) {
+		return uint32(value);
+	}
+	const uint32 exponent = 63 - countLeadingZeros(value);
+	const uint32 shift = exponent - SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKET_COUNT + uint32(value >> shift) - SUB_BUCKET_COUNT;
+}
+
+/// highest value counted in a bucket
+inline uint64 getBucketHighestValue(uint32 index)
+{
+	if(index < SUB_BUCKET_COUNT) {
+		return index;
+	}
+	const uint32 shift = index / SUB_BUCKET_COUNT - 1;
+	const uint64 lowest = uint64(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+	return lowest + (uint64(1) << shift) - 1;
+}
+
+/// increment a counter only written by one thread at a time: no read-modify-write needed
+inline void add(Atomic<uint64>& counter, uint64 value)
+{
+	counter.store(counter.load(MEMORY_ORDER_RELAXED) + value, MEMORY_ORDER_RELAXED);
+}
+
+/// buckets of the samples recorded by a thread
+struct Shard : NonCopyable
+{
+	Shard():min(NO_MIN) {}
+
+	void reset()
+	{
+		for(uint32 i = 0; i < BUCKET_COUNT; ++i) {
+			counts[i].store(0, MEMORY_ORDER_RELAXED);
+		}
+		count.store(0, MEMORY_ORDER_RELAXED);
+		sum.store(0, MEMORY_ORDER_RELAXED);
+		min.store(NO_MIN, MEMORY_ORDER_RELAXED);
+		max.store(0, MEMORY_ORDER_RELAXED);
+	}
+
+	Atomic<uint64> count;
+	Atomic<uint64> sum; ///< in nanoseconds
+	Atomic<uint64> min;
+	Atomic<uint64> max;
+	Atomic<uint64> counts[BUCKET_COUNT];
+};
+
+/// merged content of the shards
+struct Snapshot
+{
+	Snapshot():count(0), sum(0), min(NO_MIN), max(0) { counts.resize(BUCKET_COUNT, 0); }
+
+	void add(const Shard& shard)
+	{
+		const uint64 shardCount = shard.count.load(MEMORY_ORDER_RELAXED);
+		if(shardCount == 0) {
+			return;
+		}
+		count += shardCount;
+		sum += shard.sum.load(MEMORY_ORDER_RELAXED);
+		const uint64 shardMin = shard.min.load(MEMORY_ORDER_RELAXED);
+		const uint64 shardMax = shard.max.load(MEMORY_ORDER_RELAXED);
+		min = (shardMin < min) ? shardMin : min;
+		max = (shardMax > max) ? shardMax : max;
+		for(uint32 i = 0; i < BUCKET_COUNT; ++i) {
+			counts[i] += shard.counts[i].load(MEMORY_ORDER_RELAXED);
+		}
+	}
+
+	/// highest value of the bucket holding the sample of rank count * percentile / 100 (rounded)
+	uint64 getPercentile(double percentile) const
+	{
+		if(count == 0) {
+			return 0;
+		}
+		percentile = (percentile < 0.0) ? 0.0 : ((percentile > 100.0) ? 100.0 : percentile);
+		uint64 rank = uint64(double(count) * percentile / 100.0 + 0.5);
+		rank = (rank == 0) ? 1 : ((rank > count) ? count : rank);
+		uint64 cumulatedCount = 0;
+		for(uint32 i = 0; i < BUCKET_COUNT; ++i)
+		{
+			cumulatedCount += counts[i];
+			if(cumulatedCount >= rank)
+			{
+				// the exact extremes are known
+				const uint64 value = getBucketHighestValue(i);
+				return (value > max) ? max : ((value < min) ? min : value);
+			}
+		}
+		return max;
+	}
+
+	uint64 count;
+	uint64 sum;
+	uint64 min;
+	uint64 max;
+	Array<uint64, 8> counts;
+};
+}
+
+class LatencyHistogram::PrivateData
+{
+public:
+	/// shard of a thread, allocated by its first record
+	struct ShardHandle
+	{
+		explicit ShardHandle(PrivateData* histogram):histogram(histogram), shard(NULL) {}
+		/// ThreadLocal creates the handle of each thread as a copy of an initial handle
+		ShardHandle(const ShardHandle& other):histogram(other.histogram), shard(NULL) {}
+		/// at thread exit, keep the samples in the histogram
+		~ShardHandle()
+		{
+			if(shard)
+			{
+				histogram->adoptShard(*shard);
+				delete shard;
+			}
+		}
+
+		PrivateData* histogram;
+		Shard* shard;
+	private:
+		ShardHandle& operator=(const ShardHandle&);
+	};
+
+	struct AddShard
+	{
+		explicit AddShard(Snapshot& snapshot):snapshot(&snapshot) {}
+		void operator()(ShardHandle& handle)
+		{
+			if(handle.shard) {
+				snapshot->add(*handle.shard);
+			}
+		}
+		Snapshot* snapshot;
+	};
+
+	struct ResetShard
+	{
+		void operator()(ShardHandle& handle)
+		{
+			if(handle.shard) {
+				handle.shard->reset();
+			}
+		}
+	};
+
+	PrivateData():mutex("df::LatencyHistogram"), shards(NULL)
+	{
+		shards = new ThreadLocal<ShardHandle>(ShardHandle(this));
+	}
+	~PrivateData()
+	{
+		// merges the remaining shards in adopted before it is destroyed
+		delete shards;
+	}
+
+	/// add the samples of a snapshot or of an exited thread to adopted
+	void adopt(const Snapshot& snapshot)
+	{
+		if(snapshot.count == 0) {
+			return;
+		}
+		ScopedLock lock(mutex);
+		add(adopted.count, snapshot.count);
+		add(adopted.sum, snapshot.sum);
+		if(snapshot.min < adopted.min.load(MEMORY_ORDER_RELAXED)) {
+			adopted.min.store(snapshot.min, MEMORY_ORDER_RELAXED);
+		}
+		if(snapshot.max > adopted.max.load(MEMORY_ORDER_RELAXED)) {
+			adopted.max.store(snapshot.max, MEMORY_ORDER_RELAXED);
+		}
+		for(uint32 i = 0; i < BUCKET_COUNT; ++i) {
+			add(adopted.counts[i], snapshot.counts[i]);
+		}
+	}
+
+	void adoptShard(const Shard& shard)
+	{
+		Snapshot snapshot;
+		snapshot.add(shard);
+		adopt(snapshot);
+	}
+
+	Snapshot takeSnapshot() const
+	{
+		Snapshot snapshot;
+		{
+			ScopedLock lock(mutex);
+			snapshot.add(adopted);
+		}
+		shards->forEach(AddShard(snapshot));
+		return snapshot;
+	}
+
+	Shard& getShard()
+	{
+		ShardHandle& handle = shards->get();
+		if(!handle.shard) {
+			handle.shard = new Shard();
+		}
+		return *handle.shard;
+	}
+
+	mutable Mutex mutex;
+	Shard adopted;                   ///< samples merged from other histograms and exited threads, protected by mutex
+	ThreadLocal<ShardHandle>* shards;
+};
+
+LatencyHistogram::LatencyHistogram()
+{
+	_data = new PrivateData();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+	delete _data;
+}
+
+void LatencyHistogram::record(Time latency, uint64 count)
+{
+	const int64 nanoseconds = latency.asNanoseconds();
+	const uint64 value = (nanoseconds <= 0) ? 0 : ((uint64(nanoseconds) > HIGHEST_VALUE) ? HIGHEST_VALUE : uint64(nanoseconds));
+	Shard& shard = _data->getShard();
+	add(shard.counts[getBucketIndex(value)], count);
+	add(shard.count, count);
+	add(shard.sum, value * count);
+	if(value < shard.min.load(MEMORY_ORDER_RELAXED)) {
+		shard.min.store(value, MEMORY_ORDER_RELAXED);
+	}
+	if(value > shard.max.load(MEMORY_ORDER_RELAXED)) {
+		shard.max.store(value, MEMORY_ORDER_RELAXED);
+	}
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	if(&other != this) {
+		_data->adopt(other._data->takeSnapshot());
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	{
+		ScopedLock lock(_data->mutex);
+		_data->adopted.reset();
+	}
+	_data->shards->forEach(PrivateData::ResetShard());
+}
+
+uint64 LatencyHistogram::getCount() const
+{
+	return _data->takeSnapshot().count;
+}
+
+Time LatencyHistogram::getMin() const
+{
+	const Snapshot snapshot = _data->takeSnapshot();
+	return nanoseconds(snapshot.count ? int64(snapshot.min) : 0);
+}
+
+Time LatencyHistogram::getMax() const
+{
+	return nanoseconds(int64(_data->takeSnapshot().max));
+}
+
+Time LatencyHistogram::getMean() const
+{
+	const Snapshot snapshot = _data->takeSnapshot();
+	return nanoseconds(snapshot.count ? int64(snapshot.sum / snapshot.count) : 0);
+}
+
+Time LatencyHistogram::getPercentile(double percentile) const
+{
+	return nanoseconds(int64(_data->takeSnapshot().getPercentile(percentile)));
+}
+
+void LatencyHistogram::writeText(FILE* file) const
+{
+	const Snapshot snapshot = _data->takeSnapshot();
+	const double MICROSECOND = 1000.0;
+	fprintf(file, "count %llu, min %.3f us, mean %.3f us, max %.3f us\n", (unsigned long long) snapshot.count,
+		(snapshot.count ? snapshot.min : 0) / MICROSECOND, (snapshot.count ? snapshot.sum / snapshot.count : 0) / MICROSECOND,
+		snapshot.max / MICROSECOND);
+	fprintf(file, "p50 %.3f us, p90 %.3f us, p99 %.3f us, p99.9 %.3f us, p99.99 %.3f us\n",
+		snapshot.getPercentile(50.0) / MICROSECOND, snapshot.getPercentile(90.0) / MICROSECOND,
+		snapshot.getPercentile(99.0) / MICROSECOND, snapshot.getPercentile(99.9) / MICROSECOND,
+		snapshot.getPercentile(99.99) / MICROSECOND);
+}
+
+void LatencyHistogram::writeCsv(FILE* file) const
+{
+	const Snapshot snapshot = _data->takeSnapshot();
+	fprintf(file, "latency_ns,count,percentile\n");
+	uint64 cumulatedCount = 0;
+	for(uint32 i = 0; i < BUCKET_COUNT; ++i)
+	{
+		if(snapshot.counts[i] == 0) {
+			continue;
+		}
+		cumulatedCount += snapshot.counts[i];
+		const uint64 value = getBucketHighestValue(i);
+		fprintf(file, "%llu,%llu,%.6f\n", (unsigned long long) ((value > snapshot.max) ? snapshot.max : value),
+			(unsigned long long) snapshot.counts[i], 100.0 * double(cumulatedCount) / double(snapshot.count));
+	}
+}
+
+Time LatencyHistogram::getHighestTrackableValue()
+{
+	return nanoseconds(int64(HIGHEST_VALUE));
+}
+
+} // namespace df
@@ -0,0 +1,141 @@
+#include <df/system/LockProfiling.h>
+#include <df/system/FastMutex.h>
+#include <string.h>
+#include <stdlib.h>
+
+namespace df
+{
+
+namespace
+{
+// The registry uses a FastMutex: a profiled Mutex would register itself.
+FastMutex& getRegistryMutex()
+{
+	static FastMutex mutex;
+	return mutex;
+}
+priv::LockRecord* g_firstRecord = NULL; ///< protected by the registry mutex
+
+void copyStatistics(const priv::LockRecord& record, LockStatistics& statistics)
+{
+	memcpy(statistics.name, record.name, sizeof(statistics.name));
+	statistics.lock = record.lock;
+	statistics.acquisitionCount = record.acquisitionCount.load(MEMORY_ORDER_RELAXED);
+	statistics.contentionCount = record.contentionCount.load(MEMORY_ORDER_RELAXED);
+	statistics.totalWaitTime = nanoseconds(record.totalWaitTime.load(MEMORY_ORDER_RELAXED));
+	statistics.maxWaitTime = nanoseconds(record.maxWaitTime.load(MEMORY_ORDER_RELAXED));
+	statistics.holderThreadID = record.holderThreadID.load(MEMORY_ORDER_RELAXED);
+}
+
+int compareTotalWaitTime(const void* left, const void* right)
+{
+	const Time leftTime = ((const LockStatistics*) left)->totalWaitTime;
+	const Time rightTime = ((const LockStatistics*) right)->totalWaitTime;
+	return (leftTime > rightTime) ? -1 : ((leftTime < rightTime) ? 1 : 0);
+}
+}
+
+namespace lock_profiling
+{
+bool isEnabled()
+{
+#if defined(DF_MUTEX_PROFILING)
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint32 getStatistics(LockStatistics* statistics, uint32 maxCount)
+{
+	ScopedLock lock(getRegistryMutex());
+	uint32 count = 0;
+	for(priv::LockRecord* record = g_firstRecord; record; record = record->next)
+	{
+		if(count < maxCount) {
+			copyStatistics(*record, statistics[count]);
+		}
+		++count;
+	}
+	return count;
+}
+
+void reset()
+{
+	ScopedLock lock(getRegistryMutex());
+	for(priv::LockRecord* record = g_firstRecord; record; record = record->next)
+	{
+		record->acquisitionCount.store(0, MEMORY_ORDER_RELAXED);
+		record->contentionCount.store(0, MEMORY_ORDER_RELAXED);
+		record->totalWaitTime.store(0, MEMORY_ORDER_RELAXED);
+		record->maxWaitTime.store(0, MEMORY_ORDER_RELAXED);
+	}
+}
+
+void dump(FILE* file)
+{
+	if(!isEnabled())
+	{
+		fprintf(file, "lock profiling is disabled (build without DF_MUTEX_PROFILING)\n");
+		return;
+	}
+	// the registry may grow between the two calls, the extra mutexes are left out
+	const uint32 count = getStatistics(NULL, 0);
+	LockStatistics* statistics = new LockStatistics[count > 0 ? count : 1];
+	const uint32 copiedCount = getStatistics(statistics, count);
+	const uint32 listedCount = (copiedCount < count) ? copiedCount : count;
+	qsort(statistics, listedCount, sizeof(LockStatistics), &compareTotalWaitTime);
+
+	fprintf(file, "%-32s %18s %12s %10s %14s %12s %8s\n", "mutex", "address", "acquisitions", "contended", "total wait ms", "max wait us", "holder");
+	for(uint32 i = 0; i < listedCount; ++i)
+	{
+		const LockStatistics& lock = statistics[i];
+		if(lock.acquisitionCount == 0) {
+			continue;
+		}
+		fprintf(file, "%-32s %18p %12llu %10llu %14.3f %12lld %8u\n", lock.name[0] ? lock.name : "<unnamed>", lock.lock,
+			(unsigned long long) lock.acquisitionCount, (unsigned long long) lock.contentionCount,
+			lock.totalWaitTime.asNanoseconds() / 1000000.0, (long long) lock.maxWaitTime.asMicroseconds(), lock.holderThreadID);
+	}
+	delete [] statistics;
+}
+}
+
+namespace priv
+{
+LockRecord* registerLock(const void* lock, const char* name)
+{
+	LockRecord* record = new LockRecord();
+	record->lock = lock;
+	if(name)
+	{
+		strncpy(record->name, name, sizeof(record->name) - 1);
+		record->name[sizeof(record->name) - 1] = 0;
+	}
+	ScopedLock registryLock(getRegistryMutex());
+	record->next = g_firstRecord;
+	if(g_firstRecord) {
+		g_firstRecord->previous = record;
+	}
+	g_firstRecord = record;
+	return record;
+}
+
+void unregisterLock(LockRecord* record)
+{
+	{
+		ScopedLock lock(getRegistryMutex());
+		if(record->previous) {
+			record->previous->next = record->next;
+		} else {
+			g_firstRecord = record->next;
+		}
+		if(record->next) {
+			record->next->previous = record->previous;
+		}
+	}
+	delete record;
+}
+}
+
+} // namespace df
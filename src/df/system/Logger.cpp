@@ -1,6 +1,7 @@
 #include <df/system/Logger.h>
 #include <df/system/Mutex.h>
 #include <df/system/Thread.h>
+#include <df/system/ThreadLocal.h>
 #include <cstring>
 #include <cassert>
 #include <ctime>
@@ -10,30 +11,20 @@
 #ifdef DF_PLATFORM_WIN
 #include <direct.h>
 #define snprintf _snprintf
-#endif
-
-//TODO use a generic thread local storage implementation instead of this
-// Or at least a smarter lock strategy than the global lock :(
-#if !defined(_TTHREAD_CPP0X_) && !defined(thread_local)
-	#if defined(__GNUC__) || defined(__INTEL_COMPILER) || defined(__SUNPRO_CC) || defined(__IBMCPP__)
-		#define thread_local __thread
-		#define LOGGER_THREAD_LOCAL
-	#else
-		#define thread_local __declspec(thread)
-		#define LOGGER_THREAD_LOCAL
-	#endif
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
 #endif
 
 namespace df {
 
 const size_t MAX_LOG_BUFFER_SIZE = 4096;
 
-#ifdef LOGGER_THREAD_LOCAL
-	thread_local static char g_log_buffer[MAX_LOG_BUFFER_SIZE];
-#else 
-	static char g_log_buffer[MAX_LOG_BUFFER_SIZE];
-#endif
-
+/// formatting buffer, one per thread and per logger
+struct LogBuffer
+{
+	char data[MAX_LOG_BUFFER_SIZE];
+};
 
 class Logger::PrivateData
 {	
@@ -57,9 +48,7 @@ public:
 	char filePrefix[64];	
 	FILE * pFile;
 
-#ifndef LOGGER_THREAD_LOCAL
-	Mutex bufferMutex;
-#endif
+	ThreadLocal<LogBuffer> buffers;
 		
 	//trick to avoid implementing two log functions with variadic arguments and a single arg as difference
 	void logWithPrefix(Logger::LogLevel level, const char* prefix,  const char* format, va_list args);
@@ -108,10 +97,7 @@ void Logger::setMinLogLevel(LogLevel level)
 
 bool Logger::init()
 {
-#ifndef LOGGER_THREAD_LOCAL
-	ScopedLock(_data->bufferMutex);
-#endif
-	char* bufferPtr = g_log_buffer;
+	char* bufferPtr = _data->buffers->data;
 
 	memset(bufferPtr,'*',MAX_LOG_BUFFER_SIZE);	
 	bufferPtr[MAX_LOG_BUFFER_SIZE-1] = '\0';	
@@ -200,17 +186,11 @@ void Logger::logWithPrefix(LogLevel level, const char* prefix,  const char* form
 
 void Logger::PrivateData::logWithPrefix(Logger::LogLevel level, const char* prefix,  const char* format, va_list args)
 {
-#ifndef LOGGER_THREAD_LOCAL
-	ScopedLock bufferLock(bufferMutex);
-#endif
-
 	// lock-free logging implementation (except locking inside std::ofstream)
 	if (level > minLogLevel || !isInitialized)
 		return;
 
-	// *** allocate thread-local buffer here if we use a templated implementation***
-	// ...
-	char* start_buf = g_log_buffer;
+	char* start_buf = buffers->data;
 	char* cur_buf = start_buf;
 	
 	int remainingSize = MAX_LOG_BUFFER_SIZE-2; // two bytes are kept for trailing \n\0
@@ -242,7 +222,8 @@ void Logger::PrivateData::logWithPrefix(Logger::LogLevel level, const char* pref
 
 	//append user message	
 	int vsnWritten = vsnprintf(cur_buf, remainingSize, format, args);
-	if (vsnWritten != -1)
+	// a truncated message gives -1 (msvc) or the untruncated size (C99)
+	if (vsnWritten >= 0 && vsnWritten < remainingSize)
 	{
 		cur_buf += vsnWritten;
 		remainingSize -= vsnWritten;
@@ -0,0 +1,73 @@
+#include <df/system/MappedFile.h>
+
+#if defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/MappedFileImpl.h>
+#else
+    #include <df/system/posix/MappedFileImpl.h>
+#endif
+
+
+namespace df
+{
+MappedFile::MappedFile():_mappedFileImpl(0), _mode(MAP_READ_ONLY)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const char* path, MapMode mode)
+{
+	close();
+	_mappedFileImpl = new priv::MappedFileImpl;
+	if(!_mappedFileImpl->open(path, mode == MAP_READ_WRITE))
+	{
+		close();
+		return false;
+	}
+	_mode = mode;
+	return true;
+}
+
+void MappedFile::close()
+{
+	delete _mappedFileImpl;
+	_mappedFileImpl = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+	return _mappedFileImpl != 0;
+}
+
+MappedFile::MapMode MappedFile::getMode() const
+{
+	return _mode;
+}
+
+void* MappedFile::getData() const
+{
+	return _mappedFileImpl ? _mappedFileImpl->getData() : 0;
+}
+
+uint64 MappedFile::getSize() const
+{
+	return _mappedFileImpl ? _mappedFileImpl->getSize() : 0;
+}
+
+bool MappedFile::resize(uint64 size)
+{
+	if(!_mappedFileImpl || _mode != MAP_READ_WRITE) {
+		return false;
+	}
+	return _mappedFileImpl->resize(size);
+}
+
+bool MappedFile::flush()
+{
+	return _mappedFileImpl ? _mappedFileImpl->flush() : false;
+}
+
+} // namespace df
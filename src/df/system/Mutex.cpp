@@ -1,4 +1,9 @@
 #include <df/system/Mutex.h>
+#if defined(DF_MUTEX_PROFILING)
+    #include <df/system/LockProfiling.h>
+    #include <df/system/Thread.h>
+    #include <df/system/Timer.h>
+#endif
 
 #if defined(DF_PLATFORM_WIN)
     #include <df/system/win32/MutexImpl.h>
@@ -9,29 +14,121 @@
 
 namespace df
 {
+#if defined(DF_MUTEX_PROFILING)
+namespace
+{
+// The statistics of a mutex are only written by the thread holding it: relaxed stores are enough.
+const uint32 ID_PENDING = 0xFFFFFFFF;
+DF_THREAD_LOCAL uint32 t_threadID = 0;
+
+/// this_thread::getID() of the calling thread, cached
+/// getID may lock a Mutex (posix), whose profiling asks for the ID again: it gets 0 meanwhile.
+uint32 getCachedThreadID()
+{
+    uint32 id = t_threadID;
+    if(id == 0)
+    {
+        t_threadID = ID_PENDING;
+        id = this_thread::getID();
+        t_threadID = id;
+    }
+    return (id == ID_PENDING) ? 0 : id;
+}
+
+inline void increment(Atomic<uint64>& counter)
+{
+    counter.store(counter.load(MEMORY_ORDER_RELAXED) + 1, MEMORY_ORDER_RELAXED);
+}
+
+inline void onLockAcquired(priv::LockRecord* record)
+{
+    increment(record->acquisitionCount);
+    if(record->depth++ == 0) {
+        record->holderThreadID.store(getCachedThreadID(), MEMORY_ORDER_RELAXED);
+    }
+}
+
+void onLockContended(priv::LockRecord* record, Time waitTime)
+{
+    const int64 wait = waitTime.asNanoseconds();
+    increment(record->contentionCount);
+    record->totalWaitTime.store(record->totalWaitTime.load(MEMORY_ORDER_RELAXED) + wait, MEMORY_ORDER_RELAXED);
+    if(wait > record->maxWaitTime.load(MEMORY_ORDER_RELAXED)) {
+        record->maxWaitTime.store(wait, MEMORY_ORDER_RELAXED);
+    }
+    onLockAcquired(record);
+}
+
+inline void onLockReleased(priv::LockRecord* record)
+{
+    if(--record->depth == 0) {
+        record->holderThreadID.store(0, MEMORY_ORDER_RELAXED);
+    }
+}
+}
+#endif
+
 Mutex::Mutex()
 {
     _mutexImpl = new priv::MutexImpl;
+#if defined(DF_MUTEX_PROFILING)
+    _lockRecord = priv::registerLock(this, NULL);
+#endif
+}
+
+Mutex::Mutex(const char* name)
+{
+    _mutexImpl = new priv::MutexImpl;
+#if defined(DF_MUTEX_PROFILING)
+    _lockRecord = priv::registerLock(this, name);
+#else
+    (void) name;
+#endif
 }
 
 Mutex::~Mutex()
 {
+#if defined(DF_MUTEX_PROFILING)
+    priv::unregisterLock(_lockRecord);
+#endif
     delete _mutexImpl;
 }
 
 void Mutex::lock()
 {
+#if defined(DF_MUTEX_PROFILING)
+    if(_mutexImpl->tryLock())
+    {
+        onLockAcquired(_lockRecord);
+        return;
+    }
+    Timer timer;
+    _mutexImpl->lock();
+    onLockContended(_lockRecord, timer.getElapsedTime());
+#else
     _mutexImpl->lock();
+#endif
 }
 
 void Mutex::unlock()
 {
+#if defined(DF_MUTEX_PROFILING)
+    onLockReleased(_lockRecord);
+#endif
     _mutexImpl->unlock();
 }
 
 bool Mutex::tryLock()
 {
+#if defined(DF_MUTEX_PROFILING)
+    if(!_mutexImpl->tryLock()) {
+        return false;
+    }
+    onLockAcquired(_lockRecord);
+    return true;
+#else
     return _mutexImpl->tryLock();
+#endif
 }
 
 } // namespace df
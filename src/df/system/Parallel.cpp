@@ -0,0 +1,82 @@
+#include <df/system/Parallel.h>
+#include <df/system/AtomicOps.h>
+
+namespace df
+{
+namespace priv
+{
+
+namespace
+{
+/// shared state of a parallelRun call, lives on the stack of the calling thread
+struct ParallelJob
+{
+	RangeTask* task;
+	uint32 count;
+	uint32 grainSize;
+	uint32 chunkCount;
+	volatile uint32 nextChunk; ///< next chunk to process
+};
+
+void processChunks(ParallelJob* job)
+{
+	for(;;)
+	{
+		const uint32 chunk = atomicFetchAdd(&job->nextChunk, uint32(1));
+		if(chunk >= job->chunkCount) {
+			return;
+		}
+		const uint32 begin = chunk * job->grainSize;
+		const uint32 end = (job->count - begin > job->grainSize) ? begin + job->grainSize : job->count;
+		job->task->run(begin, end);
+	}
+}
+
+void helperEntryPoint(void* userData)
+{
+	processChunks((ParallelJob*) userData);
+}
+}
+
+uint32 parallelGrainSize(const ThreadPool& pool, uint32 count, uint32 grainSize)
+{
+	if(grainSize != 0) {
+		return grainSize;
+	}
+	// a few chunks per thread to balance uneven work
+	const uint32 chunkCount = (pool.getWorkerCount() + 1) * 4;
+	grainSize = (count + chunkCount - 1) / chunkCount;
+	return (grainSize > 0) ? grainSize : 1;
+}
+
+void parallelRun(ThreadPool& pool, RangeTask& task, uint32 count, uint32 grainSize)
+{
+	if(count == 0) {
+		return;
+	}
+
+	ParallelJob job;
+	job.task = &task;
+	job.count = count;
+	job.grainSize = parallelGrainSize(pool, count, grainSize);
+	job.chunkCount = (count + job.grainSize - 1) / job.grainSize;
+	job.nextChunk = 0;
+
+	// the calling thread processes chunks too, so there is no need for more helpers than remaining chunks
+	uint32 helperCount = job.chunkCount - 1;
+	if(helperCount > pool.getWorkerCount()) {
+		helperCount = pool.getWorkerCount();
+	}
+	TaskGroup helpers;
+	for(uint32 i = 0; i < helperCount; ++i) {
+		pool.submit(helpers, &helperEntryPoint, &job);
+	}
+
+	processChunks(&job);
+
+	// wait for the helpers still working on their last chunk (or not started yet)
+	pool.wait(helpers);
+}
+
+} // namespace priv
+} // namespace df
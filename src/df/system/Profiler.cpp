@@ -0,0 +1,286 @@
+#include <df/system/Profiler.h>
+#include <df/system/Atomic.h>
+#include <df/system/FastMutex.h>
+#include <df/system/ThreadLocal.h>
+#include <df/system/Thread.h>
+
+namespace df
+{
+
+namespace
+{
+struct Zone
+{
+	const char* name;
+	uint64 beginCycles;
+	uint64 endCycles;
+};
+
+/// zones of a thread are appended to a list of chunks, published by count
+struct Chunk
+{
+	static const uint32 CAPACITY = 1024;
+
+	Chunk():next(NULL) {}
+
+	Atomic<uint32> count;
+	Atomic<Chunk*> next;
+	Zone zones[CAPACITY];
+};
+
+/// zones recorded by a thread, only written by the thread
+struct ThreadBuffer
+{
+	ThreadBuffer():threadID(0), generation(0), first(NULL), last(NULL), next(NULL) {}
+	~ThreadBuffer()
+	{
+		while(first)
+		{
+			Chunk* chunk = first;
+			first = chunk->next.load(MEMORY_ORDER_RELAXED);
+			delete chunk;
+		}
+	}
+
+	uint32 threadID;
+	uint32 generation;       ///< the zones are dropped when it differs from the registry one
+	Atomic<uint32> isExited;
+	Chunk* first;
+	Chunk* last;             ///< chunk being filled
+	ThreadBuffer* next;      ///< in the registry
+};
+
+DF_THREAD_LOCAL ThreadBuffer* t_buffer = NULL;
+
+/// marks the buffer of a thread as exited when the thread exits
+struct ThreadExitNotifier
+{
+	ThreadExitNotifier():buffer(NULL) {}
+	/// ThreadLocal creates the notifier of each thread as a copy of an initial one
+	ThreadExitNotifier(const ThreadExitNotifier&):buffer(NULL) {}
+	~ThreadExitNotifier()
+	{
+		if(buffer)
+		{
+			t_buffer = NULL;
+			buffer->isExited.store(1, MEMORY_ORDER_RELEASE);
+		}
+	}
+
+	ThreadBuffer* buffer;
+private:
+	ThreadExitNotifier& operator=(const ThreadExitNotifier&);
+};
+
+/// buffers of all the threads, those of exited threads are kept until the next clear
+struct Registry
+{
+	// never destroyed: threads can still record zones and exit during the static destruction
+	Registry():first(NULL), exitNotifiers(new ThreadLocal<ThreadExitNotifier>()) {}
+
+	FastMutex mutex;
+	Atomic<uint32> generation;                    ///< incremented by clear
+	ThreadBuffer* first;                          ///< protected by mutex
+	ThreadLocal<ThreadExitNotifier>* exitNotifiers;
+};
+
+Registry& getRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+/// buffer of the calling thread, created or emptied for the current generation
+ThreadBuffer* prepareBuffer()
+{
+	Registry& registry = getRegistry();
+	ScopedLock lock(registry.mutex);
+	ThreadBuffer* buffer = t_buffer;
+	if(!buffer)
+	{
+		buffer = new ThreadBuffer();
+		buffer->threadID = this_thread::getID();
+		buffer->first = buffer->last = new Chunk();
+		buffer->next = registry.first;
+		registry.first = buffer;
+		registry.exitNotifiers->get().buffer = buffer;
+		t_buffer = buffer;
+	}
+	else
+	{
+		// cleared: reuse the chunks
+		for(Chunk* chunk = buffer->first; chunk; chunk = chunk->next.load(MEMORY_ORDER_RELAXED)) {
+			chunk->count.store(0, MEMORY_ORDER_RELAXED);
+		}
+		buffer->last = buffer->first;
+	}
+	buffer->generation = registry.generation.load(MEMORY_ORDER_RELAXED);
+	return buffer;
+}
+
+/// write text as a JSON string
+void writeJsonString(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for(const char* c = text; *c; ++c)
+	{
+		if(*c == '"' || *c == '\\') {
+			fprintf(file, "\\%c", *c);
+		} else if((unsigned char) *c < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned) (unsigned char) *c);
+		} else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+}
+
+namespace priv
+{
+void recordProfileZone(const char* name, uint64 beginCycles, uint64 endCycles)
+{
+	ThreadBuffer* buffer = t_buffer;
+	if(!buffer || buffer->generation != getRegistry().generation.load(MEMORY_ORDER_RELAXED)) {
+		buffer = prepareBuffer();
+	}
+
+	Chunk* chunk = buffer->last;
+	uint32 count = chunk->count.load(MEMORY_ORDER_RELAXED);
+	if(count == Chunk::CAPACITY)
+	{
+		Chunk* next = chunk->next.load(MEMORY_ORDER_RELAXED);
+		if(!next)
+		{
+			next = new Chunk();
+			chunk->next.store(next, MEMORY_ORDER_RELEASE);
+		}
+		buffer->last = chunk = next;
+		count = 0;
+	}
+	Zone& zone = chunk->zones[count];
+	zone.name = name;
+	zone.beginCycles = beginCycles;
+	zone.endCycles = endCycles;
+	// release: the exporter reads the zones below count
+	chunk->count.store(count + 1, MEMORY_ORDER_RELEASE);
+}
+}
+
+namespace profiler
+{
+bool isEnabled()
+{
+#if defined(DF_PROFILING)
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64 getZoneCount()
+{
+	Registry& registry = getRegistry();
+	ScopedLock lock(registry.mutex);
+	const uint32 generation = registry.generation.load(MEMORY_ORDER_RELAXED);
+	uint64 count = 0;
+	for(ThreadBuffer* buffer = registry.first; buffer; buffer = buffer->next)
+	{
+		if(buffer->generation != generation) {
+			continue;
+		}
+		for(Chunk* chunk = buffer->first; chunk; chunk = chunk->next.load(MEMORY_ORDER_ACQUIRE)) {
+			count += chunk->count.load(MEMORY_ORDER_ACQUIRE);
+		}
+	}
+	return count;
+}
+
+void clear()
+{
+	Registry& registry = getRegistry();
+	ScopedLock lock(registry.mutex);
+	// the live threads empty their buffer at their next zone
+	registry.generation.fetchAdd(1, MEMORY_ORDER_RELAXED);
+
+	ThreadBuffer** link = &registry.first;
+	while(*link)
+	{
+		ThreadBuffer* buffer = *link;
+		if(buffer->isExited.load(MEMORY_ORDER_ACQUIRE))
+		{
+			*link = buffer->next;
+			delete buffer;
+		}
+		else {
+			link = &buffer->next;
+		}
+	}
+}
+
+bool writeChromeTrace(FILE* file)
+{
+	Registry& registry = getRegistry();
+	ScopedLock lock(registry.mutex);
+	const uint32 generation = registry.generation.load(MEMORY_ORDER_RELAXED);
+
+	// timestamps relative to the earliest zone
+	bool isEmpty = true;
+	uint64 originCycles = 0;
+	for(ThreadBuffer* buffer = registry.first; buffer; buffer = buffer->next)
+	{
+		if(buffer->generation != generation) {
+			continue;
+		}
+		for(Chunk* chunk = buffer->first; chunk; chunk = chunk->next.load(MEMORY_ORDER_ACQUIRE))
+		{
+			const uint32 count = chunk->count.load(MEMORY_ORDER_ACQUIRE);
+			for(uint32 i = 0; i < count; ++i)
+			{
+				if(isEmpty || chunk->zones[i].beginCycles < originCycles) {
+					originCycles = chunk->zones[i].beginCycles;
+				}
+				isEmpty = false;
+			}
+		}
+	}
+
+	// complete events ("X"), in microseconds
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	bool isFirst = true;
+	for(ThreadBuffer* buffer = registry.first; buffer; buffer = buffer->next)
+	{
+		if(buffer->generation != generation) {
+			continue;
+		}
+		for(Chunk* chunk = buffer->first; chunk; chunk = chunk->next.load(MEMORY_ORDER_ACQUIRE))
+		{
+			const uint32 count = chunk->count.load(MEMORY_ORDER_ACQUIRE);
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const Zone& zone = chunk->zones[i];
+				fprintf(file, isFirst ? "\n{\"name\":" : ",\n{\"name\":");
+				writeJsonString(file, zone.name);
+				fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->threadID,
+					CycleTimer::toNanoseconds(zone.beginCycles - originCycles) / 1000.0,
+					CycleTimer::toNanoseconds(zone.endCycles - zone.beginCycles) / 1000.0);
+				isFirst = false;
+			}
+		}
+	}
+	fprintf(file, "\n]}\n");
+	return fflush(file) == 0 && !ferror(file);
+}
+
+bool writeChromeTrace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if(!file) {
+		return false;
+	}
+	const bool isWritten = writeChromeTrace(file);
+	return (fclose(file) == 0) && isWritten;
+}
+}
+
+} // namespace df
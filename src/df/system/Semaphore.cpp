@@ -0,0 +1,53 @@
+#include <df/system/Semaphore.h>
+#include <df/system/Futex.h>
+#include <df/system/Timer.h>
+
+namespace df
+{
+
+void Semaphore::waitContended()
+{
+	priv::atomicFetchAdd(&_waiterCount, uint32(1));
+	// the fetch add is a full barrier: post either sees the waiter or we see the new count
+	while(!tryWait()) {
+		priv::futexWait(&_count, 0);
+	}
+	priv::atomicFetchAdd(&_waiterCount, uint32(-1));
+}
+
+bool Semaphore::wait(Time timeout)
+{
+	if(tryWait()) {
+		return true;
+	}
+	Timer timer;
+	priv::atomicFetchAdd(&_waiterCount, uint32(1));
+	bool isAcquired = tryWait();
+	while(!isAcquired)
+	{
+		const Time remaining = timeout - timer.getElapsedTime();
+		if(remaining <= Time()) {
+			break;
+		}
+		priv::futexWait(&_count, 0, remaining);
+		isAcquired = tryWait();
+	}
+	priv::atomicFetchAdd(&_waiterCount, uint32(-1));
+	return isAcquired;
+}
+
+void Semaphore::post(uint32 count)
+{
+	priv::atomicFetchAdd(&_count, count);
+	priv::atomicThreadFence();
+	if(priv::atomicLoadAcquire(&_waiterCount) == 0) {
+		return;
+	}
+	if(count == 1) {
+		priv::futexWakeOne(&_count);
+	} else {
+		priv::futexWakeAll(&_count);
+	}
+}
+
+} // namespace df
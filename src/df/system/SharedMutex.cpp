@@ -0,0 +1,52 @@
+#include <df/system/SharedMutex.h>
+
+#if defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/SharedMutexImpl.h>
+#else
+    #include <df/system/posix/SharedMutexImpl.h>
+#endif
+
+
+namespace df
+{
+SharedMutex::SharedMutex()
+{
+    _sharedMutexImpl = new priv::SharedMutexImpl;
+}
+
+SharedMutex::~SharedMutex()
+{
+    delete _sharedMutexImpl;
+}
+
+void SharedMutex::lock()
+{
+    _sharedMutexImpl->lock();
+}
+
+void SharedMutex::unlock()
+{
+    _sharedMutexImpl->unlock();
+}
+
+bool SharedMutex::tryLock()
+{
+    return _sharedMutexImpl->tryLock();
+}
+
+void SharedMutex::lockShared()
+{
+    _sharedMutexImpl->lockShared();
+}
+
+void SharedMutex::unlockShared()
+{
+    _sharedMutexImpl->unlockShared();
+}
+
+bool SharedMutex::tryLockShared()
+{
+    return _sharedMutexImpl->tryLockShared();
+}
+
+} // namespace df
@@ -0,0 +1,298 @@
+#include <df/system/TaskGraph.h>
+#include <df/system/ThreadPool.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <df/system/AtomicOps.h>
+#include <algorithm>
+#include <cassert>
+
+namespace df
+{
+
+namespace
+{
+const TaskGraph::TaskId NO_TASK = 0xFFFFFFFF;
+
+void runnableEntryPoint(void* runnable)
+{
+	((Runnable*)runnable)->run();
+}
+}
+
+class TaskGraph::PrivateData
+{
+public:
+	struct Edge
+	{
+		TaskId predecessor;
+		TaskId successor;
+	};
+
+	struct Node
+	{
+		void (*functionPtr)(void *);
+		void * userData;
+		const char* name;
+		PrivateData* graph;
+		uint32 firstSuccessor;        ///< index in successors
+		uint32 successorCount;
+		uint32 dependencyCount;       ///< number of predecessors
+		volatile uint32 pendingCount; ///< predecessors not done yet during a run
+		Time start;                   ///< relative to the start of the run
+		Time end;
+	};
+
+	PrivateData():isDirty(false), pool(0), group(0), criticalPathEnd(NO_TASK) {}
+
+	Array<Node> nodes;
+	Array<Edge> edges;
+	bool isDirty;              ///< tasks or dependencies were added since the last compile
+
+	// built by compile, so that a run does not allocate
+	Array<TaskId> successors;  ///< successors of each node, contiguous per node
+	Array<TaskId> order;       ///< topological order
+	Array<TaskId> roots;       ///< tasks without dependency
+	Array<Time> pathTimes;     ///< longest path ending with each task
+	Array<TaskId> criticalPredecessors;
+
+	// current run
+	ThreadPool* pool;
+	TaskGroup* group;
+	Timer timer;
+
+	// last run
+	Time runTime;
+	Time criticalPathTime;
+	TaskId criticalPathEnd;
+
+	void compile();
+	void computeCriticalPath();
+	static void execute(void* userData);
+};
+
+void TaskGraph::PrivateData::compile()
+{
+	const uint32 nodeCount = nodes.size();
+	for(uint32 i = 0; i < nodeCount; ++i)
+	{
+		nodes[i].graph = this;
+		nodes[i].successorCount = 0;
+		nodes[i].dependencyCount = 0;
+	}
+	for(uint32 i = 0; i < edges.size(); ++i)
+	{
+		++nodes[edges[i].predecessor].successorCount;
+		++nodes[edges[i].successor].dependencyCount;
+	}
+	uint32 offset = 0;
+	for(uint32 i = 0; i < nodeCount; ++i)
+	{
+		nodes[i].firstSuccessor = offset;
+		offset += nodes[i].successorCount;
+		nodes[i].successorCount = 0;
+	}
+	successors.resize(edges.size());
+	for(uint32 i = 0; i < edges.size(); ++i)
+	{
+		Node& node = nodes[edges[i].predecessor];
+		successors[node.firstSuccessor + node.successorCount++] = edges[i].successor;
+	}
+
+	// topological order (Kahn), pendingCount is used as scratch
+	roots.resize(0);
+	order.resize(0);
+	order.reserve(nodeCount);
+	for(uint32 i = 0; i < nodeCount; ++i)
+	{
+		nodes[i].pendingCount = nodes[i].dependencyCount;
+		if(nodes[i].dependencyCount == 0)
+		{
+			roots.push_back(i);
+			order.push_back(i);
+		}
+	}
+	for(uint32 i = 0; i < order.size(); ++i)
+	{
+		const Node& node = nodes[order[i]];
+		for(uint32 j = 0; j < node.successorCount; ++j)
+		{
+			const TaskId successor = successors[node.firstSuccessor + j];
+			if(--nodes[successor].pendingCount == 0) {
+				order.push_back(successor);
+			}
+		}
+	}
+	assert(order.size() == nodeCount && "A TaskGraph cannot contain cycles");
+
+	pathTimes.resize(nodeCount);
+	criticalPredecessors.resize(nodeCount);
+	isDirty = false;
+}
+
+void TaskGraph::PrivateData::computeCriticalPath()
+{
+	for(uint32 i = 0; i < nodes.size(); ++i)
+	{
+		pathTimes[i] = nodes[i].end - nodes[i].start;
+		criticalPredecessors[i] = NO_TASK;
+	}
+	criticalPathTime = Time();
+	criticalPathEnd = NO_TASK;
+	for(uint32 i = 0; i < order.size(); ++i)
+	{
+		const TaskId task = order[i];
+		const Node& node = nodes[task];
+		// predecessors come first in the order, the path of task is final
+		if(criticalPathEnd == NO_TASK || pathTimes[task] > criticalPathTime)
+		{
+			criticalPathTime = pathTimes[task];
+			criticalPathEnd = task;
+		}
+		for(uint32 j = 0; j < node.successorCount; ++j)
+		{
+			const TaskId successor = successors[node.firstSuccessor + j];
+			const Time pathTime = pathTimes[task] + (nodes[successor].end - nodes[successor].start);
+			if(pathTime > pathTimes[successor] || criticalPredecessors[successor] == NO_TASK)
+			{
+				pathTimes[successor] = pathTime;
+				criticalPredecessors[successor] = task;
+			}
+		}
+	}
+}
+
+void TaskGraph::PrivateData::execute(void* userData)
+{
+	Node* node = (Node*) userData;
+	PrivateData* graph = node->graph;
+
+	node->start = graph->timer.getElapsedTime();
+	node->functionPtr(node->userData);
+	node->end = graph->timer.getElapsedTime();
+
+	// the last predecessor to finish dispatches the successor
+	for(uint32 i = 0; i < node->successorCount; ++i)
+	{
+		Node& successor = graph->nodes[graph->successors[node->firstSuccessor + i]];
+		if(priv::atomicFetchAdd(&successor.pendingCount, uint32(-1)) == 1) {
+			graph->pool->submit(*graph->group, &PrivateData::execute, &successor);
+		}
+	}
+}
+
+TaskGraph::TaskGraph()
+{
+	_data = new PrivateData();
+}
+
+TaskGraph::~TaskGraph()
+{
+	delete _data;
+}
+
+TaskGraph::TaskId TaskGraph::addTask(void (*functionPtr)(void *), void * userData, const char* name)
+{
+	assert(functionPtr != NULL && "A task function cannot be NULL");
+	PrivateData::Node node;
+	node.functionPtr = functionPtr;
+	node.userData = userData;
+	node.name = name;
+	node.graph = _data;
+	node.firstSuccessor = 0;
+	node.successorCount = 0;
+	node.dependencyCount = 0;
+	node.pendingCount = 0;
+	_data->nodes.push_back(node);
+	_data->isDirty = true;
+	return _data->nodes.size() - 1;
+}
+
+TaskGraph::TaskId TaskGraph::addTask(Runnable* runnable, const char* name)
+{
+	assert(runnable != NULL && "A Runnable object cannot be NULL");
+	return addTask(&runnableEntryPoint, runnable, name);
+}
+
+void TaskGraph::addDependency(TaskId predecessor, TaskId successor)
+{
+	assert(predecessor < _data->nodes.size() && successor < _data->nodes.size());
+	assert(predecessor != successor && "A task cannot depend on itself");
+	PrivateData::Edge edge = { predecessor, successor };
+	_data->edges.push_back(edge);
+	_data->isDirty = true;
+}
+
+TaskGraph::TaskId TaskGraph::addContinuation(TaskId predecessor, void (*functionPtr)(void *), void * userData, const char* name)
+{
+	const TaskId task = addTask(functionPtr, userData, name);
+	addDependency(predecessor, task);
+	return task;
+}
+
+uint32 TaskGraph::getTaskCount() const
+{
+	return _data->nodes.size();
+}
+
+const char* TaskGraph::getTaskName(TaskId task) const
+{
+	return _data->nodes[task].name;
+}
+
+void TaskGraph::clear()
+{
+	_data->nodes.resize(0);
+	_data->edges.resize(0);
+	_data->criticalPathEnd = NO_TASK;
+	_data->isDirty = true;
+}
+
+void TaskGraph::run(ThreadPool& pool)
+{
+	if(_data->isDirty) {
+		_data->compile();
+	}
+	for(uint32 i = 0; i < _data->nodes.size(); ++i) {
+		_data->nodes[i].pendingCount = _data->nodes[i].dependencyCount;
+	}
+
+	TaskGroup group;
+	_data->pool = &pool;
+	_data->group = &group;
+	_data->timer.restart();
+	for(uint32 i = 0; i < _data->roots.size(); ++i) {
+		pool.submit(group, &PrivateData::execute, &_data->nodes[_data->roots[i]]);
+	}
+	pool.wait(group);
+	_data->runTime = _data->timer.getElapsedTime();
+	_data->pool = 0;
+	_data->group = 0;
+
+	_data->computeCriticalPath();
+}
+
+Time TaskGraph::getRunTime() const
+{
+	return _data->runTime;
+}
+
+Time TaskGraph::getCriticalPathTime() const
+{
+	return _data->criticalPathTime;
+}
+
+void TaskGraph::getCriticalPath(Array<TaskId>& path) const
+{
+	path.resize(0);
+	for(TaskId task = _data->criticalPathEnd; task != NO_TASK; task = _data->criticalPredecessors[task]) {
+		path.push_back(task);
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+Time TaskGraph::getTaskTime(TaskId task) const
+{
+	return _data->nodes[task].end - _data->nodes[task].start;
+}
+
+} // namespace df
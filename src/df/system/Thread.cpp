@@ -1,4 +1,6 @@
 #include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <df/system/AtomicOps.h>
 #if defined(DF_PLATFORM_WIN)
     #include <df/system/win32/ThreadImpl.h>
 #else
@@ -17,16 +19,16 @@ void runnableEntryPoint(void* runnable)
 }
 }
 
-Thread::Thread(Runnable* runnable)
+Thread::Thread(Runnable* runnable, const ThreadOptions& options)
 {
     assert(runnable!=NULL && "A Runnable object cannot be NULL");	
-	_threadImpl = new priv::ThreadImpl(&priv::runnableEntryPoint, runnable );
+	_threadImpl = new priv::ThreadImpl(&priv::runnableEntryPoint, runnable, options );
 }
 
-Thread::Thread(void (*functionPtr)(void *), void * userData)
+Thread::Thread(void (*functionPtr)(void *), void * userData, const ThreadOptions& options)
 {
 	assert(functionPtr!=NULL && "A thread function cannot be NULL");
-	_threadImpl = new priv::ThreadImpl(functionPtr, userData );
+	_threadImpl = new priv::ThreadImpl(functionPtr, userData, options );
 }
 
 Thread::~Thread()
@@ -61,12 +63,34 @@ void Thread::terminate()
 	}	
 }
 
+namespace this_thread
+{
+void sleepUntilPrecise(Time deadline, Time spinTime)
+{
+	if(spinTime <= Time()) {
+		spinTime = priv::ThreadImpl::getSleepLatency();
+	}
+	if(deadline - Timer::getCurrentTime() > spinTime) {
+		sleepUntil(deadline - spinTime);
+	}
+	while(Timer::getCurrentTime() < deadline) {
+		priv::cpuPause();
+	}
+}
+}
+
 /* Must be provided in the implementation
 namespace this_thread 
 {
 void Thread::sleep(Time time);
+void sleepUntil(Time deadline);
 void Thread::yield();
 uint32 Thread::getID();
+uint32 getCurrentCPU();
+uint32 getHardwareConcurrency();
+bool setAffinity(uint64 affinityMask);
+bool setName(const char* name);
+bool setPriority(ThreadOptions::Priority priority);
 }
 */
 
@@ -0,0 +1,78 @@
+#include <df/system/ThreadLocal.h>
+
+#if defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/ThreadLocalImpl.h>
+#else
+    #include <df/system/posix/ThreadLocalImpl.h>
+#endif
+
+
+namespace df
+{
+namespace priv
+{
+
+ThreadLocalBase::ThreadLocalBase(void (*destroySlot)(Slot*)):_slots(NULL), _slotCount(0), _destroySlot(destroySlot)
+{
+	_threadLocalImpl = new ThreadLocalImpl(&onThreadExit);
+}
+
+ThreadLocalBase::~ThreadLocalBase()
+{
+	// free the OS slot first: no thread exit callback can run after it
+	delete _threadLocalImpl;
+	ScopedLock lock(_mutex);
+	while(_slots)
+	{
+		Slot* slot = _slots;
+		_slots = slot->next;
+		_destroySlot(slot);
+	}
+	_slotCount = 0;
+}
+
+ThreadLocalBase::Slot* ThreadLocalBase::getSlot() const
+{
+	return (Slot*) _threadLocalImpl->getValue();
+}
+
+void ThreadLocalBase::addSlot(Slot* slot)
+{
+	slot->owner = this;
+	slot->previous = NULL;
+	{
+		ScopedLock lock(_mutex);
+		slot->next = _slots;
+		if(_slots) {
+			_slots->previous = slot;
+		}
+		_slots = slot;
+		++_slotCount;
+	}
+	_threadLocalImpl->setValue(slot);
+}
+
+void ThreadLocalBase::removeSlot(Slot* slot)
+{
+	ScopedLock lock(_mutex);
+	if(slot->previous) {
+		slot->previous->next = slot->next;
+	} else {
+		_slots = slot->next;
+	}
+	if(slot->next) {
+		slot->next->previous = slot->previous;
+	}
+	--_slotCount;
+}
+
+void ThreadLocalBase::onThreadExit(void* value)
+{
+	Slot* slot = (Slot*) value;
+	ThreadLocalBase* owner = slot->owner;
+	owner->removeSlot(slot);
+	owner->_destroySlot(slot);
+}
+
+} // namespace priv
+} // namespace df
@@ -0,0 +1,437 @@
+#include <df/system/ThreadPool.h>
+#include <df/system/Thread.h>
+#include <df/system/Mutex.h>
+#include <df/system/RingBuffer.h>
+#include <df/system/Profiler.h>
+#include <df/system/Futex.h>
+#include <df/system/Semaphore.h>
+#if defined(DF_PLATFORM_WIN)
+    #include <df/system/win32/ThreadImpl.h>
+#else
+    #include <df/system/posix/ThreadImpl.h>
+#endif
+#include <cassert>
+
+namespace df
+{
+
+using namespace priv;
+
+namespace
+{
+struct Task
+{
+	void (*functionPtr)(void *);
+	void * userData;
+	TaskGroup* group; ///< NULL if the task is not part of a group
+};
+
+/// \brief Chase-Lev work-stealing deque with a fixed capacity
+/// The owner pushes and pops at the bottom, thieves steal at the top.
+/// Slots are read and written field by field with atomic operations: a thief may read a slot
+/// while the owner overwrites it, but then its compare-exchange on top fails and the task is discarded.
+class TaskDeque : NonCopyable
+{
+public:
+	static const uint32 CAPACITY = 1024;
+
+	TaskDeque():_top(0), _bottom(0) {}
+
+	/// owner only, return false when the deque is full
+	bool push(const Task& task)
+	{
+		const uint32 bottom = atomicLoadRelaxed(&_bottom);
+		const uint32 top = atomicLoadAcquire(&_top);
+		if(bottom - top >= CAPACITY) {
+			return false;
+		}
+		Slot& slot = _slots[bottom & (CAPACITY - 1)];
+		atomicStoreRelaxed(&slot.functionPtr, task.functionPtr);
+		atomicStoreRelaxed(&slot.userData, task.userData);
+		atomicStoreRelaxed(&slot.group, task.group);
+		atomicStoreRelease(&_bottom, bottom + 1);
+		return true;
+	}
+
+	/// owner only, take the most recently pushed task
+	bool pop(Task& task)
+	{
+		const uint32 bottom = atomicLoadRelaxed(&_bottom) - 1;
+		atomicStoreRelaxed(&_bottom, bottom);
+		atomicThreadFence();
+		uint32 top = atomicLoadRelaxed(&_top);
+		if(int32(bottom - top) < 0)
+		{
+			// empty
+			atomicStoreRelaxed(&_bottom, bottom + 1);
+			return false;
+		}
+		read(bottom, task);
+		if(bottom != top) {
+			return true;
+		}
+		// last task: race against the thieves
+		const bool isTaken = atomicCompareExchange(&_top, top, top + 1);
+		atomicStoreRelaxed(&_bottom, bottom + 1);
+		return isTaken;
+	}
+
+	/// any thread, take the oldest task (may fail on contention even if the deque is not empty)
+	bool steal(Task& task)
+	{
+		uint32 top = atomicLoadAcquire(&_top);
+		atomicThreadFence();
+		const uint32 bottom = atomicLoadAcquire(&_bottom);
+		if(int32(bottom - top) <= 0) {
+			return false;
+		}
+		read(top, task);
+		return atomicCompareExchange(&_top, top, top + 1);
+	}
+
+	bool isEmpty() const { return int32(atomicLoadAcquire(&_bottom) - atomicLoadAcquire(&_top)) <= 0; }
+
+private:
+	struct Slot
+	{
+		void (* volatile functionPtr)(void *);
+		void * volatile userData;
+		TaskGroup* volatile group;
+	};
+
+	void read(uint32 index, Task& task) const
+	{
+		const Slot& slot = _slots[index & (CAPACITY - 1)];
+		task.functionPtr = atomicLoadRelaxed(&slot.functionPtr);
+		task.userData = atomicLoadRelaxed(&slot.userData);
+		task.group = atomicLoadRelaxed(&slot.group);
+	}
+
+	// top and bottom are on their own cache lines: thieves only write top
+	char _pad0[DF_CACHE_LINE_SIZE];
+	volatile uint32 _top;
+	char _pad1[DF_CACHE_LINE_SIZE - sizeof(uint32)];
+	volatile uint32 _bottom;
+	char _pad2[DF_CACHE_LINE_SIZE - sizeof(uint32)];
+	Slot _slots[CAPACITY];
+};
+
+struct Worker
+{
+	Worker():thread(NULL), pool(NULL), randomState(0) {}
+
+	TaskDeque deque;
+	Thread* thread;
+	const void* pool;   ///< private data of the pool owning the worker
+	uint32 randomState; ///< victim selection
+};
+
+/// worker running on the calling thread, NULL for threads which are not pool workers
+DF_THREAD_LOCAL Worker* t_currentWorker = NULL;
+
+void runnableEntryPoint(void* runnable)
+{
+	((Runnable*)runnable)->run();
+}
+}
+
+class ThreadPool::PrivateData
+{
+public:
+	/// idle rounds (failed searches for a task) before a worker is parked
+	static const uint32 SPIN_COUNT = 64;
+
+	PrivateData(uint32 workerCount)
+		:workers(NULL), workerCount(workerCount), queueMutex("df::ThreadPool queue"), queueSize(0), sleeperCount(0), isStopping(0)
+	{
+		if(workerCount > 0) {
+			workers = new Worker[workerCount];
+		}
+	}
+	~PrivateData() { delete [] workers; }
+
+	Worker* workers;
+	uint32 workerCount;
+
+	Mutex queueMutex;
+	RingBuffer<Task> queue;       ///< tasks submitted from outside the pool, protected by queueMutex
+	volatile uint32 queueSize;    ///< size of queue, readable without the lock
+
+	volatile uint32 sleeperCount; ///< workers parked (or about to) on wakeUp
+	Semaphore wakeUp;
+	volatile uint32 isStopping;
+
+	/// worker of this pool running on the calling thread, if any
+	Worker* getCurrentWorker() const
+	{
+		Worker* worker = t_currentWorker;
+		return (worker && worker->pool == this) ? worker : NULL;
+	}
+
+	void push(const Task& task)
+	{
+		if(task.group) {
+			atomicFetchAdd(&task.group->_pendingCount, uint32(1));
+		}
+		Worker* worker = getCurrentWorker();
+		if(!worker || !worker->deque.push(task))
+		{
+			ScopedLock lock(queueMutex);
+			queue.push_back(task);
+			atomicStoreRelease(&queueSize, queue.size());
+		}
+		wakeOne();
+	}
+
+	bool findTask(Worker* worker, Task& task)
+	{
+		if(worker && worker->deque.pop(task)) {
+			return true;
+		}
+		if(atomicLoadAcquire(&queueSize) > 0)
+		{
+			ScopedLock lock(queueMutex);
+			if(!queue.empty())
+			{
+				task = queue.front();
+				queue.pop_front();
+				atomicStoreRelease(&queueSize, queue.size());
+				return true;
+			}
+		}
+		// steal, starting from a random victim to spread the contention
+		uint32 first = 0;
+		if(worker)
+		{
+			worker->randomState = worker->randomState * 1664525u + 1013904223u;
+			first = (worker->randomState >> 16) % workerCount;
+		}
+		for(uint32 i = 0; i < workerCount; ++i)
+		{
+			Worker& victim = workers[(first + i) % workerCount];
+			if(&victim != worker && victim.deque.steal(task)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool hasWork() const
+	{
+		if(atomicLoadAcquire(&queueSize) > 0) {
+			return true;
+		}
+		for(uint32 i = 0; i < workerCount; ++i)
+		{
+			if(!workers[i].deque.isEmpty()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static void execute(const Task& task)
+	{
+		{
+			DF_PROFILE_SCOPE("df::ThreadPool task");
+			task.functionPtr(task.userData);
+		}
+		if(task.group)
+		{
+			// the last task wakes up the parked waiters; a waiter which did not park may already have
+			// destroyed the group, so only its address is used after the decrement
+			volatile uint32* pendingCount = &task.group->_pendingCount;
+			if(atomicFetchAdd(pendingCount, uint32(-1)) == (TaskGroup::WAITER_FLAG | 1)) {
+				futexWakeAll(pendingCount);
+			}
+		}
+	}
+
+	/// block a thread which is not a worker until the last task of group is executed (or spuriously)
+	static void parkWaiter(TaskGroup& group)
+	{
+		uint32 count = atomicLoadAcquire(&group._pendingCount);
+		if((count & ~TaskGroup::WAITER_FLAG) == 0) {
+			return;
+		}
+		if(!(count & TaskGroup::WAITER_FLAG) && !atomicCompareExchange(&group._pendingCount, count, count | TaskGroup::WAITER_FLAG)) {
+			return;
+		}
+		futexWait(&group._pendingCount, count | TaskGroup::WAITER_FLAG);
+	}
+
+	/// wake up a parked worker, if any
+	void wakeOne()
+	{
+		// pairs with the fence in park: either the worker sees the new task or we see the worker
+		atomicThreadFence();
+		uint32 count = atomicLoadAcquire(&sleeperCount);
+		while(count > 0)
+		{
+			if(atomicCompareExchange(&sleeperCount, count, count - 1))
+			{
+				wakeUp.post();
+				return;
+			}
+		}
+	}
+
+	void park()
+	{
+		atomicFetchAdd(&sleeperCount, uint32(1));
+		atomicThreadFence();
+		if(hasWork() || atomicLoadAcquire(&isStopping))
+		{
+			// cancel, unless a submitter already took our registration (then its token is coming)
+			uint32 count = atomicLoadAcquire(&sleeperCount);
+			while(count > 0)
+			{
+				if(atomicCompareExchange(&sleeperCount, count, count - 1)) {
+					return;
+				}
+			}
+		}
+		wakeUp.wait();
+	}
+
+	static void workerEntryPoint(void* userData);
+};
+
+void ThreadPool::PrivateData::workerEntryPoint(void* userData)
+{
+	Worker* worker = (Worker*) userData;
+	PrivateData* data = (PrivateData*) worker->pool;
+	t_currentWorker = worker;
+
+	uint32 idleCount = 0;
+	for(;;)
+	{
+		Task task;
+		if(data->findTask(worker, task))
+		{
+			execute(task);
+			idleCount = 0;
+			continue;
+		}
+		if(atomicLoadAcquire(&data->isStopping) && !data->hasWork()) {
+			break;
+		}
+		if(++idleCount < SPIN_COUNT)
+		{
+			cpuPause();
+			continue;
+		}
+		data->park();
+		idleCount = 0;
+	}
+	t_currentWorker = NULL;
+}
+
+ThreadPool::ThreadPool(uint32 workerCount)
+{
+	if(workerCount == DEFAULT_WORKER_COUNT) {
+		workerCount = getHardwareConcurrency() - 1;
+	}
+	_data = new PrivateData(workerCount);
+	for(uint32 i = 0; i < workerCount; ++i)
+	{
+		Worker& worker = _data->workers[i];
+		worker.pool = _data;
+		worker.randomState = i + 1;
+		worker.thread = new Thread(&PrivateData::workerEntryPoint, &worker);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	// workers execute the queued tasks, then exit once there is no work left
+	atomicStoreRelease(&_data->isStopping, uint32(1));
+	_data->wakeUp.post(_data->workerCount);
+	for(uint32 i = 0; i < _data->workerCount; ++i)
+	{
+		_data->workers[i].thread->join();
+		delete _data->workers[i].thread;
+	}
+	delete _data;
+}
+
+uint32 ThreadPool::getWorkerCount() const
+{
+	return _data->workerCount;
+}
+
+void ThreadPool::submit(void (*functionPtr)(void *), void * userData)
+{
+	assert(functionPtr != NULL && "A task function cannot be NULL");
+	Task task = { functionPtr, userData, NULL };
+	if(_data->workerCount == 0)
+	{
+		// nobody to delegate to
+		PrivateData::execute(task);
+		return;
+	}
+	_data->push(task);
+}
+
+void ThreadPool::submit(TaskGroup& group, void (*functionPtr)(void *), void * userData)
+{
+	assert(functionPtr != NULL && "A task function cannot be NULL");
+	Task task = { functionPtr, userData, &group };
+	if(_data->workerCount == 0)
+	{
+		atomicFetchAdd(&group._pendingCount, uint32(1));
+		PrivateData::execute(task);
+		return;
+	}
+	_data->push(task);
+}
+
+void ThreadPool::submit(Runnable* runnable)
+{
+	assert(runnable != NULL && "A Runnable object cannot be NULL");
+	submit(&runnableEntryPoint, runnable);
+}
+
+void ThreadPool::submit(TaskGroup& group, Runnable* runnable)
+{
+	assert(runnable != NULL && "A Runnable object cannot be NULL");
+	submit(group, &runnableEntryPoint, runnable);
+}
+
+void ThreadPool::wait(TaskGroup& group)
+{
+	Worker* worker = _data->getCurrentWorker();
+	uint32 idleCount = 0;
+	while(!group.isDone())
+	{
+		// help instead of blocking: the tasks of the group may be queued behind the current one
+		Task task;
+		if(_data->findTask(worker, task))
+		{
+			PrivateData::execute(task);
+			idleCount = 0;
+		}
+		else if(++idleCount < PrivateData::SPIN_COUNT) {
+			cpuPause();
+		}
+		else if(worker) {
+			// the other workers may push tasks of the group to their deque: keep stealing
+			this_thread::yield();
+		}
+		else
+		{
+			PrivateData::parkWaiter(group);
+			idleCount = 0;
+		}
+	}
+	// done: remove the flag so that the next use of the group does not wake up anybody
+	uint32 flagOnly = TaskGroup::WAITER_FLAG;
+	atomicCompareExchange(&group._pendingCount, flagOnly, uint32(0));
+}
+
+uint32 ThreadPool::getHardwareConcurrency()
+{
+	return priv::ThreadImpl::getHardwareConcurrency();
+}
+
+} // namespace df
@@ -27,4 +27,9 @@ Time Timer::restart()
     return elapsed;
 }
 
+Time Timer::getCurrentTime()
+{
+    return priv::TimerImpl::getCurrentTime();
+}
+
 } // namespace df
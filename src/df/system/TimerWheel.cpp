@@ -0,0 +1,325 @@
+#include <df/system/TimerWheel.h>
+#include <df/system/Timer.h>
+#include <df/system/Thread.h>
+#include <df/system/Mutex.h>
+#include <df/system/Event.h>
+#include <cassert>
+
+namespace df
+{
+
+namespace
+{
+/// first tick at or after elapsed
+uint64 ceilTicks(int64 elapsed, int64 resolution)
+{
+	return (elapsed <= 0) ? 0 : uint64((elapsed + resolution - 1) / resolution);
+}
+
+/// last tick at or before elapsed
+uint64 floorTicks(int64 elapsed, int64 resolution)
+{
+	return (elapsed <= 0) ? 0 : uint64(elapsed / resolution);
+}
+}
+
+// *** TimerWheel ***
+TimerWheel::TimerWheel(Time resolution)
+	:_resolution(resolution), _origin(Timer::getCurrentTime()), _currentTick(0), _count(0), _firstFree(NONE)
+{
+	assert(resolution > Time() && "The resolution of a timer wheel must be positive");
+	for(uint32 i = 0; i < LEVEL_COUNT * SLOT_COUNT; ++i) {
+		_slots[i] = NONE;
+	}
+	for(uint32 i = 0; i < LEVEL_COUNT; ++i) {
+		_levelCounts[i] = 0;
+	}
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+void TimerWheel::reserve(uint32 count)
+{
+	_nodes.reserve(count);
+}
+
+uint32 TimerWheel::allocateNode()
+{
+	uint32 index = _firstFree;
+	if(index != NONE)
+	{
+		_firstFree = _nodes[index].next;
+		return index;
+	}
+	Node node = Node();
+	node.generation = 1;
+	_nodes.push_back(node);
+	return _nodes.size() - 1;
+}
+
+void TimerWheel::freeNode(uint32 index)
+{
+	Node& node = _nodes[index];
+	node.functionPtr = NULL;
+	// ids of the previous uses of the node become invalid, 0 is never used
+	if(++node.generation == 0) {
+		node.generation = 1;
+	}
+	node.next = _firstFree;
+	_firstFree = index;
+	--_count;
+}
+
+void TimerWheel::insert(uint32 index)
+{
+	Node& node = _nodes[index];
+	// a timer beyond the range of the wheel waits in the farthest slot, it is placed again from there
+	const uint64 maxDelta = (uint64(1) << (SLOT_BITS * LEVEL_COUNT)) - 1;
+	const uint64 tick = (node.tick - _currentTick > maxDelta) ? _currentTick + maxDelta : node.tick;
+	const uint64 delta = tick - _currentTick;
+
+	uint32 level = 0;
+	while(level < LEVEL_COUNT - 1 && delta >= (uint64(1) << (SLOT_BITS * (level + 1)))) {
+		++level;
+	}
+	const uint32 slot = level * SLOT_COUNT + uint32((tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+
+	node.slot = slot;
+	node.previous = NONE;
+	node.next = _slots[slot];
+	if(node.next != NONE) {
+		_nodes[node.next].previous = index;
+	}
+	_slots[slot] = index;
+	++_levelCounts[level];
+}
+
+void TimerWheel::unlink(uint32 index)
+{
+	Node& node = _nodes[index];
+	if(node.previous != NONE) {
+		_nodes[node.previous].next = node.next;
+	} else {
+		_slots[node.slot] = node.next;
+	}
+	if(node.next != NONE) {
+		_nodes[node.next].previous = node.previous;
+	}
+	--_levelCounts[node.slot / SLOT_COUNT];
+}
+
+void TimerWheel::cascade(uint32 level)
+{
+	const uint32 slot = level * SLOT_COUNT + uint32((_currentTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+	// the timers of the slot are due within the next period of the level: they go to lower levels
+	for(uint32 index = _slots[slot]; index != NONE; index = _slots[slot])
+	{
+		unlink(index);
+		insert(index);
+	}
+}
+
+uint32 TimerWheel::getLowestLevel() const
+{
+	uint32 level = 0;
+	while(level < LEVEL_COUNT && _levelCounts[level] == 0) {
+		++level;
+	}
+	return level;
+}
+
+TimerId TimerWheel::schedule(Time deadline, void (*functionPtr)(void *), void * userData)
+{
+	assert(functionPtr != NULL && "A timer function cannot be NULL");
+	const uint32 index = allocateNode();
+	Node& node = _nodes[index];
+	node.tick = ceilTicks((deadline - _origin).asNanoseconds(), _resolution.asNanoseconds());
+	// a past deadline fires at the next tick; a cascaded timer due at the current tick stays there,
+	// in the level 0 slot fired right after the cascade
+	if(node.tick <= _currentTick) {
+		node.tick = _currentTick + 1;
+	}
+	node.functionPtr = functionPtr;
+	node.userData = userData;
+	++_count;
+	insert(index);
+	return (TimerId(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(TimerId timer)
+{
+	const uint32 index = uint32(timer);
+	const uint32 generation = uint32(timer >> 32);
+	if(index >= _nodes.size() || _nodes[index].generation != generation || !_nodes[index].functionPtr) {
+		return false;
+	}
+	unlink(index);
+	freeNode(index);
+	return true;
+}
+
+uint32 TimerWheel::advance(Time now)
+{
+	const uint64 target = floorTicks((now - _origin).asNanoseconds(), _resolution.asNanoseconds());
+	uint32 firedCount = 0;
+	while(_currentTick < target)
+	{
+		// with the lower levels empty, nothing happens before the next cascade of the lowest level having timers
+		const uint32 lowestLevel = getLowestLevel();
+		if(lowestLevel == LEVEL_COUNT)
+		{
+			_currentTick = target;
+			break;
+		}
+		if(lowestLevel > 0)
+		{
+			const uint32 shift = SLOT_BITS * lowestLevel;
+			const uint64 lastIdleTick = (((_currentTick >> shift) + 1) << shift) - 1;
+			_currentTick = (lastIdleTick < target) ? lastIdleTick : target;
+			if(_currentTick == target) {
+				break;
+			}
+		}
+
+		++_currentTick;
+		// the highest levels first: their timers may go to the slots cascaded next
+		for(uint32 level = LEVEL_COUNT - 1; level > 0; --level)
+		{
+			if((_currentTick & ((uint64(1) << (SLOT_BITS * level)) - 1)) == 0) {
+				cascade(level);
+			}
+		}
+
+		// one timer at a time: a callback may cancel the next ones
+		const uint32 slot = uint32(_currentTick & (SLOT_COUNT - 1));
+		for(uint32 index = _slots[slot]; index != NONE; index = _slots[slot])
+		{
+			Node& node = _nodes[index];
+			assert(node.tick == _currentTick);
+			void (*functionPtr)(void *) = node.functionPtr;
+			void * userData = node.userData;
+			unlink(index);
+			freeNode(index);
+			functionPtr(userData);
+			++firedCount;
+		}
+	}
+	return firedCount;
+}
+
+Time TimerWheel::getNextDeadline() const
+{
+	const uint32 lowestLevel = getLowestLevel();
+	if(lowestLevel == LEVEL_COUNT) {
+		return _origin + _resolution * int64(_currentTick);
+	}
+	if(lowestLevel > 0)
+	{
+		// nothing can fire before the next cascade
+		const uint32 shift = SLOT_BITS * lowestLevel;
+		const uint64 nextCascade = ((_currentTick >> shift) + 1) << shift;
+		return _origin + _resolution * int64(nextCascade);
+	}
+	for(uint64 tick = _currentTick + 1; ; ++tick)
+	{
+		if(_slots[tick & (SLOT_COUNT - 1)] != NONE) {
+			return _origin + _resolution * int64(tick);
+		}
+	}
+}
+
+// *** TimerWheelThread ***
+class TimerWheelThread::PrivateData
+{
+public:
+	PrivateData(Time resolution)
+		:wheel(resolution), mutex("df::TimerWheelThread"), thread(NULL), isStopping(false), isWakeUpPlanned(false) {}
+
+	TimerWheel wheel;
+	mutable Mutex mutex;  ///< recursive: callbacks run with the lock and can schedule timers
+	Event wakeUp;
+	Thread* thread;
+	bool isStopping;      ///< protected by mutex
+	bool isWakeUpPlanned; ///< protected by mutex
+	Time plannedWakeUp;   ///< next time the driver wakes up by itself, protected by mutex
+
+	static void driverEntryPoint(void* userData);
+};
+
+void TimerWheelThread::PrivateData::driverEntryPoint(void* userData)
+{
+	PrivateData* data = (PrivateData*) userData;
+	for(;;)
+	{
+		bool isWakeUpPlanned = false;
+		Time timeout;
+		{
+			ScopedLock lock(data->mutex);
+			if(data->isStopping) {
+				break;
+			}
+			data->wheel.advance(Timer::getCurrentTime());
+			isWakeUpPlanned = data->isWakeUpPlanned = data->wheel.getCount() > 0;
+			if(isWakeUpPlanned)
+			{
+				data->plannedWakeUp = data->wheel.getNextDeadline();
+				timeout = data->plannedWakeUp - Timer::getCurrentTime();
+			}
+		}
+		// schedule and the destructor set wakeUp when the driver must look again earlier
+		if(!isWakeUpPlanned) {
+			data->wakeUp.wait();
+		} else if(timeout > Time()) {
+			data->wakeUp.wait(timeout);
+		}
+	}
+}
+
+TimerWheelThread::TimerWheelThread(Time resolution)
+{
+	_data = new PrivateData(resolution);
+	ThreadOptions options;
+	options.name = "df_timer_wheel";
+	_data->thread = new Thread(&PrivateData::driverEntryPoint, _data, options);
+}
+
+TimerWheelThread::~TimerWheelThread()
+{
+	{
+		ScopedLock lock(_data->mutex);
+		_data->isStopping = true;
+	}
+	_data->wakeUp.set();
+	_data->thread->join();
+	delete _data->thread;
+	delete _data;
+}
+
+TimerId TimerWheelThread::schedule(Time deadline, void (*functionPtr)(void *), void * userData)
+{
+	ScopedLock lock(_data->mutex);
+	const TimerId timer = _data->wheel.schedule(deadline, functionPtr, userData);
+	if(!_data->isWakeUpPlanned || deadline < _data->plannedWakeUp)
+	{
+		_data->isWakeUpPlanned = true;
+		_data->plannedWakeUp = deadline;
+		_data->wakeUp.set();
+	}
+	return timer;
+}
+
+bool TimerWheelThread::cancel(TimerId timer)
+{
+	ScopedLock lock(_data->mutex);
+	return _data->wheel.cancel(timer);
+}
+
+uint32 TimerWheelThread::getCount() const
+{
+	ScopedLock lock(_data->mutex);
+	return _data->wheel.getCount();
+}
+
+} // namespace df
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Unix implementation of a condition variable, with its own mutex
+/// The mutex must be locked around wait and around the modification of the waited state.
+class ConditionImpl : NonCopyable
+{
+public :
+	ConditionImpl()
+	{
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_condattr_t attributes;
+		pthread_condattr_init(&attributes);
+#if !defined(DF_PLATFORM_OSX) && !defined(DF_PLATFORM_IOS) && !defined(DF_PLATFORM_IOS_SIM)
+		// timeouts must not be affected by changes of the system time
+		pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+#endif
+		pthread_cond_init(&_condition, &attributes);
+		pthread_condattr_destroy(&attributes);
+	}
+	~ConditionImpl()
+	{
+		pthread_cond_destroy(&_condition);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	void lock() { pthread_mutex_lock(&_mutex); }
+	void unlock() { pthread_mutex_unlock(&_mutex); }
+
+	void wait() { pthread_cond_wait(&_condition, &_mutex); }
+
+	/// return false if the timeout expired before a notification (spurious wake ups are possible)
+	bool wait(Time timeout)
+	{
+		if(timeout <= Time()) {
+			return false;
+		}
+		const int64 nanoseconds = timeout.asNanoseconds();
+		struct timespec time;
+#if defined(DF_PLATFORM_OSX) || defined(DF_PLATFORM_IOS) || defined(DF_PLATFORM_IOS_SIM)
+		time.tv_sec = time_t(nanoseconds / 1000000000);
+		time.tv_nsec = long(nanoseconds % 1000000000);
+		return pthread_cond_timedwait_relative_np(&_condition, &_mutex, &time) != ETIMEDOUT;
+#else
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		time.tv_sec += time_t(nanoseconds / 1000000000);
+		time.tv_nsec += long(nanoseconds % 1000000000);
+		if(time.tv_nsec >= 1000000000)
+		{
+			time.tv_nsec -= 1000000000;
+			++time.tv_sec;
+		}
+		return pthread_cond_timedwait(&_condition, &_mutex, &time) != ETIMEDOUT;
+#endif
+	}
+
+	void notifyOne() { pthread_cond_signal(&_condition); }
+	void notifyAll() { pthread_cond_broadcast(&_condition); }
+
+private :
+	pthread_mutex_t _mutex;    ///< pthread handle of the mutex
+	pthread_cond_t _condition; ///< pthread handle of the condition
+};
+
+} // namespace priv
+
+} // namespace df
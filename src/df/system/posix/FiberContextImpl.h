@@ -0,0 +1,167 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cassert>
+
+// x86-64 ELF platforms switch with a few instructions, the others use ucontext (which also saves
+// the signal mask with a system call, so a switch costs a few hundred nanoseconds).
+#if defined(__x86_64__) && defined(__ELF__) && !defined(DF_FIBER_UCONTEXT)
+	#define DF_FIBER_ASM
+#else
+	#include <ucontext.h>
+#endif
+
+#if defined(DF_FIBER_ASM)
+extern "C"
+{
+/// save the callee-saved registers on the current stack, store its pointer in *fromStack and resume toStack
+void df_fiber_switch(void** fromStack, void* toStack);
+/// first code executed by a new fiber: call r12(r13)
+void df_fiber_start();
+}
+
+__asm__(
+	".text\n"
+	".globl df_fiber_switch\n"
+	".hidden df_fiber_switch\n"
+	".type df_fiber_switch,@function\n"
+	"df_fiber_switch:\n"
+	"	pushq %rbp\n"
+	"	pushq %rbx\n"
+	"	pushq %r12\n"
+	"	pushq %r13\n"
+	"	pushq %r14\n"
+	"	pushq %r15\n"
+	"	subq $8, %rsp\n"
+	"	stmxcsr (%rsp)\n"
+	"	fnstcw 4(%rsp)\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	ldmxcsr (%rsp)\n"
+	"	fldcw 4(%rsp)\n"
+	"	addq $8, %rsp\n"
+	"	popq %r15\n"
+	"	popq %r14\n"
+	"	popq %r13\n"
+	"	popq %r12\n"
+	"	popq %rbx\n"
+	"	popq %rbp\n"
+	"	ret\n"
+	".size df_fiber_switch,.-df_fiber_switch\n"
+	".globl df_fiber_start\n"
+	".hidden df_fiber_start\n"
+	".type df_fiber_start,@function\n"
+	"df_fiber_start:\n"
+	"	movq %r13, %rdi\n"
+	"	callq *%r12\n"
+	"	ud2\n"
+	".size df_fiber_start,.-df_fiber_start\n"
+);
+#endif
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Unix implementation of an execution context (registers and stack) of a fiber
+/// A context is either created with its own stack, or represents the thread that switches to fibers.
+class FiberContextImpl : NonCopyable
+{
+public :
+	FiberContextImpl():_stack(NULL), _stackSize(0)
+	{
+#if defined(DF_FIBER_ASM)
+		_stackPointer = NULL;
+#endif
+	}
+	~FiberContextImpl() { destroy(); }
+
+	/// the calling thread is about to switch to fibers, this context will hold its state
+	void initializeFromThread() {}
+	void releaseFromThread() {}
+
+	/// allocate a stack of stackSize bytes (plus a guard page) on which entry(argument) will run
+	/// entry must never return: a fiber ends by switching to another context for good.
+	void create(uint32 stackSize, void (*entry)(void*), void* argument)
+	{
+		const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+		_stackSize = (size_t(stackSize) + pageSize - 1) / pageSize * pageSize + pageSize;
+		_stack = (char*) mmap(NULL, _stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+		assert(_stack != MAP_FAILED && "Failed to allocate a fiber stack");
+		// an overflow hits the guard page instead of the neighbouring memory
+		mprotect(_stack, pageSize, PROT_NONE);
+
+#if defined(DF_FIBER_ASM)
+		// frame popped by the first df_fiber_switch to this context, the return address being
+		// at 8 mod 16 so that the stack is aligned as expected at the call of entry
+		uintptr_t top = (uintptr_t(_stack) + _stackSize) & ~uintptr_t(15);
+		void** frame = (void**) (top - 24 - 56);
+		uint32* controlWords = (uint32*) frame;
+		controlWords[0] = 0x1F80; // mxcsr: all exceptions masked, round to nearest
+		controlWords[1] = 0x037F; // x87 control word: default
+		frame[1] = NULL;                   // r15
+		frame[2] = NULL;                   // r14
+		frame[3] = argument;               // r13
+		frame[4] = (void*) entry;          // r12
+		frame[5] = NULL;                   // rbx
+		frame[6] = NULL;                   // rbp
+		frame[7] = (void*) &df_fiber_start; // return address
+		_stackPointer = frame;
+#else
+		getcontext(&_context);
+		_context.uc_stack.ss_sp = _stack + pageSize;
+		_context.uc_stack.ss_size = _stackSize - pageSize;
+		_context.uc_link = NULL;
+		// makecontext only passes int arguments: split the pointers
+		_entry = entry;
+		_argument = argument;
+		const uint64 self = uint64(uintptr_t(this));
+		makecontext(&_context, (void (*)()) &startContext, 2, int(uint32(self >> 32)), int(uint32(self)));
+#endif
+	}
+
+	void destroy()
+	{
+		if(_stack)
+		{
+			munmap(_stack, _stackSize);
+			_stack = NULL;
+		}
+	}
+
+	/// save the calling context in from and resume to
+	static void switchTo(FiberContextImpl& from, FiberContextImpl& to)
+	{
+#if defined(DF_FIBER_ASM)
+		df_fiber_switch(&from._stackPointer, to._stackPointer);
+#else
+		swapcontext(&from._context, &to._context);
+#endif
+	}
+
+private :
+#if defined(DF_FIBER_ASM)
+	void* _stackPointer; ///< saved stack pointer, the registers are on the stack
+#else
+	static void startContext(int high, int low)
+	{
+		FiberContextImpl* context = (FiberContextImpl*) uintptr_t((uint64(uint32(high)) << 32) | uint64(uint32(low)));
+		context->_entry(context->_argument);
+	}
+
+	ucontext_t _context;
+	void (*_entry)(void*);
+	void* _argument;
+#endif
+	char* _stack;      ///< NULL for the context of a thread
+	size_t _stackSize; ///< including the guard page
+};
+
+} // namespace priv
+
+} // namespace df
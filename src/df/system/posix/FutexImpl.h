@@ -0,0 +1,46 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/Time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Linux futex system calls (process private)
+class FutexImpl
+{
+public :
+	static void wait(volatile uint32* address, uint32 expected)
+	{
+		syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+	}
+
+	static bool wait(volatile uint32* address, uint32 expected, Time timeout)
+	{
+		if(timeout <= Time()) {
+			return false;
+		}
+		// relative timeout, measured on the monotonic clock
+		struct timespec time;
+		time.tv_sec = time_t(timeout.asNanoseconds() / 1000000000);
+		time.tv_nsec = long(timeout.asNanoseconds() % 1000000000);
+		return syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, &time, NULL, 0) == 0 || errno != ETIMEDOUT;
+	}
+
+	static void wake(volatile uint32* address, int count)
+	{
+		syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+	}
+};
+
+} // namespace priv
+
+} // namespace df
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Unix implementation of memory mapped files
+class MappedFileImpl : NonCopyable
+{
+public :
+	MappedFileImpl():_file(-1), _data(0), _size(0), _isWritable(false) {}
+	~MappedFileImpl()
+	{
+		unmap();
+		if(_file != -1) ::close(_file);
+	}
+
+	bool open(const char* path, bool isWritable)
+	{
+		_isWritable = isWritable;
+		_file = ::open(path, isWritable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+		if(_file == -1) {
+			return false;
+		}
+		struct stat info;
+		if(fstat(_file, &info) != 0) {
+			return false;
+		}
+		_size = (uint64) info.st_size;
+		return map();
+	}
+
+	void* getData() const { return _data; }
+	uint64 getSize() const { return _size; }
+
+	bool resize(uint64 size)
+	{
+		unmap();
+		if(ftruncate(_file, (off_t) size) != 0)
+		{
+			map(); // keep the previous mapping
+			return false;
+		}
+		_size = size;
+		return map();
+	}
+
+	bool flush() { return _data == 0 || msync(_data, (size_t) _size, MS_SYNC) == 0; }
+
+private :
+	bool map()
+	{
+		// an empty file cannot be mapped
+		if(_size == 0) {
+			return true;
+		}
+		void* data = mmap(0, (size_t) _size, _isWritable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, _file, 0);
+		if(data == MAP_FAILED) {
+			return false;
+		}
+		_data = data;
+		return true;
+	}
+
+	void unmap()
+	{
+		if(_data) munmap(_data, (size_t) _size);
+		_data = 0;
+	}
+
+	int _file;        ///< file descriptor
+	void* _data;      ///< start of the mapping
+	uint64 _size;     ///< size of the file (and of the mapping)
+	bool _isWritable;
+};
+
+} // namespace priv
+
+} // namespace df
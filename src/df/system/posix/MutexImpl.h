@@ -24,7 +24,7 @@ public :
 
 	void lock() { pthread_mutex_lock(&_mutex); }
 	void unlock() {  pthread_mutex_unlock(&_mutex); }
-	bool trylock() {  return (pthread_mutex_trylock(&_mutex) == 0) ? true : false; }
+	bool tryLock() {  return (pthread_mutex_trylock(&_mutex) == 0) ? true : false; }
 
 private :
     pthread_mutex_t _mutex; ///< pthread handle of the mutex
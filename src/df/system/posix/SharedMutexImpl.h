@@ -0,0 +1,42 @@
+#pragma once
+
+#include <df/system/NonCopyable.h>
+#include <pthread.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Unix implementation of reader-writer locks
+class SharedMutexImpl : NonCopyable
+{
+public :
+    SharedMutexImpl()
+	{
+		pthread_rwlockattr_t attributes;
+		pthread_rwlockattr_init(&attributes);
+#if defined(__GLIBC__)
+		// glibc favors readers by default, writers could starve
+		pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+		pthread_rwlock_init(&_lock, &attributes);
+		pthread_rwlockattr_destroy(&attributes);
+	}
+	~SharedMutexImpl() { pthread_rwlock_destroy(&_lock); }
+
+	void lock() { pthread_rwlock_wrlock(&_lock); }
+	void unlock() { pthread_rwlock_unlock(&_lock); }
+	bool tryLock() { return pthread_rwlock_trywrlock(&_lock) == 0; }
+
+	void lockShared() { pthread_rwlock_rdlock(&_lock); }
+	void unlockShared() { pthread_rwlock_unlock(&_lock); }
+	bool tryLockShared() { return pthread_rwlock_tryrdlock(&_lock) == 0; }
+
+private :
+    pthread_rwlock_t _lock; ///< pthread handle of the lock
+};
+
+} // namespace priv
+
+} // namespace df
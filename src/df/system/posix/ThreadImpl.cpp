@@ -1,24 +1,56 @@
-#include <df/system/win32/ThreadImpl.h>
+#include <df/system/posix/ThreadImpl.h>
 #include <df/system/Time.h>
 #include <df/system/Thread.h>
+#include <df/system/Mutex.h>
+#include <df/system/Timer.h>
 #include <cassert>
-#include <process.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sched.h>
+#include <unistd.h>
+#include <limits.h>
 #include <map>
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+#endif
+#if defined(DF_PLATFORM_FREEBSD)
+    #include <pthread_np.h>
+#endif
 
 namespace df
 {
 namespace priv
 {
 
-ThreadImpl::ThreadImpl(void (*functionPtr)(void *), void * userData):_threadId(0)
+ThreadImpl::ThreadImpl(void (*functionPtr)(void *), void * userData, const ThreadOptions& options):_isActive(false)
 {
 	_info.functionPtr = functionPtr;
 	_info.userData = userData;
-	if(pthread_create(&_thread, NULL, &entryPoint, _info) != 0)
+	_info.options = options;
+	if(options.name)
 	{
-		_thread = 0;
-		assert(false && "Failed to create thread");
+		strncpy(_info.name, options.name, sizeof(_info.name) - 1);
+		_info.name[sizeof(_info.name) - 1] = '\0';
+		_info.options.name = _info.name;
 	}
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	if(options.stackSize > 0)
+	{
+		// the size must be a multiple of the page size on some systems
+		const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+		size_t stackSize = (size_t(options.stackSize) + pageSize - 1) / pageSize * pageSize;
+		if(stackSize < size_t(PTHREAD_STACK_MIN)) {
+			stackSize = size_t(PTHREAD_STACK_MIN);
+		}
+		pthread_attr_setstacksize(&attributes, stackSize);
+	}
+	_isActive = (pthread_create(&_thread, &attributes, &entryPoint, &_info) == 0);
+	pthread_attr_destroy(&attributes);
+	assert(_isActive && "Failed to create thread");
 }
 
 ThreadImpl::~ThreadImpl()
@@ -28,24 +60,29 @@ ThreadImpl::~ThreadImpl()
 
 void ThreadImpl::join()
 {
-	if (_thread )
+	if (_isActive)
 	{	
 		assert( (pthread_equal(pthread_self(), _thread) == 0) && "A thread cannot join itself");
-		pthread_join(m_thread, NULL);
+		pthread_join(_thread, NULL);
+		_isActive = false;
 	}
 }
 
 uint32 ThreadImpl::getID()
 {
-	return _pthread_t_to_ID(mHandle);
-	return _threadId;
+	return pthread_t_to_ID(_thread);
 }
 
 void ThreadImpl::terminate()
 {
-	if (_thread)
+	if (_isActive)
 		pthread_cancel(_thread);
+}
 
+uint32 ThreadImpl::getHardwareConcurrency()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? uint32(count) : 1;
 }
 
 void* ThreadImpl::entryPoint(void* userData)
@@ -54,6 +91,17 @@ void* ThreadImpl::entryPoint(void* userData)
 	// Tell the thread to handle cancel requests immediately
 	pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
 
+	const ThreadOptions& options = info->options;
+	if(options.name) {
+		this_thread::setName(options.name);
+	}
+	if(options.affinityMask != 0) {
+		this_thread::setAffinity(options.affinityMask);
+	}
+	if(options.priority != ThreadOptions::PRIORITY_NORMAL) {
+		this_thread::setPriority(options.priority);
+	}
+
 	info->functionPtr(info->userData);
 	return NULL;
 }
@@ -78,18 +126,17 @@ namespace this_thread
 	{
 		struct timespec sleepTime;
 		struct timespec time_left_to_sleep;
-		int32 seconds = int32(time.asMicroseconds() / 1000000)
-		sleepTime.tv_sec = seconds;
-		sleepTime.tv_nsec = 1000*(time.asMicroseconds()-seconds*1000000);
+		int64 seconds = time.asNanoseconds() / 1000000000;
+		sleepTime.tv_sec = time_t(seconds);
+		sleepTime.tv_nsec = long(time.asNanoseconds() - seconds * 1000000000);
 		//sleepTime.tv_nsec = (tv.tv_usec + (usecs % 1000000)) * 1000;
 		//sleepTime.tv_sec = tv.tv_sec + (usecs / 1000000) + (ti.tv_nsec / 1000000000);
 		//sleepTime.tv_nsec %= 1000000000;
 
-		while( (sleepTime.tv_sec + sleepTime.tv_nec) > 0 )
+		// nanosleep may be interrupted by a signal, sleep again for the remaining time
+		while( nanosleep(&sleepTime, &time_left_to_sleep) == -1 && errno == EINTR )
 		{
-			nanosleep(&sleepTime, &time_left_to_sleep);
-			sleepTime.tv_sec = time_left_to_sleep.tv_sec;
-			sleepTime.tv_msec = time_left_to_sleep.tv_nsec;
+			sleepTime = time_left_to_sleep;
 		}
 
 		//ALT 1
@@ -128,8 +175,114 @@ namespace this_thread
 		*/
 	}
 
+	void sleepUntil(Time deadline)
+	{
+#if defined(DF_PLATFORM_OSX) || defined(DF_PLATFORM_IOS)
+		// no clock_nanosleep, and the timers do not use CLOCK_MONOTONIC: sleep for the remaining time
+		const Time remaining = deadline - Timer::getCurrentTime();
+		if(remaining > Time()) {
+			sleep(remaining);
+		}
+#else
+		// same clock as TimerImpl
+		struct timespec wakeUpTime;
+		const int64 nanoseconds = deadline.asNanoseconds();
+		if(nanoseconds <= 0) {
+			return;
+		}
+		wakeUpTime.tv_sec = time_t(nanoseconds / 1000000000);
+		wakeUpTime.tv_nsec = long(nanoseconds % 1000000000);
+		// an absolute deadline: interrupted by a signal, sleep again until the same time
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeUpTime, NULL) == EINTR) {}
+#endif
+	}
+
 	void yield(){  sched_yield(); }
 	uint32 getID() { return priv::pthread_t_to_ID(pthread_self());}
+
+	uint32 getCurrentCPU()
+	{
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+		const int cpu = sched_getcpu();
+		return (cpu >= 0) ? uint32(cpu) : 0;
+#else
+		return 0;
+#endif
+	}
+
+	uint32 getHardwareConcurrency() { return priv::ThreadImpl::getHardwareConcurrency(); }
+
+	bool setAffinity(uint64 affinityMask)
+	{
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for(uint32 cpu = 0; cpu < 64; ++cpu)
+		{
+			if(affinityMask & (uint64(1) << cpu)) {
+				CPU_SET(cpu, &cpus);
+			}
+		}
+		return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#elif defined(DF_PLATFORM_FREEBSD)
+		cpuset_t cpus;
+		CPU_ZERO(&cpus);
+		for(uint32 cpu = 0; cpu < 64; ++cpu)
+		{
+			if(affinityMask & (uint64(1) << cpu)) {
+				CPU_SET(cpu, &cpus);
+			}
+		}
+		return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+		// OSX only has affinity hints between threads, not cpu pinning
+		(void) affinityMask;
+		return false;
+#endif
+	}
+
+	bool setName(const char* name)
+	{
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+		// the kernel keeps 15 characters
+		char shortName[16];
+		strncpy(shortName, name, sizeof(shortName) - 1);
+		shortName[sizeof(shortName) - 1] = '\0';
+		return pthread_setname_np(pthread_self(), shortName) == 0;
+#elif defined(DF_PLATFORM_OSX) || defined(DF_PLATFORM_IOS) || defined(DF_PLATFORM_IOS_SIM)
+		return pthread_setname_np(name) == 0;
+#elif defined(DF_PLATFORM_FREEBSD)
+		pthread_set_name_np(pthread_self(), name);
+		return true;
+#else
+		(void) name;
+		return false;
+#endif
+	}
+
+	bool setPriority(ThreadOptions::Priority priority)
+	{
+		sched_param parameters;
+		memset(&parameters, 0, sizeof(parameters));
+		if(priority == ThreadOptions::PRIORITY_REALTIME)
+		{
+			parameters.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+			return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0;
+		}
+#if defined(DF_PLATFORM_LINUX) || defined(DF_PLATFORM_ANDROID)
+		// SCHED_OTHER has a single static priority: use the nice value, which Linux applies per thread
+		static const int niceValues[] = { 19, 10, 0, -5, -10 };
+		if(pthread_setschedparam(pthread_self(), SCHED_OTHER, &parameters) != 0) {
+			return false;
+		}
+		return setpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)), niceValues[priority]) == 0;
+#else
+		const int minPriority = sched_get_priority_min(SCHED_OTHER);
+		const int maxPriority = sched_get_priority_max(SCHED_OTHER);
+		parameters.sched_priority = minPriority + (maxPriority - minPriority) * int(priority) / int(ThreadOptions::PRIORITY_HIGHEST);
+		return pthread_setschedparam(pthread_self(), SCHED_OTHER, &parameters) == 0;
+#endif
+	}
 }
 } // namespace df
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <df/platform.h>
 #include <df/system/NonCopyable.h>
+#include <df/system/Thread.h>
 #include <pthread.h>
 
 namespace df
@@ -8,28 +9,36 @@ namespace df
 namespace priv
 {
 
-/// windows thread implementation
+/// posix thread implementation
 class ThreadImpl : NonCopyable
 {
 public:
-    ThreadImpl( void (*functionPtr)(void *), void * userData );
+    ThreadImpl( void (*functionPtr)(void *), void * userData, const ThreadOptions& options );
     ~ThreadImpl();
 
 	void join();
     uint32 getID();
-	void terminate()
+	void terminate();
+
+	/// return the number of hardware threads
+	static uint32 getHardwareConcurrency();
+
+	/// usual delay between a sleep deadline and the wake up (timer slack and scheduling, about 60 us on an idle Linux)
+	static Time getSleepLatency() { return microseconds(100); }
 private:
 	pthread_t _thread; ///< posix thread handle
-	uint32 _threadId; ///<  thread identifier
+	bool _isActive;    ///< false if the thread creation failed or if the thread has been joined
 	
 	struct ThreadStartInfo {
 		void (*functionPtr)(void *); ///< Pointer to the function to be executed.
 		void * userData;            ///< Function argument for the thread function.
+		ThreadOptions options;      ///< applied by the thread itself, options.name points to name
+		char name[64];
 	} _info;
 	static void* entryPoint(void* userData);	
 };
 
-static uint32 pthread_t_to_ID(const pthread_t &handle);
+uint32 pthread_t_to_ID(const pthread_t &handle);
 
 } // namespace priv
 } // namespace df
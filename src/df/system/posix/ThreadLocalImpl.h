@@ -0,0 +1,34 @@
+#pragma once
+
+#include <df/system/NonCopyable.h>
+#include <pthread.h>
+#include <cassert>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Unix implementation of a thread local slot, with a destructor called at thread exit
+class ThreadLocalImpl : NonCopyable
+{
+public :
+	explicit ThreadLocalImpl(void (*destructor)(void*))
+	{
+		const int result = pthread_key_create(&_key, destructor);
+		assert(result == 0 && "Failed to create a thread local key");
+		(void) result;
+	}
+	/// the destructor is not called for the values still set
+	~ThreadLocalImpl() { pthread_key_delete(_key); }
+
+	void* getValue() const { return pthread_getspecific(_key); }
+	void setValue(void* value) { pthread_setspecific(_key, value); }
+
+private :
+	pthread_key_t _key; ///< pthread key of the slot
+};
+
+} // namespace priv
+
+} // namespace df
@@ -23,14 +23,14 @@ public :
 		static mach_timebase_info_data_t frequency = {0, 0};
 		if (frequency.denom == 0)
 			mach_timebase_info(&frequency);
-		Uint64 nanoseconds = mach_absolute_time() * frequency.numer / frequency.denom;
-		return df::microseconds(nanoseconds / 1000);
+		uint64 nanoseconds = mach_absolute_time() * frequency.numer / frequency.denom;
+		return df::nanoseconds(nanoseconds);
 
 	#else
 		// POSIX implementation
 		timespec time;
 		clock_gettime(CLOCK_MONOTONIC, &time);
-		return df::microseconds(static_cast<uint64>(time.tv_sec) * 1000000 + time.tv_nsec / 1000);
+		return df::nanoseconds(static_cast<int64>(time.tv_sec) * 1000000000 + time.tv_nsec);
 	#endif
 	}
 };
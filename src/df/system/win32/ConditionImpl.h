@@ -0,0 +1,51 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <df/system/Time.h>
+#include <windows.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Windows implementation of a condition variable, with its own mutex (requires Vista)
+/// The mutex must be locked around wait and around the modification of the waited state.
+class ConditionImpl : NonCopyable
+{
+public :
+	ConditionImpl()
+	{
+		InitializeCriticalSection(&_mutex);
+		InitializeConditionVariable(&_condition);
+	}
+	~ConditionImpl() { DeleteCriticalSection(&_mutex); }
+
+	void lock() { EnterCriticalSection(&_mutex); }
+	void unlock() { LeaveCriticalSection(&_mutex); }
+
+	void wait() { SleepConditionVariableCS(&_condition, &_mutex, INFINITE); }
+
+	/// return false if the timeout expired before a notification (spurious wake ups are possible)
+	bool wait(Time timeout)
+	{
+		if(timeout <= Time()) {
+			return false;
+		}
+		// round up, a zero timeout would not wait at all
+		const DWORD milliseconds = DWORD((timeout.asNanoseconds() + 999999) / 1000000);
+		return SleepConditionVariableCS(&_condition, &_mutex, milliseconds) || GetLastError() != ERROR_TIMEOUT;
+	}
+
+	void notifyOne() { WakeConditionVariable(&_condition); }
+	void notifyAll() { WakeAllConditionVariable(&_condition); }
+
+private :
+	CRITICAL_SECTION _mutex;
+	CONDITION_VARIABLE _condition;
+};
+
+} // namespace priv
+
+} // namespace df
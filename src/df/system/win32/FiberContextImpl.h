@@ -0,0 +1,75 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <windows.h>
+#include <cassert>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Windows implementation of an execution context (registers and stack) of a fiber
+/// Uses the native fibers: the system allocates the stacks (reserved, committed on demand,
+/// with a guard page) and SwitchToFiber saves the registers and the exception chain.
+class FiberContextImpl : NonCopyable
+{
+public :
+	FiberContextImpl():_fiber(NULL), _isThread(false), _entry(NULL), _argument(NULL) {}
+	~FiberContextImpl() { destroy(); }
+
+	/// the calling thread is about to switch to fibers, this context will hold its state
+	void initializeFromThread()
+	{
+		_fiber = ConvertThreadToFiber(NULL);
+		assert(_fiber != NULL && "Failed to convert the thread to a fiber");
+		_isThread = true;
+	}
+	void releaseFromThread()
+	{
+		ConvertFiberToThread();
+		_fiber = NULL;
+		_isThread = false;
+	}
+
+	/// a new fiber on which entry(argument) will run, entry must never return
+	void create(uint32 stackSize, void (*entry)(void*), void* argument)
+	{
+		_entry = entry;
+		_argument = argument;
+		_fiber = CreateFiberEx(stackSize, stackSize, FIBER_FLAG_FLOAT_SWITCH, &startFiber, this);
+		assert(_fiber != NULL && "Failed to create a fiber");
+	}
+
+	void destroy()
+	{
+		if(_fiber && !_isThread)
+		{
+			DeleteFiber(_fiber);
+			_fiber = NULL;
+		}
+	}
+
+	/// save the calling context in from and resume to
+	static void switchTo(FiberContextImpl&, FiberContextImpl& to)
+	{
+		SwitchToFiber(to._fiber);
+	}
+
+private :
+	static VOID WINAPI startFiber(LPVOID parameter)
+	{
+		FiberContextImpl* context = (FiberContextImpl*) parameter;
+		context->_entry(context->_argument);
+	}
+
+	LPVOID _fiber;
+	bool _isThread; ///< the fiber was converted from a thread, it is not deleted
+	void (*_entry)(void*);
+	void* _argument;
+};
+
+} // namespace priv
+
+} // namespace df
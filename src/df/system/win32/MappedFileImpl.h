@@ -0,0 +1,91 @@
+#pragma once
+
+#include <df/platform.h>
+#include <df/system/NonCopyable.h>
+#include <windows.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Windows implementation of memory mapped files
+class MappedFileImpl : NonCopyable
+{
+public :
+	MappedFileImpl():_file(INVALID_HANDLE_VALUE), _mapping(0), _data(0), _size(0), _isWritable(false) {}
+	~MappedFileImpl()
+	{
+		unmap();
+		if(_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+	}
+
+	bool open(const char* path, bool isWritable)
+	{
+		_isWritable = isWritable;
+		_file = CreateFileA(path, isWritable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ, NULL,
+			isWritable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(_file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(_file, &size)) {
+			return false;
+		}
+		_size = (uint64) size.QuadPart;
+		return map();
+	}
+
+	void* getData() const { return _data; }
+	uint64 getSize() const { return _size; }
+
+	bool resize(uint64 size)
+	{
+		// the file cannot be resized while it is mapped
+		unmap();
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG) size;
+		if(!SetFilePointerEx(_file, position, NULL, FILE_BEGIN) || !SetEndOfFile(_file))
+		{
+			map(); // keep the previous mapping
+			return false;
+		}
+		_size = size;
+		return map();
+	}
+
+	bool flush() { return _data == 0 || (FlushViewOfFile(_data, 0) && FlushFileBuffers(_file)); }
+
+private :
+	bool map()
+	{
+		// an empty file cannot be mapped
+		if(_size == 0) {
+			return true;
+		}
+		_mapping = CreateFileMappingA(_file, NULL, _isWritable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+		if(_mapping == NULL) {
+			return false;
+		}
+		_data = MapViewOfFile(_mapping, _isWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+		return _data != NULL;
+	}
+
+	void unmap()
+	{
+		if(_data) UnmapViewOfFile(_data);
+		if(_mapping) CloseHandle(_mapping);
+		_data = 0;
+		_mapping = 0;
+	}
+
+	HANDLE _file;     ///< file handle
+	HANDLE _mapping;  ///< file mapping object
+	void* _data;      ///< start of the view
+	uint64 _size;     ///< size of the file (and of the view)
+	bool _isWritable;
+};
+
+} // namespace priv
+
+} // namespace df
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <df/system/NonCopyable.h>
+#include <windows.h>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Windows implementation of reader-writer locks (slim reader-writer lock, requires Windows 7)
+class SharedMutexImpl : NonCopyable
+{
+public :
+	SharedMutexImpl() { InitializeSRWLock(&_lock); }
+	~SharedMutexImpl() {}
+
+	void lock() { AcquireSRWLockExclusive(&_lock); }
+	void unlock() { ReleaseSRWLockExclusive(&_lock); }
+	bool tryLock() { return TryAcquireSRWLockExclusive(&_lock) != 0; }
+
+	void lockShared() { AcquireSRWLockShared(&_lock); }
+	void unlockShared() { ReleaseSRWLockShared(&_lock); }
+	bool tryLockShared() { return TryAcquireSRWLockShared(&_lock) != 0; }
+
+private :
+	SRWLOCK _lock;
+};
+
+} // namespace priv
+
+} // namespace df
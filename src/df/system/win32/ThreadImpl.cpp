@@ -1,20 +1,36 @@
 #include <df/system/win32/ThreadImpl.h>
 #include <df/system/Time.h>
 #include <df/system/Thread.h>
+#include <df/system/Timer.h>
 #include <cassert>
+#include <cstring>
 #include <process.h>
 
+// missing from the SDKs before Windows 10 1803, ignored by the older systems
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 namespace df
 {
 namespace priv
 {
 
-ThreadImpl::ThreadImpl(void (*functionPtr)(void *), void * userData):_threadId(0)
+ThreadImpl::ThreadImpl(void (*functionPtr)(void *), void * userData, const ThreadOptions& options):_threadId(0)
 {
 	_info.functionPtr = functionPtr;
 	_info.userData = userData;
+	_info.options = options;
+	if(options.name)
+	{
+		strncpy(_info.name, options.name, sizeof(_info.name) - 1);
+		_info.name[sizeof(_info.name) - 1] = '\0';
+		_info.options.name = _info.name;
+	}
 
-	_thread = reinterpret_cast<HANDLE>(_beginthreadex(NULL, 0, entryPoint, &_info, 0, &_threadId));
+	// reserve the stack size instead of committing it
+	const unsigned int flags = (options.stackSize > 0) ? STACK_SIZE_PARAM_IS_A_RESERVATION : 0;
+	_thread = reinterpret_cast<HANDLE>(_beginthreadex(NULL, options.stackSize, entryPoint, &_info, flags, &_threadId));
 	assert(_thread != NULL && "Failed to create thread");
 }
 
@@ -44,9 +60,26 @@ void ThreadImpl::terminate()
 		TerminateThread(_thread, 0);
 }
 
+uint32 ThreadImpl::getHardwareConcurrency()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? uint32(info.dwNumberOfProcessors) : 1;
+}
+
 unsigned int __stdcall ThreadImpl::entryPoint(void* userData)
 {
 	ThreadStartInfo* info = (ThreadStartInfo*) userData;
+	const ThreadOptions& options = info->options;
+	if(options.name) {
+		this_thread::setName(options.name);
+	}
+	if(options.affinityMask != 0) {
+		this_thread::setAffinity(options.affinityMask);
+	}
+	if(options.priority != ThreadOptions::PRIORITY_NORMAL) {
+		this_thread::setPriority(options.priority);
+	}
 	info->functionPtr(info->userData);
 	return 0;
 }
@@ -55,9 +88,77 @@ unsigned int __stdcall ThreadImpl::entryPoint(void* userData)
 
 namespace this_thread 
 {
-	void sleep(Time time) {  ::Sleep( (DWORD)(time.asMicroseconds()/1000)); }
+	void sleep(Time time) {  ::Sleep( (DWORD)(time.asNanoseconds()/1000000)); }
+	void sleepUntil(Time deadline)
+	{
+		// waitable timers take a relative due time in 100 ns units, the high resolution ones
+		// (Windows 10 1803) are not bound to the 1 to 15.6 ms resolution of the system timer
+		HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_MANUAL_RESET | CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if(!timer) {
+			timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_MANUAL_RESET, TIMER_ALL_ACCESS);
+		}
+		for(;;)
+		{
+			const Time remaining = deadline - Timer::getCurrentTime();
+			if(remaining <= Time()) {
+				break;
+			}
+			if(!timer)
+			{
+				::Sleep((DWORD)((remaining.asNanoseconds() + 999999) / 1000000));
+				continue;
+			}
+			LARGE_INTEGER dueTime;
+			dueTime.QuadPart = -((remaining.asNanoseconds() + 99) / 100);
+			SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE);
+			WaitForSingleObject(timer, INFINITE);
+		}
+		if(timer) {
+			CloseHandle(timer);
+		}
+	}
+
 	void yield(){  ::Sleep(0); }
 	uint32 getID() { return (uint32) GetCurrentThreadId(); }
+
+	uint32 getCurrentCPU() { return (uint32) GetCurrentProcessorNumber(); }
+
+	uint32 getHardwareConcurrency() { return priv::ThreadImpl::getHardwareConcurrency(); }
+
+	bool setAffinity(uint64 affinityMask)
+	{
+		return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) affinityMask) != 0;
+	}
+
+	bool setName(const char* name)
+	{
+		// the name is given to the attached debugger through a special exception (MSDN "How to: Set a Thread Name")
+#pragma pack(push, 8)
+		struct ThreadNameInfo
+		{
+			DWORD type;     // must be 0x1000
+			LPCSTR name;
+			DWORD threadId; // -1 for the calling thread
+			DWORD flags;
+		};
+#pragma pack(pop)
+		ThreadNameInfo info = { 0x1000, name, DWORD(-1), 0 };
+		__try
+		{
+			RaiseException(0x406D1388, 0, sizeof(info) / sizeof(ULONG_PTR), (ULONG_PTR*) &info);
+		}
+		__except(EXCEPTION_EXECUTE_HANDLER)
+		{
+		}
+		return true;
+	}
+
+	bool setPriority(ThreadOptions::Priority priority)
+	{
+		static const int priorities[] = { THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+			THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, THREAD_PRIORITY_TIME_CRITICAL };
+		return SetThreadPriority(GetCurrentThread(), priorities[priority]) != 0;
+	}
 }
 } // namespace df
 
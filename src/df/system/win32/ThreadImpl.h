@@ -1,6 +1,7 @@
 #pragma once
 #include <df/platform.h>
 #include <df/system/NonCopyable.h>
+#include <df/system/Thread.h>
 #include <windows.h>
 
 namespace df
@@ -12,12 +13,18 @@ namespace priv
 class ThreadImpl : NonCopyable
 {
 public:
-    ThreadImpl( void (*functionPtr)(void *), void * userData );
+    ThreadImpl( void (*functionPtr)(void *), void * userData, const ThreadOptions& options );
     ~ThreadImpl();
 
 	void join();
     uint32 getID();
 	void terminate();
+
+	/// return the number of hardware threads
+	static uint32 getHardwareConcurrency();
+
+	/// usual delay between a sleep deadline and the wake up (timer resolution of the waitable timers and scheduling quantum)
+	static Time getSleepLatency() { return microseconds(2000); }
 private:
 	HANDLE _thread; ///< Win32 thread handle
 	uint32 _threadId; ///< Win32 thread identifier
@@ -25,6 +32,8 @@ private:
 	struct ThreadStartInfo {
 		void (*functionPtr)(void *); ///< Pointer to the function to be executed.
 		void * userData;            ///< Function argument for the thread function.
+		ThreadOptions options;      ///< applied by the thread itself, options.name points to name
+		char name[64];
 	} _info;
 	static unsigned int __stdcall entryPoint(void* userData);
 };
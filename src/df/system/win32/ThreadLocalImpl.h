@@ -0,0 +1,52 @@
+#pragma once
+
+#include <df/system/NonCopyable.h>
+#include <windows.h>
+#include <cassert>
+
+namespace df
+{
+namespace priv
+{
+
+/// \brief Windows implementation of a thread local slot, with a destructor called at thread exit
+/// Fiber local storage is used instead of TlsAlloc because only it calls a destructor, so a slot
+/// is per fiber: each fiber of a thread has its own value, destroyed when the fiber is deleted
+/// (or when the thread exits, for the fiber converted from the thread).
+/// The callback does not receive any context: all the slots share the same destructor.
+class ThreadLocalImpl : NonCopyable
+{
+public :
+	explicit ThreadLocalImpl(void (*destructor)(void*))
+	{
+		assert((getDestructor() == NULL || getDestructor() == destructor) && "All the thread local slots must share the same destructor");
+		getDestructor() = destructor;
+		_index = FlsAlloc(&callback);
+		assert(_index != FLS_OUT_OF_INDEXES && "Failed to allocate a fiber local index");
+	}
+	/// FlsFree calls the destructor for the values still set
+	~ThreadLocalImpl() { FlsFree(_index); }
+
+	void* getValue() const { return FlsGetValue(_index); }
+	void setValue(void* value) { FlsSetValue(_index, value); }
+
+private :
+	typedef void (*Destructor)(void*);
+	static Destructor& getDestructor()
+	{
+		static Destructor destructor = NULL;
+		return destructor;
+	}
+	static VOID WINAPI callback(PVOID value)
+	{
+		if(value) {
+			getDestructor()(value);
+		}
+	}
+
+	DWORD _index; ///< fiber local storage index
+};
+
+} // namespace priv
+
+} // namespace df
@@ -45,8 +45,10 @@ public :
 		SetThreadAffinityMask(currentThread, previousMask);
 	#endif
 
-		// Return the current time as microseconds
-		return df::microseconds(1000000 * time.QuadPart / frequency.QuadPart);
+		// Return the current time as nanoseconds (whole seconds first, time * 10^9 would overflow)
+		const int64 seconds = time.QuadPart / frequency.QuadPart;
+		const int64 remainder = time.QuadPart % frequency.QuadPart;
+		return df::nanoseconds(seconds * 1000000000 + remainder * 1000000000 / frequency.QuadPart);
 	}
 
 };
@@ -125,13 +125,13 @@ TEST(check_insert_remove)
 	CHECK(array1[5] == 6);
 	array1.remove(5, 4);
 	CHECK(array1.size() == 5);
-	for(size_t i = 0; i<5; ++i)
+	for(uint32_t i = 0; i<5; ++i)
 	{
 		CHECK(array1[i] == i);
 	}
 
 	array1.unsorted_remove(1);
-	for(size_t i = 0; i<array1.size(); ++i)
+	for(uint32_t i = 0; i<array1.size(); ++i)
 	{
 		CHECK(array1[i] != 1);
 	}
@@ -0,0 +1,126 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+
+#include <df/system/ArrayOps.h>
+
+namespace {
+
+TEST(check_array_view)
+{
+	df::Array<int> array1;
+	for(int i = 0; i<10; ++i)
+	{
+		array1.push_back(i);
+	}
+	df::ArrayView<int> view(array1);
+	CHECK(view.size() == 10);
+	CHECK(view[3] == 3);
+	df::ArrayView<const int> sub = view.sub(2, 5);
+	CHECK(sub.size() == 5);
+	CHECK(sub[0] == 2);
+}
+
+TEST(check_array_ops_fill)
+{
+	df::Array<float, 32> array1;
+	array1.resize(1001);
+	df::fill(array1, 2.5f);
+	CHECK(df::count(array1, 2.5f) == 1001);
+
+	// unaligned range
+	df::Array<int> array2;
+	array2.resize(100, 1);
+	df::fill(df::ArrayView<int>(array2).sub(3, 50), 7);
+	CHECK(df::count(df::ArrayView<const int>(array2), 7) == 50);
+	CHECK(array2[2] == 1 && array2[3] == 7 && array2[52] == 7 && array2[53] == 1);
+}
+
+TEST(check_array_ops_find_count)
+{
+	df::Array<int, 32> array1;
+	for(int i = 0; i<1000; ++i)
+	{
+		array1.push_back(i % 10);
+	}
+	CHECK(df::find(array1, 7) == 7);
+	CHECK(df::find(array1, 42) == df::npos);
+	CHECK(df::count(array1, 3) == 100);
+
+	df::ArrayView<const int> view = df::ArrayView<const int>(array1).sub(1, 998);
+	CHECK(df::find(view, 0) == 9);
+	CHECK(df::count(view, 0) == 99);
+
+	df::Array<double> array2;
+	array2.resize(37, 1.0);
+	array2[33] = 2.0;
+	CHECK(df::find(array2, 2.0) == 33);
+}
+
+TEST(check_array_ops_reductions)
+{
+	df::Array<int, 32> ints;
+	df::Array<float, 32> floats;
+	df::Array<double> doubles;
+	for(int i = 0; i<1003; ++i)
+	{
+		ints.push_back(i - 500);
+		floats.push_back(float(i % 7));
+		doubles.push_back(double(1003 - i));
+	}
+	CHECK(df::minValue(ints) == -500);
+	CHECK(df::maxValue(ints) == 502);
+	CHECK(df::sum(ints) == 1003);
+	CHECK(df::minValue(floats) == 0.f);
+	CHECK(df::maxValue(floats) == 6.f);
+	CHECK_CLOSE(3004.f, df::sum(floats), 0.01f);
+	CHECK(df::minValue(doubles) == 1.0);
+	CHECK(df::maxValue(doubles) == 1003.0);
+	CHECK(df::sum(df::ArrayView<const double>(doubles).sub(1, 2)) == 1002.0 + 1001.0);
+}
+
+TEST(check_array_ops_copy_equal)
+{
+	df::Array<int> array1;
+	for(int i = 0; i<100; ++i)
+	{
+		array1.push_back(i);
+	}
+	df::Array<int, 32> array2;
+	df::copy(array2, array1);
+	CHECK(df::equal(array1, array2));
+	array2[99] = 0;
+	CHECK(!df::equal(array1, array2));
+
+	df::Array<int> array3(array1);
+	CHECK(df::equal(df::ArrayView<int>(array1), df::ArrayView<const int>(array3)));
+
+	// bulk insert path
+	array3.insert(5, 10, 20);
+	CHECK(array3.size() == 120);
+	CHECK(df::count(array3, 5) == 21);
+	CHECK(array3[9] == 9 && array3[10] == 5 && array3[30] == 10);
+	array3.insert(array1.begin(), 0, 3);
+	CHECK(array3.size() == 123);
+	CHECK(array3[0] == 0 && array3[2] == 2 && array3[3] == 0);
+}
+
+TEST(check_array_ops_copy_convert)
+{
+	df::Array<int> ints;
+	for(int i = 0; i<37; ++i)
+	{
+		ints.push_back(i - 10);
+	}
+	df::Array<float> floats;
+	floats.resize(ints.size());
+	df::copy(df::ArrayView<float>(floats), df::ArrayView<const int>(ints));
+	CHECK(floats[0] == -10.0f && floats[36] == 26.0f);
+
+	floats[1] = 0.5f;
+	df::Array<double> doubles;
+	doubles.resize(floats.size());
+	df::copy(df::ArrayView<double>(doubles), df::ArrayView<float>(floats));
+	CHECK(doubles[0] == -10.0 && doubles[1] == 0.5 && doubles[36] == 26.0);
+}
+
+}
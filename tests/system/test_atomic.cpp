@@ -0,0 +1,120 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+
+namespace {
+
+TEST(check_atomic)
+{
+	df::Atomic<df::uint32> value(5);
+	CHECK(value.load() == 5);
+	value.store(7, df::MEMORY_ORDER_RELEASE);
+	CHECK(value.load(df::MEMORY_ORDER_ACQUIRE) == 7);
+	CHECK(value.exchange(9) == 7);
+	CHECK(value.fetchAdd(3) == 9);
+	CHECK(value.fetchSub(2, df::MEMORY_ORDER_RELAXED) == 12);
+	CHECK(value.fetchOr(0x30) == 10);
+	CHECK(value.fetchAnd(0x3A) == 0x3A);
+	CHECK(value.fetchXor(0x0F) == 0x3A);
+	CHECK(value.load() == 0x35);
+
+	df::uint32 expected = 1;
+	CHECK(!value.compareExchange(expected, 2));
+	CHECK(expected == 0x35);
+	CHECK(value.compareExchange(expected, 2, df::MEMORY_ORDER_ACQ_REL));
+	CHECK(value.load() == 2);
+	expected = 2;
+	while(!value.compareExchangeWeak(expected, 3)) {}
+	CHECK(value.load() == 3);
+
+	df::Atomic<df::int64> wide(-1);
+	CHECK(wide.fetchAdd(df::int64(1) << 40) == -1);
+	CHECK(wide.load() == (df::int64(1) << 40) - 1);
+
+	int array[4] = { 0, 1, 2, 3 };
+	df::Atomic<int*> pointer(array);
+	CHECK(pointer.fetchAdd(2) == array);
+	CHECK(*pointer.load() == 2);
+	CHECK(pointer.fetchSub(1) == array + 2);
+	CHECK(pointer.load() == array + 1);
+	int* expectedPointer = array + 1;
+	CHECK(pointer.compareExchange(expectedPointer, array + 3));
+	CHECK(*pointer.load() == 3);
+
+	df::PaddedAtomic<df::uint32> padded[2];
+	CHECK(sizeof(padded[0]) >= 2 * DF_CACHE_LINE_SIZE);
+	CHECK((char*)&padded[1] - (char*)&padded[0] >= DF_CACHE_LINE_SIZE);
+	CHECK(padded[1].fetchAdd(1) == 0 && padded[1].load() == 1);
+}
+
+const int NUM_THREAD = 4;
+const int NUM_INCREMENT = 100000;
+
+struct Counters
+{
+	df::PaddedAtomic<df::uint32> total;
+	df::PaddedAtomic<df::uint64> sum;
+};
+
+void addCounters(void* userData)
+{
+	Counters* counters = (Counters*) userData;
+	for(int i = 1; i <= NUM_INCREMENT; ++i)
+	{
+		counters->total.fetchAdd(1, df::MEMORY_ORDER_RELAXED);
+		counters->sum.fetchAdd(df::uint64(i));
+	}
+}
+
+/// release / acquire: the message is visible once the flag is
+struct Message
+{
+	int payload;
+	df::Atomic<df::uint32> isReady;
+	df::Atomic<df::uint32> errorCount;
+};
+
+void sendMessage(void* userData)
+{
+	Message* message = (Message*) userData;
+	message->payload = 42;
+	message->isReady.store(1, df::MEMORY_ORDER_RELEASE);
+}
+
+void receiveMessage(void* userData)
+{
+	Message* message = (Message*) userData;
+	while(!message->isReady.load(df::MEMORY_ORDER_ACQUIRE)) {
+		df::this_thread::yield();
+	}
+	if(message->payload != 42) {
+		message->errorCount.fetchAdd(1);
+	}
+}
+
+TEST(check_atomic_threads)
+{
+	Counters counters;
+	df::Thread* threads[NUM_THREAD];
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		threads[i] = new df::Thread(&addCounters, &counters);
+	}
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		delete threads[i];
+	}
+	CHECK(counters.total.load() == NUM_THREAD * NUM_INCREMENT);
+	CHECK(counters.sum.load() == df::uint64(NUM_THREAD) * NUM_INCREMENT * (NUM_INCREMENT + 1) / 2);
+
+	for(int i = 0; i < 50; ++i)
+	{
+		Message message;
+		message.payload = 0;
+		df::Thread receiver(&receiveMessage, &message);
+		df::Thread sender(&sendMessage, &message);
+		receiver.join();
+		CHECK(message.errorCount.load() == 0);
+	}
+}
+
+}
@@ -0,0 +1,127 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+
+#include <df/system/BitArray.h>
+
+namespace {
+
+TEST(check_bit_array_constructor)
+{
+	df::BitArray bits1;
+	CHECK(bits1.size() == 0);
+	CHECK(bits1.none());
+
+	df::BitArray bits2(130, true);
+	CHECK(bits2.size() == 130);
+	CHECK(bits2.word_count() == 3);
+	CHECK(bits2.count() == 130);
+	// unused bits of the last word must stay cleared
+	CHECK(bits2.words()[2] == 3);
+}
+
+TEST(check_bit_array_set_test)
+{
+	df::BitArray bits(200);
+	bits.set(0);
+	bits.set(63);
+	bits.set(64);
+	bits.set(199);
+	CHECK(bits.test(0));
+	CHECK(bits[63]);
+	CHECK(bits[64]);
+	CHECK(!bits[65]);
+	CHECK(bits.count() == 4);
+	bits.reset(63);
+	bits.flip(65);
+	CHECK(!bits[63]);
+	CHECK(bits[65]);
+	CHECK(bits.count() == 4);
+}
+
+TEST(check_bit_array_push_back)
+{
+	df::BitArray bits;
+	for(uint32_t i = 0; i<1000; ++i)
+	{
+		bits.push_back(i % 3 == 0);
+	}
+	CHECK(bits.size() == 1000);
+	CHECK(bits.count() == 334);
+	for(uint32_t i = 0; i<1000; ++i)
+	{
+		CHECK(bits[i] == (i % 3 == 0));
+	}
+}
+
+TEST(check_bit_array_fill)
+{
+	df::BitArray bits(300);
+	bits.fill(10, 5, true);
+	CHECK(bits.count() == 5);
+	bits.fill(60, 150, true);
+	CHECK(bits.count() == 155);
+	CHECK(!bits[59] && bits[60] && bits[209] && !bits[210]);
+	bits.fill(62, 4, false);
+	CHECK(bits.count() == 151);
+	bits.set_all();
+	CHECK(bits.count() == 300);
+	bits.reset_all();
+	CHECK(bits.none());
+
+	bits.resize(400, true);
+	CHECK(bits.count() == 100);
+	bits.resize(350);
+	CHECK(bits.count() == 50);
+}
+
+TEST(check_bit_array_find)
+{
+	df::BitArray bits(1000);
+	CHECK(bits.find_first() == df::BitArray::npos);
+	bits.set(5);
+	bits.set(64);
+	bits.set(700);
+	CHECK(bits.find_first() == 5);
+	CHECK(bits.find_next(6) == 64);
+	CHECK(bits.find_next(64) == 64);
+	CHECK(bits.find_next(65) == 700);
+	CHECK(bits.find_next(701) == df::BitArray::npos);
+
+	uint32_t count = 0;
+	for(uint32_t idx = bits.find_first(); idx != df::BitArray::npos; idx = bits.find_next(idx+1))
+	{
+		++count;
+	}
+	CHECK(count == 3);
+}
+
+TEST(check_bit_array_logic)
+{
+	const uint32_t size = 10007;
+	df::BitArray a(size);
+	df::BitArray b(size);
+	for(uint32_t i = 0; i<size; ++i)
+	{
+		a.set(i, i % 2 == 0);
+		b.set(i, i % 3 == 0);
+	}
+	df::BitArray andBits(a);
+	andBits &= b;
+	df::BitArray orBits(a);
+	orBits |= b;
+	df::BitArray xorBits(a);
+	xorBits ^= b;
+
+	uint32_t expectedAnd = 0, expectedOr = 0, expectedXor = 0;
+	for(uint32_t i = 0; i<size; ++i)
+	{
+		expectedAnd += (i % 2 == 0) && (i % 3 == 0);
+		expectedOr += (i % 2 == 0) || (i % 3 == 0);
+		expectedXor += (i % 2 == 0) != (i % 3 == 0);
+	}
+	CHECK(andBits.count() == expectedAnd);
+	CHECK(orBits.count() == expectedOr);
+	CHECK(xorBits.count() == expectedXor);
+}
+
+}
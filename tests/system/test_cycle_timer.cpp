@@ -0,0 +1,67 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/CycleTimer.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <cstdio>
+
+namespace {
+
+TEST(check_cycle_timer)
+{
+	printf("CycleTimer: %s, %.3f MHz\n", df::CycleTimer::isTscUsed() ? "tsc" : "monotonic clock",
+		df::CycleTimer::getFrequency() / 1000000.0);
+	CHECK(df::CycleTimer::getFrequency() > 0);
+
+	// monotonic
+	df::uint64 previous = df::CycleTimer::getCurrentCycles();
+	for(int i = 0; i < 1000; ++i)
+	{
+		const df::uint64 now = (i % 2) ? df::CycleTimer::getCurrentCycles() : df::CycleTimer::getCurrentCyclesSerialized();
+		CHECK(now >= previous);
+		previous = now;
+	}
+
+	// agrees with Timer
+	df::Timer timer;
+	df::CycleTimer cycleTimer;
+	df::this_thread::sleep(df::milliseconds(50));
+	const df::Time cycleTime = cycleTimer.getElapsedTime();
+	const df::Time time = timer.getElapsedTime();
+	const df::Time difference = (cycleTime > time) ? cycleTime - time : time - cycleTime;
+	CHECK(difference < time / 100 + df::microseconds(100));
+	CHECK(cycleTime >= df::milliseconds(50));
+
+	const df::int64 nanoseconds = cycleTimer.getElapsedNanoseconds();
+	CHECK(nanoseconds >= 50000000);
+	CHECK(cycleTimer.getElapsedTime() >= df::nanoseconds(nanoseconds));
+	CHECK_EQUAL(df::int64(0), df::CycleTimer::toNanoseconds(0));
+	CHECK(cycleTimer.restart() >= df::milliseconds(50));
+	CHECK(cycleTimer.getElapsedTime() < df::milliseconds(50));
+}
+
+TEST(bench_cycle_timer)
+{
+	const int count = 1000000;
+	df::uint64 sum = 0;
+
+	df::CycleTimer cycleTimer;
+	for(int i = 0; i < count; ++i) {
+		sum += df::CycleTimer::getCurrentCycles();
+	}
+	const df::int64 cycleTime = cycleTimer.restart().asNanoseconds();
+	for(int i = 0; i < count; ++i) {
+		sum += df::CycleTimer::getCurrentCyclesSerialized();
+	}
+	const df::int64 serializedTime = cycleTimer.restart().asNanoseconds();
+	for(int i = 0; i < count; ++i) {
+		sum += df::Timer::getCurrentTime().asNanoseconds();
+	}
+	const df::int64 timerTime = cycleTimer.restart().asNanoseconds();
+	CHECK(sum != 0);
+
+	printf("CycleTimer::getCurrentCycles %.1f ns, getCurrentCyclesSerialized %.1f ns, Timer::getCurrentTime %.1f ns\n",
+		cycleTime / double(count), serializedTime / double(count), timerTime / double(count));
+}
+
+}
@@ -0,0 +1,171 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/EpochReclamation.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <cstdio>
+
+namespace {
+
+const df::uint32 MAGIC = 0xC0FFEE;
+
+/// counts its live instances, and checks that it is not read after deletion
+struct Node
+{
+	static df::Atomic<df::int32> s_liveCount;
+
+	explicit Node(df::uint32 value):value(value), magic(MAGIC) { s_liveCount.fetchAdd(1); }
+	~Node() { magic = 0; s_liveCount.fetchSub(1); }
+
+	df::uint32 value;
+	volatile df::uint32 magic;
+};
+df::Atomic<df::int32> Node::s_liveCount;
+
+TEST(check_epoch_retire)
+{
+	df::EpochDomain domain;
+	CHECK(!domain.isInCriticalSection());
+	{
+		df::EpochGuard guard(domain);
+		df::EpochGuard nested(domain);
+		CHECK(domain.isInCriticalSection());
+	}
+	CHECK(!domain.isInCriticalSection());
+
+	const int count = 1000;
+	for(int i = 0; i < count; ++i) {
+		domain.retire(new Node(i));
+	}
+	CHECK(domain.getRetiredCount() <= (df::uint32) count);
+	domain.synchronize();
+	CHECK_EQUAL(0u, domain.getRetiredCount());
+	CHECK_EQUAL(0, Node::s_liveCount.load());
+
+	// objects still retired are freed with the domain
+	{
+		df::EpochDomain other;
+		other.retire(new Node(0));
+	}
+	CHECK_EQUAL(0, Node::s_liveCount.load());
+}
+
+struct Reader
+{
+	Reader(df::EpochDomain& domain):domain(domain) {}
+
+	df::EpochDomain& domain;
+	df::Atomic<df::uint32> isInside;
+	df::Atomic<df::uint32> canLeave;
+};
+
+void stayInside(void* userData)
+{
+	Reader* reader = (Reader*) userData;
+	df::EpochGuard guard(reader->domain);
+	reader->isInside.store(1);
+	while(!reader->canLeave.load()) {
+		df::this_thread::yield();
+	}
+}
+
+TEST(check_epoch_critical_section_delays_free)
+{
+	df::EpochDomain domain;
+	Reader reader(domain);
+	df::Thread thread(&stayInside, &reader);
+	while(!reader.isInside.load()) {
+		df::this_thread::yield();
+	}
+
+	domain.retire(new Node(0));
+	const df::uint32 epoch = domain.getEpoch();
+	for(int i = 0; i < 10; ++i) {
+		domain.collect();
+	}
+	// the reader entered before the object was retired: the epoch can move once at most
+	CHECK(domain.getEpoch() - epoch <= 1);
+	CHECK_EQUAL(1, Node::s_liveCount.load());
+
+	reader.canLeave.store(1);
+	thread.join();
+	domain.synchronize();
+	CHECK_EQUAL(0, Node::s_liveCount.load());
+}
+
+const int NUM_THREAD = 4;
+const int NUM_ITERATION = 20000;
+
+/// readers follow a shared pointer while writers replace it and retire the previous node
+struct SharedPointer
+{
+	SharedPointer():node(new Node(0)) {}
+
+	df::EpochDomain domain;
+	df::Atomic<Node*> node;
+	df::Atomic<df::uint32> errorCount;
+};
+
+void readPointer(void* userData)
+{
+	SharedPointer* shared = (SharedPointer*) userData;
+	for(int i = 0; i < NUM_ITERATION; ++i)
+	{
+		df::EpochGuard guard(shared->domain);
+		Node* node = shared->node.load(df::MEMORY_ORDER_ACQUIRE);
+		if(node->magic != MAGIC) {
+			shared->errorCount.fetchAdd(1);
+		}
+	}
+}
+
+void replacePointer(void* userData)
+{
+	SharedPointer* shared = (SharedPointer*) userData;
+	for(int i = 0; i < NUM_ITERATION; ++i)
+	{
+		Node* previous = shared->node.exchange(new Node(i));
+		shared->domain.retire(previous);
+	}
+	// exits with objects still retired: they are handed over to the domain
+}
+
+TEST(check_epoch_concurrent_replace)
+{
+	{
+		SharedPointer shared;
+		df::Thread* threads[2 * NUM_THREAD];
+		for(int i = 0; i < NUM_THREAD; ++i)
+		{
+			threads[2 * i] = new df::Thread(&readPointer, &shared);
+			threads[2 * i + 1] = new df::Thread(&replacePointer, &shared);
+		}
+		for(int i = 0; i < 2 * NUM_THREAD; ++i)
+		{
+			threads[i]->join();
+			delete threads[i];
+		}
+		CHECK_EQUAL(0u, shared.errorCount.load());
+
+		shared.domain.synchronize();
+		CHECK_EQUAL(0u, shared.domain.getRetiredCount());
+		CHECK_EQUAL(1, Node::s_liveCount.load());
+		delete shared.node.load();
+	}
+	CHECK_EQUAL(0, Node::s_liveCount.load());
+}
+
+TEST(bench_epoch_guard)
+{
+	const int count = 10000000;
+	df::EpochDomain domain;
+	df::Timer timer;
+	for(int i = 0; i < count; ++i) {
+		df::EpochGuard guard(domain);
+	}
+	const df::Time time = timer.getElapsedTime();
+	printf("EpochGuard: %.1f ns per critical section\n", time.asNanoseconds() / double(count));
+}
+
+}
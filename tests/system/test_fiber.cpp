@@ -0,0 +1,203 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/Fiber.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <cstdio>
+
+namespace {
+
+const int NUM_WORKER = 4;
+const int NUM_FIBER = 64;
+const int NUM_ITERATION = 1000;
+
+struct Counters
+{
+	Counters():sum(0), inside(0), maxInside(0) {}
+
+	df::FiberMutex mutex;
+	int sum;       ///< protected by mutex
+	int inside;    ///< fibers holding mutex
+	int maxInside;
+	df::Atomic<df::uint32> errorCount;
+};
+
+void incrementLocked(void* userData)
+{
+	Counters* counters = (Counters*) userData;
+	if(!df::this_fiber::isFiber()) {
+		counters->errorCount.fetchAdd(1);
+	}
+	for(int i = 0; i < NUM_ITERATION; ++i)
+	{
+		counters->mutex.lock();
+		++counters->inside;
+		if(counters->inside > counters->maxInside) {
+			counters->maxInside = counters->inside;
+		}
+		const int sum = counters->sum;
+		// let the other fibers run (and find the mutex locked) in the middle of the critical section
+		if(i % 16 == 0) {
+			df::this_fiber::yield();
+		}
+		counters->sum = sum + 1;
+		--counters->inside;
+		counters->mutex.unlock();
+	}
+}
+
+TEST(check_fiber_mutex)
+{
+	Counters counters;
+	{
+		df::FiberScheduler scheduler(NUM_WORKER);
+		CHECK_EQUAL(NUM_WORKER, (int) scheduler.getWorkerCount());
+		for(int i = 0; i < NUM_FIBER; ++i) {
+			scheduler.spawn(&incrementLocked, &counters);
+		}
+		scheduler.waitAll();
+		CHECK_EQUAL(NUM_FIBER * NUM_ITERATION, counters.sum);
+
+		// stacks are reused by a second wave
+		for(int i = 0; i < NUM_FIBER; ++i) {
+			scheduler.spawn(&incrementLocked, &counters);
+		}
+	}
+	CHECK_EQUAL(2 * NUM_FIBER * NUM_ITERATION, counters.sum);
+	CHECK_EQUAL(1, counters.maxInside);
+	CHECK_EQUAL(0u, counters.errorCount.load());
+	CHECK(!df::this_fiber::isFiber());
+}
+
+/// more fibers than workers all blocked at the same time: only possible if waiting does not block the worker
+struct Gate
+{
+	Gate():event(df::Event::MANUAL_RESET) {}
+
+	df::FiberEvent event;
+	df::Atomic<df::uint32> arrivedCount;
+	df::Atomic<df::uint32> passedCount;
+};
+
+void waitGate(void* userData)
+{
+	Gate* gate = (Gate*) userData;
+	gate->arrivedCount.fetchAdd(1);
+	gate->event.wait();
+	gate->passedCount.fetchAdd(1);
+}
+
+void openGate(void* userData)
+{
+	Gate* gate = (Gate*) userData;
+	while(gate->arrivedCount.load() < NUM_FIBER) {
+		df::this_fiber::yield();
+	}
+	gate->event.set();
+}
+
+TEST(check_fiber_event)
+{
+	Gate gate;
+	df::FiberScheduler scheduler(2);
+	for(int i = 0; i < NUM_FIBER; ++i) {
+		scheduler.spawn(&waitGate, &gate);
+	}
+	scheduler.spawn(&openGate, &gate);
+	scheduler.waitAll();
+	CHECK_EQUAL((df::uint32) NUM_FIBER, gate.passedCount.load());
+	CHECK(gate.event.isSet());
+	CHECK(gate.event.tryWait());
+	gate.event.reset();
+	CHECK(!gate.event.tryWait());
+
+	// auto reset: a single waiter per set, a set without waiter is kept for the next wait
+	df::FiberEvent autoEvent;
+	autoEvent.set();
+	CHECK(autoEvent.tryWait());
+	CHECK(!autoEvent.tryWait());
+}
+
+struct PingPong
+{
+	PingPong():ping(df::Event::AUTO_RESET), pong(df::Event::AUTO_RESET), count(0) {}
+
+	df::FiberEvent ping;
+	df::FiberEvent pong;
+	int count;
+};
+
+void pinger(void* userData)
+{
+	PingPong* game = (PingPong*) userData;
+	for(int i = 0; i < NUM_ITERATION; ++i)
+	{
+		game->ping.set();
+		game->pong.wait();
+	}
+}
+
+void ponger(void* userData)
+{
+	PingPong* game = (PingPong*) userData;
+	for(int i = 0; i < NUM_ITERATION; ++i)
+	{
+		game->ping.wait();
+		++game->count;
+		game->pong.set();
+	}
+}
+
+TEST(check_fiber_ping_pong)
+{
+	PingPong game;
+	{
+		df::FiberScheduler scheduler(NUM_WORKER);
+		scheduler.spawn(&ponger, &game);
+		scheduler.spawn(&pinger, &game);
+	}
+	CHECK_EQUAL(NUM_ITERATION, game.count);
+}
+
+const int NUM_SWITCH = 100000;
+
+void yieldLoop(void*)
+{
+	for(int i = 0; i < NUM_SWITCH; ++i) {
+		df::this_fiber::yield();
+	}
+}
+
+void threadYieldLoop(void*)
+{
+	for(int i = 0; i < NUM_SWITCH; ++i) {
+		df::this_thread::yield();
+	}
+}
+
+TEST(bench_fiber_switch)
+{
+	// two fibers yielding to each other on a single worker: each yield resumes the other fiber
+	df::Time fiberTime;
+	{
+		df::FiberScheduler scheduler(1);
+		df::Timer timer;
+		scheduler.spawn(&yieldLoop, NULL);
+		scheduler.spawn(&yieldLoop, NULL);
+		scheduler.waitAll();
+		fiberTime = timer.getElapsedTime();
+	}
+
+	df::Timer timer;
+	df::Thread first(&threadYieldLoop, NULL);
+	df::Thread second(&threadYieldLoop, NULL);
+	first.join();
+	second.join();
+	const df::Time threadTime = timer.getElapsedTime();
+
+	printf("switch: fiber yield %.1f ns, this_thread::yield %.1f ns\n",
+		fiberTime.asNanoseconds() / double(2 * NUM_SWITCH), threadTime.asNanoseconds() / double(2 * NUM_SWITCH));
+}
+
+}
@@ -0,0 +1,138 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+
+#include <df/system/Future.h>
+#include <df/system/Thread.h>
+
+namespace {
+
+struct Square
+{
+	typedef int argument_type;
+	typedef int result_type;
+	int operator()(int value) const { return value * value; }
+};
+
+struct ToDouble
+{
+	typedef int argument_type;
+	typedef double result_type;
+	double operator()(int value) const { return value * 0.5; }
+};
+
+struct Answer
+{
+	typedef int result_type;
+	int operator()() const { return 42; }
+};
+
+struct DelayedValue
+{
+	df::Promise<int> promise;
+	int value;
+	df::Time delay;
+
+	static void run(void* userData)
+	{
+		DelayedValue* delayed = (DelayedValue*) userData;
+		df::this_thread::sleep(delayed->delay);
+		delayed->promise.setValue(delayed->value);
+	}
+};
+
+TEST(check_future_promise)
+{
+	df::Future<int> invalid;
+	CHECK(!invalid.isValid());
+
+	df::Future<int> future;
+	{
+		df::Promise<int> promise;
+		future = promise.getFuture();
+		CHECK(future.isValid() && !future.isReady());
+		int value = 0;
+		CHECK(!future.get(value, df::milliseconds(1)));
+		promise.setValue(7);
+	}
+	CHECK(future.isReady() && future.hasValue());
+	CHECK(future.get() == 7);
+
+	// broken promise
+	{
+		df::Promise<int> promise;
+		future = promise.getFuture();
+	}
+	CHECK(future.isReady() && !future.hasValue());
+	int value = 0;
+	CHECK(!future.get(value, df::milliseconds(1)));
+}
+
+TEST(check_future_cross_thread)
+{
+	DelayedValue delayed;
+	delayed.value = 3;
+	delayed.delay = df::milliseconds(20);
+	df::Future<int> future = delayed.promise.getFuture();
+	df::Future<int> squared = future.then(Square());
+	df::Thread thread(&DelayedValue::run, &delayed);
+
+	int value = 0;
+	CHECK(!future.get(value, df::milliseconds(1)));
+	CHECK(future.get(value, df::seconds(5.f)));
+	CHECK(value == 3);
+	CHECK(squared.get() == 9);
+	thread.join();
+}
+
+TEST(check_future_then_async)
+{
+	df::ThreadPool pool(2);
+	df::Future<int> answer = df::async(pool, Answer());
+	df::Future<double> half = answer.then(pool, Square()).then(ToDouble());
+	CHECK(half.get() == 882.0);
+	// continuation of a ready future runs immediately
+	CHECK(answer.then(Square()).isReady());
+
+	df::Future<int> broken;
+	{
+		df::Promise<int> promise;
+		broken = promise.getFuture().then(Square());
+	}
+	CHECK(broken.isReady() && !broken.hasValue());
+
+	// many small futures recycle their state blocks
+	const df::uint32 FUTURE_COUNT = 1000;
+	df::Future<int> futures[FUTURE_COUNT];
+	for(df::uint32 i = 0; i<FUTURE_COUNT; ++i)
+	{
+		futures[i] = df::async(pool, Answer());
+	}
+	df::Future<df::uint32> all = df::when_all(futures, FUTURE_COUNT);
+	CHECK(all.get() == FUTURE_COUNT);
+	for(df::uint32 i = 0; i<FUTURE_COUNT; ++i)
+	{
+		CHECK(futures[i].get() == 42);
+	}
+}
+
+TEST(check_future_when_any)
+{
+	DelayedValue delayed[3];
+	df::Future<int> futures[3];
+	for(int i = 0; i<3; ++i)
+	{
+		delayed[i].value = i;
+		delayed[i].delay = df::milliseconds(i == 1 ? 1.f : 200.f);
+		futures[i] = delayed[i].promise.getFuture();
+	}
+	df::Future<df::uint32> any = df::when_any(futures, 3);
+	df::Future<df::uint32> all = df::when_all(futures, 3);
+	df::Thread thread0(&DelayedValue::run, &delayed[0]);
+	df::Thread thread1(&DelayedValue::run, &delayed[1]);
+	df::Thread thread2(&DelayedValue::run, &delayed[2]);
+	CHECK(any.get() == 1);
+	CHECK(all.get() == 3);
+	CHECK(df::when_all(futures, 0).get() == 0);
+}
+
+}
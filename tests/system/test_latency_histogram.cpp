@@ -0,0 +1,138 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/LatencyHistogram.h>
+#include <df/system/CycleTimer.h>
+#include <df/system/Thread.h>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const int THREAD_COUNT = 4;
+const int SAMPLE_COUNT = 100000;
+
+/// relative error of the histogram
+bool isClose(df::Time value, double expectedNanoseconds)
+{
+	const double difference = value.asNanoseconds() - expectedNanoseconds;
+	return (difference < 0 ? -difference : difference) <= expectedNanoseconds / 100.0 + 1.0;
+}
+
+struct Recorder
+{
+	df::LatencyHistogram* histogram;
+	int thread;
+};
+
+/// records 1 to SAMPLE_COUNT ns, interleaved between the threads
+void recordSamples(void* userData)
+{
+	Recorder* recorder = (Recorder*) userData;
+	for(int i = recorder->thread + 1; i <= SAMPLE_COUNT; i += THREAD_COUNT) {
+		recorder->histogram->record(df::nanoseconds(i));
+	}
+}
+
+std::string writeToString(const df::LatencyHistogram& histogram, bool isCsv)
+{
+	FILE* file = tmpfile();
+	if(!file) {
+		return std::string();
+	}
+	if(isCsv) {
+		histogram.writeCsv(file);
+	} else {
+		histogram.writeText(file);
+	}
+	rewind(file);
+	std::string text;
+	char block[4096];
+	size_t size;
+	while((size = fread(block, 1, sizeof(block), file)) > 0) {
+		text.append(block, size);
+	}
+	fclose(file);
+	return text;
+}
+
+TEST(check_latency_histogram)
+{
+	df::LatencyHistogram histogram;
+	CHECK_EQUAL(0u, (unsigned) histogram.getCount());
+	CHECK(histogram.getPercentile(50.0) == df::Time());
+	CHECK(histogram.getMin() == df::Time());
+
+	// shards of exited threads and of a live thread
+	Recorder recorders[THREAD_COUNT];
+	df::Thread* threads[THREAD_COUNT - 1];
+	for(int i = 0; i < THREAD_COUNT; ++i)
+	{
+		recorders[i].histogram = &histogram;
+		recorders[i].thread = i;
+		if(i > 0) {
+			threads[i - 1] = new df::Thread(&recordSamples, &recorders[i]);
+		}
+	}
+	recordSamples(&recorders[0]);
+	for(int i = 0; i < THREAD_COUNT - 1; ++i)
+	{
+		threads[i]->join();
+		delete threads[i];
+	}
+
+	CHECK_EQUAL((unsigned) SAMPLE_COUNT, (unsigned) histogram.getCount());
+	CHECK(histogram.getMin() == df::nanoseconds(1));
+	CHECK(histogram.getMax() == df::nanoseconds(SAMPLE_COUNT));
+	CHECK(histogram.getMean() == df::nanoseconds((SAMPLE_COUNT + 1) / 2));
+	CHECK(isClose(histogram.getPercentile(50.0), SAMPLE_COUNT * 0.5));
+	CHECK(isClose(histogram.getPercentile(99.0), SAMPLE_COUNT * 0.99));
+	CHECK(isClose(histogram.getPercentile(99.9), SAMPLE_COUNT * 0.999));
+	CHECK(histogram.getPercentile(100.0) == df::nanoseconds(SAMPLE_COUNT));
+	CHECK(histogram.getPercentile(0.0) == df::nanoseconds(1));
+	// below 128 ns, every value has its bucket
+	CHECK(histogram.getPercentile(0.1) == df::nanoseconds(SAMPLE_COUNT / 1000));
+
+	// merge and reset
+	df::LatencyHistogram other;
+	other.record(df::seconds(3600.0f), 10);
+	other.record(-df::nanoseconds(5));
+	other.record(df::LatencyHistogram::getHighestTrackableValue() * df::int64(2));
+	other.merge(histogram);
+	CHECK_EQUAL((unsigned) SAMPLE_COUNT + 12, (unsigned) other.getCount());
+	CHECK(other.getMin() == df::Time());
+	CHECK(other.getMax() == df::LatencyHistogram::getHighestTrackableValue());
+	CHECK(isClose(other.getPercentile(99.995), 3600.0e9));
+	CHECK(isClose(other.getPercentile(50.0), SAMPLE_COUNT * 0.5));
+	CHECK_EQUAL((unsigned) SAMPLE_COUNT, (unsigned) histogram.getCount());
+
+	histogram.reset();
+	CHECK_EQUAL(0u, (unsigned) histogram.getCount());
+	histogram.record(df::microseconds(20));
+	CHECK(histogram.getMin() == df::microseconds(20));
+	CHECK(histogram.getPercentile(50.0) == df::microseconds(20));
+
+	// exports
+	const std::string text = writeToString(other, false);
+	CHECK(text.find("count 100012,") == 0);
+	CHECK(text.find("p99.9 ") != std::string::npos);
+	const std::string csv = writeToString(other, true);
+	CHECK(csv.find("latency_ns,count,percentile\n0,1,") == 0);
+	CHECK(csv.find(",100.000000\n") == csv.size() - 12);
+}
+
+TEST(bench_latency_histogram)
+{
+	const int count = 1000000;
+	df::LatencyHistogram histogram;
+	histogram.record(df::Time());
+	df::CycleTimer timer;
+	for(int i = 0; i < count; ++i) {
+		histogram.record(df::nanoseconds(df::int64(i) * 7919 % 1000000));
+	}
+	const df::Time time = timer.getElapsedTime();
+	CHECK_EQUAL((unsigned) count + 1, (unsigned) histogram.getCount());
+	printf("LatencyHistogram::record %.1f ns\n", time.asNanoseconds() / double(count));
+	histogram.writeText(stdout);
+}
+
+}
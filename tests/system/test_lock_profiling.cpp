@@ -0,0 +1,120 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/LockProfiling.h>
+#include <df/system/Mutex.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+/// statistics of lock, false if it is not registered
+bool findStatistics(const df::Mutex& lock, df::LockStatistics& result)
+{
+	df::LockStatistics statistics[256];
+	const df::uint32 count = df::lock_profiling::getStatistics(statistics, 256);
+	for(df::uint32 i = 0; i < count && i < 256; ++i)
+	{
+		if(statistics[i].lock == &lock)
+		{
+			result = statistics[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+struct Holder
+{
+	Holder():mutex("test holder"), isLocked(0) {}
+
+	df::Mutex mutex;
+	df::Atomic<df::uint32> isLocked;
+};
+
+void holdMutex(void* userData)
+{
+	Holder* holder = (Holder*) userData;
+	holder->mutex.lock();
+	holder->isLocked.store(1);
+	df::this_thread::sleep(df::milliseconds(20));
+	holder->mutex.unlock();
+}
+
+TEST(check_lock_profiling)
+{
+	Holder holder;
+	df::LockStatistics statistics;
+	if(!df::lock_profiling::isEnabled())
+	{
+		CHECK(!findStatistics(holder.mutex, statistics));
+		return;
+	}
+
+	CHECK(findStatistics(holder.mutex, statistics));
+	CHECK_EQUAL(std::string("test holder"), std::string(statistics.name));
+	CHECK_EQUAL(0u, (unsigned) statistics.acquisitionCount);
+
+	// recursive, uncontended
+	holder.mutex.lock();
+	CHECK(holder.mutex.tryLock());
+	CHECK(findStatistics(holder.mutex, statistics));
+	CHECK_EQUAL(df::this_thread::getID(), statistics.holderThreadID);
+	holder.mutex.unlock();
+	holder.mutex.unlock();
+	CHECK(findStatistics(holder.mutex, statistics));
+	CHECK_EQUAL(2u, (unsigned) statistics.acquisitionCount);
+	CHECK_EQUAL(0u, (unsigned) statistics.contentionCount);
+	CHECK_EQUAL(0u, statistics.holderThreadID);
+
+	// contended: wait for the other thread
+	df::Thread thread(&holdMutex, &holder);
+	while(!holder.isLocked.load()) {
+		df::this_thread::yield();
+	}
+	holder.mutex.lock();
+	holder.mutex.unlock();
+	thread.join();
+	CHECK(findStatistics(holder.mutex, statistics));
+	CHECK_EQUAL(4u, (unsigned) statistics.acquisitionCount);
+	CHECK_EQUAL(1u, (unsigned) statistics.contentionCount);
+	CHECK(statistics.maxWaitTime > df::milliseconds(5));
+	CHECK(statistics.totalWaitTime == statistics.maxWaitTime);
+
+	df::lock_profiling::dump(stdout);
+	df::lock_profiling::reset();
+	CHECK(findStatistics(holder.mutex, statistics));
+	CHECK_EQUAL(0u, (unsigned) statistics.acquisitionCount);
+
+	// unregistered with the mutex
+	const void* address = NULL;
+	{
+		df::Mutex temporary("temporary");
+		address = &temporary;
+		CHECK(findStatistics(temporary, statistics));
+	}
+	df::LockStatistics all[256];
+	const df::uint32 count = df::lock_profiling::getStatistics(all, 256);
+	for(df::uint32 i = 0; i < count && i < 256; ++i) {
+		CHECK(all[i].lock != address || strcmp(all[i].name, "temporary") != 0);
+	}
+}
+
+TEST(bench_mutex_uncontended)
+{
+	const int count = 1000000;
+	df::Mutex mutex("bench");
+	df::Timer timer;
+	for(int i = 0; i < count; ++i)
+	{
+		mutex.lock();
+		mutex.unlock();
+	}
+	const df::Time time = timer.getElapsedTime();
+	printf("Mutex lock + unlock (%s): %.1f ns\n", df::lock_profiling::isEnabled() ? "profiled" : "not profiled",
+		time.asNanoseconds() / double(count));
+}
+
+}
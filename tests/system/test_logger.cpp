@@ -4,6 +4,8 @@
 #include <df/system/Thread.h>
 #include <df/system/Mutex.h>
 #include <df/system/Logger.h>
+#include <cstdlib>
+#include <string>
 
 namespace {
 
@@ -0,0 +1,105 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <stdio.h>
+
+#include <df/system/MappedArray.h>
+
+namespace {
+
+const char* const TEST_FILE = "test_mapped_array.bin";
+
+struct Entry
+{
+	df::uint32 key;
+	float value;
+};
+
+TEST(check_mapped_file)
+{
+	remove(TEST_FILE);
+	df::MappedFile file;
+	CHECK(!file.open(TEST_FILE, df::MappedFile::MAP_READ_ONLY));
+	CHECK(file.open(TEST_FILE, df::MappedFile::MAP_READ_WRITE));
+	CHECK(file.getSize() == 0);
+	CHECK(file.resize(100));
+	CHECK(file.getSize() == 100);
+	((char*)file.getData())[99] = 42;
+	CHECK(file.flush());
+	file.close();
+
+	CHECK(file.open(TEST_FILE, df::MappedFile::MAP_READ_ONLY));
+	CHECK(file.getSize() == 100);
+	CHECK(((char*)file.getData())[99] == 42);
+	CHECK(!file.resize(200));
+	file.close();
+	remove(TEST_FILE);
+}
+
+TEST(check_mapped_array_persistence)
+{
+	remove(TEST_FILE);
+	{
+		df::MappedArray<Entry> array;
+		CHECK(array.open(TEST_FILE, df::MappedFile::MAP_READ_WRITE));
+		CHECK(array.size() == 0);
+		for(df::uint32 i = 0; i<10000; ++i)
+		{
+			Entry entry = { i, i * 0.5f };
+			CHECK(array.push_back(entry));
+		}
+		CHECK(array.size() == 10000);
+		CHECK(array.reserved_size() >= 10000);
+		CHECK(array.trim());
+		CHECK(array.reserved_size() == 10000);
+	}
+	{
+		df::MappedArray<Entry> array;
+		CHECK(array.open(TEST_FILE, df::MappedFile::MAP_READ_ONLY));
+		CHECK(array.size() == 10000);
+		CHECK(array[0].key == 0 && array[9999].key == 9999 && array[9999].value == 4999.5f);
+		CHECK(array.end() - array.begin() == 10000);
+	}
+	{
+		// element size mismatch
+		df::MappedArray<df::uint16> array;
+		CHECK(!array.open(TEST_FILE, df::MappedFile::MAP_READ_ONLY));
+		CHECK(!array.isOpen());
+	}
+	{
+		// alignment mismatch
+		df::MappedArray<Entry, 16> array;
+		CHECK(!array.open(TEST_FILE, df::MappedFile::MAP_READ_ONLY));
+		CHECK(!array.isOpen());
+	}
+	remove(TEST_FILE);
+}
+
+TEST(check_mapped_array_resize)
+{
+	remove(TEST_FILE);
+	df::MappedArray<int, 32> array;
+	CHECK(array.open(TEST_FILE, df::MappedFile::MAP_READ_WRITE));
+	CHECK(((size_t)array.begin() & 31) == 0);
+	CHECK(array.resize(100, 7));
+	CHECK(array[99] == 7);
+	array.pop_back();
+	CHECK(array.size() == 99);
+	CHECK(array.resize(200));
+	CHECK(array[98] == 7 && array[99] == 0 && array[199] == 0);
+	// push an element of the array itself across a remap
+	CHECK(array.trim());
+	CHECK(array.push_back(array[0]));
+	CHECK(array[200] == 7);
+	array.clear();
+	CHECK(array.empty());
+	array.close();
+
+	// a file which is not a MappedArray
+	FILE* file = fopen(TEST_FILE, "wb");
+	fputs("not a mapped array, but long enough to hold a header.......................", file);
+	fclose(file);
+	CHECK(!array.open(TEST_FILE, df::MappedFile::MAP_READ_WRITE));
+	remove(TEST_FILE);
+}
+
+}
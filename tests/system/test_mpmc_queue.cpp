@@ -0,0 +1,248 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <stdio.h>
+
+#include <df/system/MPMCQueue.h>
+#include <df/system/RingBuffer.h>
+#include <df/system/Mutex.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+
+namespace {
+
+TEST(check_mpmc_queue)
+{
+	df::MPMCQueue<int> queue(10);
+	CHECK(queue.capacity() == 16);
+	CHECK(queue.empty());
+	int value = 0;
+	CHECK(!queue.try_pop(value));
+
+	// several laps, to cross the wrap around of the cells
+	for(int lap = 0; lap < 5; ++lap)
+	{
+		for(int i = 0; i < 16; ++i) {
+			CHECK(queue.try_push(lap * 100 + i));
+		}
+		CHECK(!queue.try_push(-1));
+		CHECK(queue.size() == 16);
+		for(int i = 0; i < 16; ++i)
+		{
+			CHECK(queue.try_pop(value));
+			CHECK(value == lap * 100 + i);
+		}
+		CHECK(queue.empty());
+	}
+
+	// batches
+	int values[20];
+	for(int i = 0; i < 20; ++i) {
+		values[i] = i;
+	}
+	CHECK(queue.try_push(values, 10) == 10);
+	CHECK(queue.try_push(values + 10, 10) == 6);
+	int popped[20];
+	CHECK(queue.try_pop(popped, 4) == 4);
+	CHECK(popped[0] == 0 && popped[3] == 3);
+	CHECK(queue.try_pop(popped, 20) == 12);
+	CHECK(popped[0] == 4 && popped[11] == 15);
+	CHECK(queue.try_pop(popped, 20) == 0);
+}
+
+const int NUM_THREAD = 4;
+const int NUM_ITEM = 20000;
+
+/// each producer pushes NUM_ITEM values, consumers sum what they pop
+template<class Queue>
+struct QueueTest
+{
+	explicit QueueTest(df::uint32 capacity):queue(capacity), poppedCount(0), sum(0), batchSize(1) {}
+
+	Queue queue;
+	df::Atomic<df::uint32> poppedCount;
+	df::Atomic<df::uint64> sum;
+	df::uint32 itemCount;   ///< total number of pushed items
+	df::uint32 batchSize;
+
+	static void produce(void* userData)
+	{
+		QueueTest* test = (QueueTest*) userData;
+		int values[16];
+		for(int i = 1; i <= NUM_ITEM; )
+		{
+			df::uint32 count = 0;
+			for(; count < test->batchSize && i + int(count) <= NUM_ITEM; ++count) {
+				values[count] = i + count;
+			}
+			const df::uint32 pushed = test->queue.try_push(values, count);
+			if(pushed == 0) {
+				df::this_thread::yield();
+			}
+			i += pushed;
+		}
+	}
+
+	static void consume(void* userData)
+	{
+		QueueTest* test = (QueueTest*) userData;
+		int values[16];
+		df::uint64 sum = 0;
+		while(test->poppedCount.load(df::MEMORY_ORDER_RELAXED) < test->itemCount)
+		{
+			const df::uint32 count = test->queue.try_pop(values, test->batchSize);
+			if(count == 0)
+			{
+				df::this_thread::yield();
+				continue;
+			}
+			for(df::uint32 i = 0; i < count; ++i) {
+				sum += values[i];
+			}
+			test->poppedCount.fetchAdd(count);
+		}
+		test->sum.fetchAdd(sum);
+	}
+
+	/// return the time to transfer all the items
+	df::Time run(int producerCount, int consumerCount)
+	{
+		itemCount = producerCount * NUM_ITEM;
+		poppedCount.store(0);
+		sum.store(0);
+		df::Thread* threads[NUM_THREAD * 2];
+		df::Timer timer;
+		for(int i = 0; i < producerCount; ++i) {
+			threads[i] = new df::Thread(&produce, this);
+		}
+		for(int i = 0; i < consumerCount; ++i) {
+			threads[producerCount + i] = new df::Thread(&consume, this);
+		}
+		for(int i = 0; i < producerCount + consumerCount; ++i) {
+			delete threads[i];
+		}
+		return timer.getElapsedTime();
+	}
+
+	bool isComplete(int producerCount) const
+	{
+		return poppedCount.load() == df::uint32(producerCount * NUM_ITEM) &&
+			sum.load() == df::uint64(producerCount) * NUM_ITEM * (NUM_ITEM + 1) / 2;
+	}
+};
+
+/// what the lock-free queue replaces
+template<class T>
+class LockedQueue
+{
+public:
+	explicit LockedQueue(df::uint32 capacity):_buffer(capacity) {}
+
+	df::uint32 try_push(const T* values, df::uint32 count)
+	{
+		df::ScopedLock lock(_mutex);
+		df::uint32 pushed = 0;
+		for(; pushed < count && _buffer.size() < _buffer.capacity(); ++pushed) {
+			_buffer.push_back(values[pushed]);
+		}
+		return pushed;
+	}
+	df::uint32 try_pop(T* values, df::uint32 maxCount)
+	{
+		df::ScopedLock lock(_mutex);
+		df::uint32 popped = 0;
+		for(; popped < maxCount && !_buffer.empty(); ++popped)
+		{
+			values[popped] = _buffer.front();
+			_buffer.pop_front();
+		}
+		return popped;
+	}
+
+private:
+	df::Mutex _mutex;
+	df::RingBuffer<T> _buffer;
+};
+
+TEST(check_mpmc_queue_multithread)
+{
+	QueueTest<df::MPMCQueue<int> > test(64);
+	test.run(NUM_THREAD, NUM_THREAD);
+	CHECK(test.isComplete(NUM_THREAD));
+	test.batchSize = 7;
+	test.run(NUM_THREAD, NUM_THREAD);
+	CHECK(test.isComplete(NUM_THREAD));
+}
+
+struct BlockingTest
+{
+	static const int NUM_ITEM = 10000;
+	BlockingTest():queue(8), sum(0) {}
+	df::BlockingMPMCQueue<int> queue;
+	df::Atomic<df::uint64> sum;
+
+	static void produce(void* userData)
+	{
+		BlockingTest* test = (BlockingTest*) userData;
+		for(int i = 1; i <= NUM_ITEM; ++i) {
+			test->queue.push(i);
+		}
+	}
+	static void consume(void* userData)
+	{
+		BlockingTest* test = (BlockingTest*) userData;
+		df::uint64 sum = 0;
+		for(int i = 0; i < NUM_ITEM; ++i)
+		{
+			int value = 0;
+			test->queue.pop(value);
+			sum += value;
+		}
+		test->sum.fetchAdd(sum);
+	}
+};
+
+TEST(check_blocking_mpmc_queue)
+{
+	BlockingTest test;
+	int value = 0;
+	df::Timer timer;
+	CHECK(!test.queue.pop(value, df::milliseconds(20)));
+	CHECK(timer.getElapsedTime() >= df::milliseconds(15));
+
+	df::Thread* threads[NUM_THREAD * 2];
+	for(int i = 0; i < NUM_THREAD; ++i)
+	{
+		threads[i * 2] = new df::Thread(&BlockingTest::consume, &test);
+		threads[i * 2 + 1] = new df::Thread(&BlockingTest::produce, &test);
+	}
+	for(int i = 0; i < NUM_THREAD * 2; ++i) {
+		delete threads[i];
+	}
+	CHECK(test.queue.empty());
+	CHECK(test.sum.load() == df::uint64(NUM_THREAD) * BlockingTest::NUM_ITEM * (BlockingTest::NUM_ITEM + 1) / 2);
+}
+
+TEST(bench_mpmc_queue)
+{
+	const int configurations[3][2] = { { 1, 1 }, { NUM_THREAD, 1 }, { NUM_THREAD, NUM_THREAD } };
+	const char* names[3] = { "1P1C", "NP1C", "NPNC" };
+	for(int i = 0; i < 3; ++i)
+	{
+		const int producerCount = configurations[i][0];
+		const int consumerCount = configurations[i][1];
+		const float itemCount = float(producerCount * NUM_ITEM);
+
+		QueueTest<df::MPMCQueue<int> > lockFree(1024);
+		const float lockFreeTime = lockFree.run(producerCount, consumerCount).asMilliseconds();
+		CHECK(lockFree.isComplete(producerCount));
+
+		QueueTest<LockedQueue<int> > locked(1024);
+		const float lockedTime = locked.run(producerCount, consumerCount).asMilliseconds();
+		CHECK(locked.isComplete(producerCount));
+
+		printf("%s (N=%d): MPMCQueue %.0f items/ms, Mutex + RingBuffer %.0f items/ms\n", names[i], NUM_THREAD,
+			itemCount / (lockFreeTime > 0.001f ? lockFreeTime : 0.001f), itemCount / (lockedTime > 0.001f ? lockedTime : 0.001f));
+	}
+}
+
+}
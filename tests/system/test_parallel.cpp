@@ -0,0 +1,164 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include <df/system/Parallel.h>
+#include <df/system/AtomicOps.h>
+#include <df/system/Timer.h>
+
+namespace {
+
+struct CountRange
+{
+	volatile df::uint32* total;
+	void operator()(df::uint32 begin, df::uint32 end) const { df::priv::atomicFetchAdd(total, end - begin); }
+};
+
+struct DoubleInPlace
+{
+	void operator()(int& value) const { value *= 2; }
+};
+
+struct ToDoubledFloat
+{
+	float operator()(df::uint32 value) const { return value * 2.f; }
+};
+
+struct Add
+{
+	df::int64 operator()(df::int64 a, df::int64 b) const { return a + b; }
+};
+
+struct Greater
+{
+	bool operator()(df::uint32 a, df::uint32 b) const { return a > b; }
+};
+
+/// deterministic pseudo random values
+df::uint32 nextRandom(df::uint32& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return state ^ (state >> 16);
+}
+
+TEST(check_thread_pool_submit)
+{
+	df::ThreadPool pool(3);
+	CHECK(pool.getWorkerCount() == 3);
+	CHECK(df::ThreadPool::getHardwareConcurrency() >= 1);
+
+	volatile df::uint32 total = 0;
+	CountRange counter = { &total };
+	df::parallel_for(pool, 100000, counter, 7);
+	CHECK(total == 100000);
+
+	df::ThreadPool inlinePool(0);
+	total = 0;
+	df::parallel_for(inlinePool, 1000, counter);
+	CHECK(total == 1000);
+}
+
+TEST(check_parallel_for_each_transform)
+{
+	df::ThreadPool pool(3);
+	df::Array<int> values;
+	for(int i = 0; i<10000; ++i)
+	{
+		values.push_back(i);
+	}
+	df::parallel_for_each(pool, df::ArrayView<int>(values), DoubleInPlace());
+	CHECK(values[0] == 0 && values[1] == 2 && values[9999] == 19998);
+
+	df::Array<float> floats;
+	floats.resize(values.size());
+	df::parallel_transform(pool, df::ArrayView<const int>(values), df::ArrayView<float>(floats), ToDoubledFloat());
+	CHECK(floats[1] == 4.f && floats[9999] == 39996.f);
+}
+
+TEST(check_parallel_reduce)
+{
+	df::ThreadPool pool(3);
+	df::Array<df::int64> values;
+	for(int i = 1; i<=100000; ++i)
+	{
+		values.push_back(i);
+	}
+	CHECK(df::parallel_reduce(pool, df::ArrayView<const df::int64>(values), 0, Add()) == df::int64(100000) * 100001 / 2);
+	CHECK(df::parallel_reduce(pool, df::ArrayView<const df::int64>(values).sub(0, 10), 0, Add(), 3) == 55);
+	CHECK(df::parallel_reduce(pool, df::ArrayView<const df::int64>(), 42, Add()) == 42);
+}
+
+TEST(check_parallel_sort)
+{
+	df::ThreadPool pool(3);
+	df::uint32 state = 12345;
+	df::Array<df::uint32> values;
+	for(int i = 0; i<100003; ++i)
+	{
+		values.push_back(nextRandom(state));
+	}
+	df::Array<df::uint32> expected(values);
+	std::sort(expected.begin(), expected.end());
+
+	df::Array<df::uint32> sorted(values);
+	df::parallel_sort(pool, df::ArrayView<df::uint32>(sorted));
+	CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin()));
+
+	sorted = values;
+	df::parallel_sort(pool, df::ArrayView<df::uint32>(sorted), Greater());
+	std::reverse(sorted.begin(), sorted.end());
+	CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin()));
+
+	sorted = values;
+	df::parallel_radix_sort(pool, df::ArrayView<df::uint32>(sorted));
+	CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin()));
+
+	// keys sharing their high bytes skip some passes
+	df::Array<df::uint64> keys;
+	for(int i = 0; i<5000; ++i)
+	{
+		keys.push_back(nextRandom(state) & 0xFFFF);
+	}
+	df::parallel_radix_sort(pool, df::ArrayView<df::uint64>(keys));
+	CHECK(std::adjacent_find(keys.begin(), keys.end(), std::greater<df::uint64>()) == keys.end());
+}
+
+TEST(bench_parallel_scaling)
+{
+	const df::uint32 hardwareThreads = df::ThreadPool::getHardwareConcurrency();
+	df::uint32 state = 1;
+	df::Array<df::uint32> values;
+	for(int i = 0; i<1 << 22; ++i)
+	{
+		values.push_back(nextRandom(state));
+	}
+	df::Array<df::uint32> sorted;
+	df::Array<float> floats;
+	floats.resize(values.size());
+
+	// powers of two, then all the hardware threads
+	for(df::uint32 threadCount = 1; threadCount <= hardwareThreads;
+		threadCount = (threadCount < hardwareThreads && threadCount * 2 > hardwareThreads) ? hardwareThreads : threadCount * 2)
+	{
+		df::ThreadPool pool(threadCount - 1);
+		df::Timer timer;
+
+		df::parallel_transform(pool, df::ArrayView<const df::uint32>(values), df::ArrayView<float>(floats), ToDoubledFloat());
+		const float transformTime = timer.restart().asMilliseconds();
+
+		sorted = values;
+		timer.restart();
+		df::parallel_sort(pool, df::ArrayView<df::uint32>(sorted));
+		const float sortTime = timer.restart().asMilliseconds();
+
+		sorted = values;
+		timer.restart();
+		df::parallel_radix_sort(pool, df::ArrayView<df::uint32>(sorted));
+		const float radixTime = timer.restart().asMilliseconds();
+
+		printf("parallel %2u threads: transform %.2fms, sort %.2fms, radix sort %.2fms\n", threadCount, transformTime, sortTime, radixTime);
+	}
+}
+
+}
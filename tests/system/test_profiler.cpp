@@ -0,0 +1,104 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/Profiler.h>
+#include <df/system/Thread.h>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const int ZONES_PER_THREAD = 3000; // more than a chunk
+
+void recordZones(void*)
+{
+	for(int i = 0; i < ZONES_PER_THREAD / 2; ++i)
+	{
+		df::ProfileScope outer("outer");
+		df::ProfileScope inner("inner \"quoted\"");
+	}
+}
+
+/// content of a trace written to a temporary file
+std::string writeTrace()
+{
+	FILE* file = tmpfile();
+	if(!file) {
+		return std::string();
+	}
+	const bool isWritten = df::profiler::writeChromeTrace(file);
+	std::string text;
+	if(isWritten)
+	{
+		rewind(file);
+		char block[4096];
+		size_t size;
+		while((size = fread(block, 1, sizeof(block), file)) > 0) {
+			text.append(block, size);
+		}
+	}
+	fclose(file);
+	return text;
+}
+
+int countOccurrences(const std::string& text, const std::string& pattern)
+{
+	int count = 0;
+	for(size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1)) {
+		++count;
+	}
+	return count;
+}
+
+TEST(check_profiler)
+{
+	df::profiler::clear();
+	CHECK_EQUAL(0u, (unsigned) df::profiler::getZoneCount());
+
+	// zones of exited threads are kept
+	df::Thread first(&recordZones, NULL);
+	df::Thread second(&recordZones, NULL);
+	first.join();
+	second.join();
+	recordZones(NULL);
+	{
+		DF_PROFILE_SCOPE("macro");
+	}
+	const int macroCount = df::profiler::isEnabled() ? 1 : 0;
+	const int zoneCount = 3 * ZONES_PER_THREAD + macroCount;
+	CHECK_EQUAL(zoneCount, (int) df::profiler::getZoneCount());
+
+	const std::string trace = writeTrace();
+	CHECK_EQUAL(0u, (unsigned) trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+	CHECK_EQUAL(zoneCount, countOccurrences(trace, "\"ph\":\"X\""));
+	CHECK_EQUAL(3 * ZONES_PER_THREAD / 2, countOccurrences(trace, "{\"name\":\"outer\""));
+	CHECK_EQUAL(3 * ZONES_PER_THREAD / 2, countOccurrences(trace, "{\"name\":\"inner \\\"quoted\\\"\""));
+	CHECK_EQUAL(macroCount, countOccurrences(trace, "{\"name\":\"macro\""));
+	CHECK_EQUAL(1, countOccurrences(trace, "\"ts\":0.000,"));
+	CHECK(trace.find("]}") != std::string::npos);
+
+	// the buffer of the calling thread is reused
+	df::profiler::clear();
+	CHECK_EQUAL(0u, (unsigned) df::profiler::getZoneCount());
+	{
+		df::ProfileScope zone("after clear");
+	}
+	CHECK_EQUAL(1u, (unsigned) df::profiler::getZoneCount());
+	CHECK_EQUAL(1, countOccurrences(writeTrace(), "\"name\":\"after clear\""));
+	df::profiler::clear();
+}
+
+TEST(bench_profiler)
+{
+	const int count = 1000000;
+	df::profiler::clear();
+	df::CycleTimer timer;
+	for(int i = 0; i < count; ++i) {
+		df::ProfileScope zone("bench");
+	}
+	const df::Time time = timer.getElapsedTime();
+	CHECK_EQUAL((unsigned) count, (unsigned) df::profiler::getZoneCount());
+	df::profiler::clear();
+	printf("ProfileScope: %.1f ns per zone\n", time.asNanoseconds() / double(count));
+}
+
+}
@@ -0,0 +1,164 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+
+#include <df/system/RingBuffer.h>
+#include <df/system/SPSCRingBuffer.h>
+#include <df/system/Thread.h>
+
+namespace {
+
+TEST(check_ring_buffer_constructor)
+{
+	df::RingBuffer<int> buffer1;
+	CHECK(buffer1.size() == 0);
+	CHECK(buffer1.capacity() == 0);
+
+	df::RingBuffer<int> buffer2(10);
+	CHECK(buffer2.size() == 0);
+	CHECK(buffer2.capacity() == 16);
+}
+
+TEST(check_ring_buffer_fifo)
+{
+	df::RingBuffer<int> buffer;
+	for(int i = 0; i<100; ++i)
+	{
+		buffer.push_back(i);
+	}
+	CHECK(buffer.size() == 100);
+	for(int i = 0; i<100; ++i)
+	{
+		CHECK(buffer[i] == i);
+	}
+	for(int i = 0; i<100; ++i)
+	{
+		CHECK(buffer.front() == i);
+		buffer.pop_front();
+	}
+	CHECK(buffer.empty());
+}
+
+TEST(check_ring_buffer_deque)
+{
+	df::RingBuffer<int> buffer(8);
+	// wrap around the end of the storage while growing
+	for(int i = 0; i<20; ++i)
+	{
+		buffer.push_front(-i-1);
+		buffer.push_back(i);
+	}
+	CHECK(buffer.size() == 40);
+	for(int i = 0; i<40; ++i)
+	{
+		CHECK(buffer[i] == i-20);
+	}
+	CHECK(buffer.front() == -20);
+	CHECK(buffer.back() == 19);
+	buffer.pop_back();
+	buffer.pop_front();
+	CHECK(buffer.front() == -19);
+	CHECK(buffer.back() == 18);
+}
+
+TEST(check_ring_buffer_fixed_capacity)
+{
+	df::RingBuffer<int> buffer(8, false);
+	for(int i = 0; i<8; ++i)
+	{
+		CHECK(buffer.try_push_back(i));
+	}
+	CHECK(buffer.full());
+	CHECK(!buffer.try_push_back(8));
+	CHECK(!buffer.try_push_front(8));
+	CHECK(buffer.capacity() == 8);
+
+	// a growable buffer always accepts, even before its first allocation
+	df::RingBuffer<int> growable;
+	CHECK(growable.try_push_back(1));
+	CHECK(growable.try_push_front(0));
+	CHECK(growable.size() == 2);
+	CHECK(growable.front() == 0);
+	CHECK(growable.back() == 1);
+}
+
+TEST(check_ring_buffer_spans)
+{
+	df::RingBuffer<int> buffer(8, false);
+	for(int i = 0; i<6; ++i)
+	{
+		buffer.push_back(i);
+	}
+	buffer.pop_front(4);
+	for(int i = 6; i<10; ++i)
+	{
+		buffer.push_back(i);
+	}
+
+	int* first; uint32_t firstCount;
+	int* second; uint32_t secondCount;
+	buffer.spans(first, firstCount, second, secondCount);
+	CHECK(firstCount == 4);
+	CHECK(secondCount == 2);
+	CHECK(first[0] == 4);
+	CHECK(second[0] == 8);
+	CHECK(second[1] == 9);
+}
+
+TEST(check_spsc_ring_buffer)
+{
+	df::SPSCRingBuffer<int> queue(4);
+	CHECK(queue.capacity() == 4);
+	CHECK(queue.try_push(1));
+	CHECK(queue.try_push(2));
+	int values[3] = {3, 4, 5};
+	CHECK(queue.try_push(values, 3) == 2);
+	CHECK(!queue.try_push(6));
+
+	int value = 0;
+	CHECK(queue.try_pop(value));
+	CHECK(value == 1);
+
+	const int* first; uint32_t firstCount;
+	const int* second; uint32_t secondCount;
+	CHECK(queue.peek(first, firstCount, second, secondCount) == 3);
+	CHECK(firstCount == 3 && secondCount == 0);
+	CHECK(first[0] == 2);
+	queue.consume(3);
+	CHECK(queue.empty());
+}
+
+const int NUM_MESSAGES = 1000000;
+
+void producerFunc(void* userData)
+{
+	df::SPSCRingBuffer<int>* queue = (df::SPSCRingBuffer<int>*) userData;
+	for(int i = 0; i < NUM_MESSAGES; )
+	{
+		if(queue->try_push(i)) {
+			++i;
+		}
+	}
+}
+
+TEST(check_spsc_ring_buffer_multithread)
+{
+	df::SPSCRingBuffer<int> queue(1024);
+	df::Thread producer(&producerFunc, &queue);
+
+	int expected = 0;
+	bool inOrder = true;
+	int values[64];
+	while(expected < NUM_MESSAGES)
+	{
+		uint32_t count = queue.try_pop(values, 64);
+		for(uint32_t i = 0; i < count; ++i, ++expected)
+		{
+			inOrder &= (values[i] == expected);
+		}
+	}
+	producer.join();
+	CHECK(inOrder);
+	CHECK(queue.empty());
+}
+
+}
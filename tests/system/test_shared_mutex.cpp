@@ -0,0 +1,154 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <stdio.h>
+
+#include <df/system/SharedMutex.h>
+#include <df/system/SeqLock.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+
+namespace {
+
+/// the three fields are always written together, a reader must never see them mixed
+struct Route
+{
+	df::uint32 id;
+	df::uint32 gateway;
+	df::uint64 checksum;
+	bool isConsistent() const { return gateway == id * 2 && checksum == df::uint64(id) * 3; }
+};
+
+Route makeRoute(df::uint32 id)
+{
+	Route route = { id, id * 2, df::uint64(id) * 3 };
+	return route;
+}
+
+const int MAX_THREAD = 8;
+
+
+struct SharedTable
+{
+	df::SharedMutex mutex;
+	Route route;
+	df::SeqLock<Route> seqRoute;
+
+	volatile df::uint32 isStopping;
+	volatile df::uint32 inconsistentCount;
+	int readCount;
+
+	static void readShared(void* userData)
+	{
+		SharedTable* table = (SharedTable*) userData;
+		for(int i = 0; i<table->readCount; ++i)
+		{
+			df::ScopedSharedLock lock(table->mutex);
+			if(!table->route.isConsistent()) {
+				df::priv::atomicFetchAdd(&table->inconsistentCount, df::uint32(1));
+			}
+		}
+	}
+
+	static void readSeq(void* userData)
+	{
+		SharedTable* table = (SharedTable*) userData;
+		for(int i = 0; i<table->readCount; ++i)
+		{
+			if(!table->seqRoute.load().isConsistent()) {
+				df::priv::atomicFetchAdd(&table->inconsistentCount, df::uint32(1));
+			}
+		}
+	}
+
+	static void write(void* userData)
+	{
+		SharedTable* table = (SharedTable*) userData;
+		for(df::uint32 id = 1; !df::priv::atomicLoadAcquire(&table->isStopping); ++id)
+		{
+			{
+				df::ScopedLock lock(table->mutex);
+				table->route = makeRoute(id);
+			}
+			table->seqRoute.store(makeRoute(id));
+			df::this_thread::yield();
+		}
+	}
+
+	/// run threadCount readers (and optionally a writer), return the duration
+	df::Time run(void (*reader)(void*), int threadCount, bool withWriter)
+	{
+		isStopping = 0;
+		df::Thread* writer = withWriter ? new df::Thread(&write, this) : NULL;
+		df::Timer timer;
+		df::Thread* threads[MAX_THREAD];
+		for(int i = 0; i<threadCount; ++i)
+		{
+			threads[i] = new df::Thread(reader, this);
+		}
+		for(int i = 0; i<threadCount; ++i)
+		{
+			delete threads[i];
+		}
+		const df::Time time = timer.getElapsedTime();
+		df::priv::atomicStoreRelease(&isStopping, df::uint32(1));
+		delete writer;
+		return time;
+	}
+};
+
+TEST(check_shared_mutex)
+{
+	df::SharedMutex mutex;
+	CHECK(mutex.tryLockShared());
+	CHECK(mutex.tryLockShared());
+	CHECK(!mutex.tryLock());
+	mutex.unlockShared();
+	mutex.unlockShared();
+	{
+		df::ScopedLock lock(mutex);
+		CHECK(!mutex.tryLockShared());
+	}
+	{
+		df::ScopedSharedLock lock(mutex);
+		CHECK(!mutex.tryLock());
+	}
+	CHECK(mutex.tryLock());
+	mutex.unlock();
+}
+
+TEST(check_seq_lock)
+{
+	df::SeqLock<Route> seqRoute(makeRoute(5));
+	CHECK(seqRoute.load().id == 5 && seqRoute.load().isConsistent());
+	seqRoute.store(makeRoute(6));
+	CHECK(seqRoute.load().id == 6);
+
+	// readers concurrent with a writer never see a partial write
+	SharedTable table;
+	table.route = makeRoute(0);
+	table.seqRoute.store(makeRoute(0));
+	table.inconsistentCount = 0;
+	table.readCount = 20000;
+	table.run(&SharedTable::readShared, 3, true);
+	table.run(&SharedTable::readSeq, 3, true);
+	CHECK(table.inconsistentCount == 0);
+}
+
+TEST(bench_read_scaling)
+{
+	SharedTable table;
+	table.route = makeRoute(1);
+	table.seqRoute.store(makeRoute(1));
+	table.inconsistentCount = 0;
+	table.readCount = 500000;
+	// each thread does the same number of reads: with linear scaling the time stays constant
+	for(int threadCount = 1; threadCount <= MAX_THREAD; threadCount *= 2)
+	{
+		const float sharedTime = table.run(&SharedTable::readShared, threadCount, false).asMilliseconds();
+		const float seqTime = table.run(&SharedTable::readSeq, threadCount, false).asMilliseconds();
+		printf("%d readers x %d reads: SharedMutex %.1fms, SeqLock %.1fms\n", threadCount, table.readCount, sharedTime, seqTime);
+	}
+	CHECK(table.inconsistentCount == 0);
+}
+
+}
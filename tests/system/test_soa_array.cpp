@@ -0,0 +1,106 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+
+#include <df/system/SoAArray.h>
+
+namespace {
+
+typedef df::SoAArray<float, int, double> Particles;
+
+TEST(check_soa_constructor)
+{
+	Particles array1;
+	CHECK(array1.size() == 0);
+	CHECK(array1.reserved_size() == 0);
+
+	Particles array2(10);
+	CHECK(array2.size() == 0);
+	CHECK(array2.reserved_size() == 10);
+}
+
+TEST(check_soa_push_back)
+{
+	Particles array1;
+	for(int i = 0; i<100; ++i)
+	{
+		array1.push_back(float(i), i*2, double(i)*3);
+	}
+	CHECK(array1.size() == 100);
+	for(int i = 0; i<100; ++i)
+	{
+		CHECK(array1.get<0>(i) == float(i));
+		CHECK(array1[i].get<1>() == i*2);
+		CHECK(array1.column<2>()[i] == double(i)*3);
+	}
+
+	array1.pop_back();
+	CHECK(array1.size() == 99);
+}
+
+TEST(check_soa_column_alignment)
+{
+	Particles array1;
+	for(int i = 0; i<37; ++i)
+	{
+		array1.push_back(float(i), i, double(i));
+	}
+	CHECK(((size_t)array1.column<0>() & (Particles::ALIGNMENT-1)) == 0);
+	CHECK(((size_t)array1.column<1>() & (Particles::ALIGNMENT-1)) == 0);
+	CHECK(((size_t)array1.column<2>() & (Particles::ALIGNMENT-1)) == 0);
+}
+
+TEST(check_soa_resize)
+{
+	Particles array1;
+	array1.resize(25);
+	CHECK(array1.size() == 25);
+	CHECK(array1.reserved_size() >= 25);
+	for(int i = 0; i<25; ++i)
+	{
+		CHECK(array1.get<1>(i) == 0);
+	}
+
+	array1.resize(10);
+	CHECK(array1.size() == 10);
+	CHECK(array1.reserved_size() >= 25);
+	array1.clear();
+	CHECK(array1.size() == 0);
+	CHECK(array1.reserved_size() == 0);
+}
+
+TEST(check_soa_unsorted_remove)
+{
+	Particles array1;
+	for(int i = 0; i<10; ++i)
+	{
+		array1.push_back(float(i), i, double(i));
+	}
+	array1.unsorted_remove(2);
+	CHECK(array1.size() == 9);
+	// the last row must have been moved in all the columns
+	CHECK(array1.get<0>(2) == 9.f);
+	CHECK(array1.get<1>(2) == 9);
+	CHECK(array1.get<2>(2) == 9.0);
+
+	array1.unsorted_remove(8);
+	CHECK(array1.size() == 8);
+}
+
+TEST(check_soa_copy)
+{
+	Particles array1;
+	for(int i = 0; i<10; ++i)
+	{
+		array1.push_back(float(i), i, double(i));
+	}
+	Particles array2(array1);
+	CHECK(array2.size() == array1.size());
+	for(uint32_t i = 0; i<array1.size(); ++i)
+	{
+		CHECK(array2.get<0>(i) == array1.get<0>(i));
+		CHECK(array2.get<1>(i) == array1.get<1>(i));
+		CHECK(array2.get<2>(i) == array1.get<2>(i));
+	}
+}
+
+}
@@ -0,0 +1,274 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/ConditionVariable.h>
+#include <df/system/Semaphore.h>
+#include <df/system/Event.h>
+#include <df/system/Latch.h>
+#include <df/system/Mutex.h>
+#include <df/system/FastMutex.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+
+namespace {
+
+const int NUM_THREAD = 4;
+
+/// bounded queue of ints, producers and consumers block on condition variables
+struct BlockingQueue
+{
+	static const int CAPACITY = 8;
+	df::FastMutex mutex;
+	df::ConditionVariable notEmpty;
+	df::ConditionVariable notFull;
+	int items[CAPACITY];
+	int first;
+	int count;
+
+	BlockingQueue():first(0), count(0) {}
+
+	struct IsNotFull
+	{
+		const BlockingQueue* queue;
+		bool operator()() const { return queue->count < CAPACITY; }
+	};
+
+	void push(int value)
+	{
+		df::ScopedLock lock(mutex);
+		IsNotFull isNotFull = { this };
+		notFull.wait(mutex, isNotFull);
+		items[(first + count) % CAPACITY] = value;
+		++count;
+		notEmpty.notifyOne();
+	}
+
+	int pop()
+	{
+		df::ScopedLock lock(mutex);
+		while(count == 0) {
+			notEmpty.wait(mutex);
+		}
+		const int value = items[first];
+		first = (first + 1) % CAPACITY;
+		--count;
+		notFull.notifyOne();
+		return value;
+	}
+};
+
+const int NUM_ITEM = 5000;
+
+struct QueueTest
+{
+	BlockingQueue queue;
+	df::Mutex sumMutex;
+	long long sum;
+};
+
+void produce(void* userData)
+{
+	QueueTest* test = (QueueTest*) userData;
+	for(int i = 1; i <= NUM_ITEM; ++i) {
+		test->queue.push(i);
+	}
+}
+
+void consume(void* userData)
+{
+	QueueTest* test = (QueueTest*) userData;
+	long long sum = 0;
+	for(int i = 0; i < NUM_ITEM; ++i) {
+		sum += test->queue.pop();
+	}
+	df::ScopedLock lock(test->sumMutex);
+	test->sum += sum;
+}
+
+TEST(check_condition_variable)
+{
+	QueueTest test;
+	test.sum = 0;
+	df::Thread* threads[NUM_THREAD * 2];
+	for(int i = 0; i < NUM_THREAD; ++i)
+	{
+		threads[i * 2] = new df::Thread(&produce, &test);
+		threads[i * 2 + 1] = new df::Thread(&consume, &test);
+	}
+	for(int i = 0; i < NUM_THREAD * 2; ++i) {
+		delete threads[i];
+	}
+	CHECK(test.sum == (long long)NUM_THREAD * NUM_ITEM * (NUM_ITEM + 1) / 2);
+
+	// nobody notifies: the wait times out, with the (recursive) Mutex too
+	df::Mutex mutex;
+	df::ConditionVariable condition;
+	df::ScopedLock lock(mutex);
+	df::Timer timer;
+	CHECK(!condition.wait(mutex, df::milliseconds(20)));
+	CHECK(timer.getElapsedTime() >= df::milliseconds(15));
+	CHECK(mutex.tryLock());
+	mutex.unlock();
+}
+
+struct SemaphoreTest
+{
+	df::Semaphore semaphore;
+	volatile df::uint32 acquiredCount;
+};
+
+void acquire(void* userData)
+{
+	SemaphoreTest* test = (SemaphoreTest*) userData;
+	for(int i = 0; i < 1000; ++i)
+	{
+		test->semaphore.wait();
+		df::priv::atomicFetchAdd(&test->acquiredCount, df::uint32(1));
+	}
+}
+
+TEST(check_semaphore)
+{
+	df::Semaphore semaphore(2);
+	CHECK(semaphore.tryWait());
+	CHECK(semaphore.wait(df::milliseconds(10)));
+	CHECK(!semaphore.tryWait());
+	CHECK(!semaphore.wait(df::milliseconds(10)));
+	semaphore.post(3);
+	CHECK(semaphore.getCount() == 3);
+
+	SemaphoreTest test;
+	test.acquiredCount = 0;
+	df::Thread* threads[NUM_THREAD];
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		threads[i] = new df::Thread(&acquire, &test);
+	}
+	for(int i = 0; i < NUM_THREAD * 1000; ++i)
+	{
+		test.semaphore.post();
+		if(i % 100 == 0) {
+			df::this_thread::yield();
+		}
+	}
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		delete threads[i];
+	}
+	CHECK(test.acquiredCount == NUM_THREAD * 1000);
+	CHECK(test.semaphore.getCount() == 0);
+}
+
+struct EventTest
+{
+	df::Event start;
+	df::Event done;
+	volatile df::uint32 startedCount;
+	EventTest():start(df::Event::MANUAL_RESET), done(df::Event::AUTO_RESET), startedCount(0) {}
+};
+
+void waitStart(void* userData)
+{
+	EventTest* test = (EventTest*) userData;
+	test->start.wait();
+	df::priv::atomicFetchAdd(&test->startedCount, df::uint32(1));
+	test->done.set();
+}
+
+TEST(check_event)
+{
+	df::Event autoEvent;
+	CHECK(!autoEvent.wait(df::milliseconds(10)));
+	autoEvent.set();
+	CHECK(autoEvent.isSet());
+	CHECK(autoEvent.tryWait());
+	CHECK(!autoEvent.tryWait());
+
+	// a manual reset event releases all the waiters
+	EventTest test;
+	df::Thread* threads[NUM_THREAD];
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		threads[i] = new df::Thread(&waitStart, &test);
+	}
+	df::this_thread::sleep(df::milliseconds(10));
+	CHECK(test.startedCount == 0);
+	test.start.set();
+	// each set of an auto reset event releases one wait
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		while(!test.done.wait(df::milliseconds(100)) && test.startedCount < NUM_THREAD) {}
+	}
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		delete threads[i];
+	}
+	CHECK(test.startedCount == NUM_THREAD);
+	CHECK(test.start.isSet());
+	test.start.reset();
+	CHECK(!test.start.tryWait());
+}
+
+struct BarrierTest
+{
+	static const int NUM_PHASE = 200;
+	BarrierTest():barrier(NUM_THREAD), latch(NUM_THREAD), serialCount(0), errorCount(0) { for(int i = 0; i < NUM_THREAD; ++i) progress[i] = 0; }
+	df::Barrier barrier;
+	df::Latch latch;
+	volatile df::uint32 progress[NUM_THREAD];
+	volatile df::uint32 serialCount;
+	volatile df::uint32 errorCount;
+};
+
+struct BarrierThread
+{
+	BarrierTest* test;
+	int index;
+};
+
+void runPhases(void* userData)
+{
+	BarrierThread* thread = (BarrierThread*) userData;
+	BarrierTest* test = thread->test;
+	for(int phase = 0; phase < BarrierTest::NUM_PHASE; ++phase)
+	{
+		df::priv::atomicStoreRelease(&test->progress[thread->index], df::uint32(phase + 1));
+		if(test->barrier.arriveAndWait()) {
+			df::priv::atomicFetchAdd(&test->serialCount, df::uint32(1));
+		}
+		// everybody reached this phase
+		for(int i = 0; i < NUM_THREAD; ++i)
+		{
+			if(df::priv::atomicLoadAcquire(&test->progress[i]) < df::uint32(phase + 1)) {
+				df::priv::atomicFetchAdd(&test->errorCount, df::uint32(1));
+			}
+		}
+		// and nobody goes further until everybody checked
+		test->barrier.arriveAndWait();
+	}
+	test->latch.countDown();
+}
+
+TEST(check_latch_barrier)
+{
+	df::Latch latch(2);
+	CHECK(!latch.isReady());
+	latch.countDown();
+	CHECK(!latch.wait(df::milliseconds(10)));
+	latch.countDown();
+	CHECK(latch.wait(df::milliseconds(10)));
+	latch.wait();
+
+	BarrierTest test;
+	BarrierThread threadData[NUM_THREAD];
+	df::Thread* threads[NUM_THREAD];
+	for(int i = 0; i < NUM_THREAD; ++i)
+	{
+		threadData[i].test = &test;
+		threadData[i].index = i;
+		threads[i] = new df::Thread(&runPhases, &threadData[i]);
+	}
+	test.latch.wait();
+	CHECK(test.latch.isReady());
+	for(int i = 0; i < NUM_THREAD; ++i) {
+		delete threads[i];
+	}
+	CHECK(test.errorCount == 0);
+	CHECK(test.serialCount == BarrierTest::NUM_PHASE);
+}
+
+}
@@ -0,0 +1,124 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <string.h>
+
+#include <df/system/TaskGraph.h>
+#include <df/system/ThreadPool.h>
+#include <df/system/Thread.h>
+
+namespace {
+
+/// record the order in which the tasks are executed
+struct Recorder
+{
+	Recorder():nextRank(0) {}
+	volatile df::uint32 nextRank;
+	df::uint32 ranks[8];
+};
+
+struct RecordedTask
+{
+	Recorder* recorder;
+	df::uint32 index;
+	df::uint32 sleepMilliseconds;
+
+	static void run(void* userData)
+	{
+		RecordedTask* task = (RecordedTask*) userData;
+		if(task->sleepMilliseconds) {
+			df::this_thread::sleep(df::milliseconds(float(task->sleepMilliseconds)));
+		}
+		task->recorder->ranks[task->index] = df::priv::atomicFetchAdd(&task->recorder->nextRank, df::uint32(1));
+	}
+};
+
+class CountRunnable : public df::Runnable
+{
+public:
+	CountRunnable():count(0) {}
+	virtual void run() { df::priv::atomicFetchAdd(&count, df::uint32(1)); }
+	volatile df::uint32 count;
+};
+
+TEST(check_task_graph_dependencies)
+{
+	df::ThreadPool pool(3);
+	Recorder recorder;
+	RecordedTask tasks[5];
+	for(df::uint32 i = 0; i<5; ++i)
+	{
+		RecordedTask task = { &recorder, i, 0 };
+		tasks[i] = task;
+	}
+	// diamond 0 -> (1, 2) -> 3, then a continuation 4
+	df::TaskGraph graph;
+	df::TaskGraph::TaskId a = graph.addTask(&RecordedTask::run, &tasks[0], "a");
+	df::TaskGraph::TaskId b = graph.addTask(&RecordedTask::run, &tasks[1], "b");
+	df::TaskGraph::TaskId c = graph.addTask(&RecordedTask::run, &tasks[2], "c");
+	df::TaskGraph::TaskId d = graph.addTask(&RecordedTask::run, &tasks[3], "d");
+	graph.addDependency(a, b);
+	graph.addDependency(a, c);
+	graph.addDependency(b, d);
+	graph.addDependency(c, d);
+	df::TaskGraph::TaskId e = graph.addContinuation(d, &RecordedTask::run, &tasks[4], "e");
+	CHECK(graph.getTaskCount() == 5);
+	CHECK(strcmp(graph.getTaskName(e), "e") == 0);
+
+	// re-executed graph
+	for(int run = 0; run<100; ++run)
+	{
+		recorder.nextRank = 0;
+		graph.run(pool);
+		CHECK(recorder.nextRank == 5);
+		CHECK(recorder.ranks[a] == 0);
+		CHECK(recorder.ranks[b] < recorder.ranks[d] && recorder.ranks[c] < recorder.ranks[d]);
+		CHECK(recorder.ranks[e] == 4);
+	}
+
+	CountRunnable runnable;
+	graph.clear();
+	CHECK(graph.getTaskCount() == 0);
+	graph.run(pool);
+	for(int i = 0; i<20; ++i)
+	{
+		graph.addTask(&runnable);
+	}
+	graph.run(pool);
+	graph.run(pool);
+	CHECK(runnable.count == 40);
+
+	// graph without dependencies, then empty graph
+	graph.clear();
+	CHECK(graph.getTaskCount() == 0);
+	graph.clear();
+	df::TaskGraph empty;
+	empty.clear();
+	CHECK(empty.getTaskCount() == 0);
+	empty.run(pool);
+}
+
+TEST(check_task_graph_critical_path)
+{
+	df::ThreadPool pool(2);
+	Recorder recorder;
+	// long chain 0 -> 1 -> 2 and a short independent task 3
+	RecordedTask tasks[4] = { { &recorder, 0, 20 }, { &recorder, 1, 20 }, { &recorder, 2, 20 }, { &recorder, 3, 5 } };
+	df::TaskGraph graph;
+	for(df::uint32 i = 0; i<4; ++i)
+	{
+		graph.addTask(&RecordedTask::run, &tasks[i]);
+	}
+	graph.addDependency(0, 1);
+	graph.addDependency(1, 2);
+	graph.run(pool);
+
+	df::Array<df::TaskGraph::TaskId> path;
+	graph.getCriticalPath(path);
+	CHECK(path.size() == 3);
+	CHECK(path.size() == 3 && path[0] == 0 && path[1] == 1 && path[2] == 2);
+	CHECK(graph.getTaskTime(1) >= df::milliseconds(20));
+	CHECK(graph.getCriticalPathTime() >= df::milliseconds(60));
+	CHECK(graph.getRunTime() >= graph.getCriticalPathTime());
+}
+
+}
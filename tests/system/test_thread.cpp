@@ -2,6 +2,16 @@
 #include <ReportAssert.h>
 #include <df/system/Thread.h>
 #include <df/system/Mutex.h>
+#include <df/system/FastMutex.h>
+#include <df/system/SpinLock.h>
+#include <df/system/Timer.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(DF_PLATFORM_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
 
 namespace {
 
@@ -62,4 +72,163 @@ TEST(test_Thread)
     }
 }
 
-}
\ No newline at end of file
+/// counter protected by a lock of type Lock, incremented by several threads
+template<class Lock>
+struct LockedCounter
+{
+    Lock lock;
+    int count;
+    int incrementCount;
+
+    static void run(void* userData)
+    {
+        LockedCounter* counter = (LockedCounter*) userData;
+        for(int i=0; i<counter->incrementCount; ++i)
+        {
+            df::ScopedLock scopedLock(counter->lock);
+            counter->count++;
+        }
+    }
+
+    /// return the duration of the run
+    df::Time contend(int threadCount, int incrementCountPerThread)
+    {
+        count = 0;
+        incrementCount = incrementCountPerThread;
+        df::Timer timer;
+        df::Thread* threads[NUM_THREAD];
+        for(int i=0; i<threadCount; ++i)
+        {
+            threads[i] = new df::Thread(&run, this);
+        }
+        for(int i=0; i<threadCount; ++i)
+        {
+            delete threads[i];
+        }
+        return timer.getElapsedTime();
+    }
+};
+
+TEST(check_locks)
+{
+    df::FastMutex fastMutex;
+    CHECK(fastMutex.tryLock());
+    CHECK(!fastMutex.tryLock());
+    fastMutex.unlock();
+
+    df::SpinLock spinLock;
+    CHECK(spinLock.tryLock());
+    CHECK(!spinLock.tryLock());
+    spinLock.unlock();
+
+    df::AdaptiveMutex adaptiveMutex;
+    {
+        df::ScopedLockT<df::AdaptiveMutex> lock(adaptiveMutex);
+        CHECK(!adaptiveMutex.tryLock());
+    }
+    CHECK(adaptiveMutex.tryLock());
+    adaptiveMutex.unlock();
+
+    LockedCounter<df::FastMutex> fastCounter;
+    fastCounter.contend(4, NUM_INCREMENT);
+    CHECK(fastCounter.count == 4 * NUM_INCREMENT);
+    LockedCounter<df::SpinLock> spinCounter;
+    spinCounter.contend(4, NUM_INCREMENT);
+    CHECK(spinCounter.count == 4 * NUM_INCREMENT);
+    LockedCounter<df::AdaptiveMutex> adaptiveCounter;
+    adaptiveCounter.contend(4, NUM_INCREMENT);
+    CHECK(adaptiveCounter.count == 4 * NUM_INCREMENT);
+}
+
+TEST(bench_lock_contention)
+{
+    const int INCREMENT_COUNT = 200000;
+    LockedCounter<df::Mutex> mutexCounter;
+    LockedCounter<df::FastMutex> fastCounter;
+    LockedCounter<df::SpinLock> spinCounter;
+    LockedCounter<df::AdaptiveMutex> adaptiveCounter;
+    for(int threadCount = 1; threadCount <= 8; threadCount *= 2)
+    {
+        const float mutexTime = mutexCounter.contend(threadCount, INCREMENT_COUNT).asMilliseconds();
+        const float fastTime = fastCounter.contend(threadCount, INCREMENT_COUNT).asMilliseconds();
+        const float spinTime = spinCounter.contend(threadCount, INCREMENT_COUNT).asMilliseconds();
+        const float adaptiveTime = adaptiveCounter.contend(threadCount, INCREMENT_COUNT).asMilliseconds();
+        printf("%d threads x %d locks: Mutex %.1fms, FastMutex %.1fms, SpinLock %.1fms, AdaptiveMutex %.1fms\n",
+            threadCount, INCREMENT_COUNT, mutexTime, fastTime, spinTime, adaptiveTime);
+        CHECK(mutexCounter.count == threadCount * INCREMENT_COUNT);
+        CHECK(fastCounter.count == threadCount * INCREMENT_COUNT);
+        CHECK(spinCounter.count == threadCount * INCREMENT_COUNT);
+        CHECK(adaptiveCounter.count == threadCount * INCREMENT_COUNT);
+    }
+}
+
+struct OptionsReport
+{
+    df::uint32 cpu;
+    df::uint32 stackUsage;
+    bool isLongNameSet;
+    char name[32];
+};
+
+/// use some stack, to check that a small stack is still usable
+df::uint32 useStack(int depth)
+{
+    volatile char buffer[512];
+    buffer[0] = char(depth);
+    return (depth > 0) ? useStack(depth - 1) + buffer[0] : 0;
+}
+
+void reportOptions(void* userData)
+{
+    OptionsReport* report = (OptionsReport*) userData;
+    report->cpu = df::this_thread::getCurrentCPU();
+    report->stackUsage = useStack(16);
+    // too long for Linux: truncated rather than refused
+    report->isLongNameSet = df::this_thread::setName("df_test_thread_long_name");
+#if defined(DF_PLATFORM_LINUX)
+    pthread_getname_np(pthread_self(), report->name, sizeof(report->name));
+#endif
+}
+
+TEST(check_thread_options)
+{
+    CHECK(df::this_thread::getHardwareConcurrency() >= 1);
+#if defined(DF_PLATFORM_LINUX)
+    // cpu ids are not dense when some cpus are offline
+    CHECK(long(df::this_thread::getCurrentCPU()) < sysconf(_SC_NPROCESSORS_CONF));
+
+    // pin on the first cpu the process may run on (taskset, cgroup cpusets)
+    df::uint64 affinityMask = 0;
+    cpu_set_t allowedCPUs;
+    if(sched_getaffinity(0, sizeof(allowedCPUs), &allowedCPUs) == 0)
+    {
+        for(df::uint32 cpu = 0; cpu < 64 && affinityMask == 0; ++cpu)
+        {
+            if(CPU_ISSET(cpu, &allowedCPUs)) {
+                affinityMask = df::uint64(1) << cpu;
+            }
+        }
+    }
+#else
+    const df::uint64 affinityMask = 1;
+#endif
+
+    df::ThreadOptions options;
+    options.name = "df_pinned";
+    options.affinityMask = affinityMask;
+    options.priority = df::ThreadOptions::PRIORITY_LOW;
+    options.stackSize = 64 * 1024;
+    OptionsReport report = { 1000, 0, false, "" };
+    df::Thread thread(&reportOptions, &report, options);
+    thread.join();
+    CHECK(report.stackUsage == 16 * 17 / 2);
+#if defined(DF_PLATFORM_LINUX)
+    if(affinityMask != 0) {
+        CHECK(affinityMask == df::uint64(1) << report.cpu);
+    }
+    CHECK(report.isLongNameSet);
+    CHECK(strcmp(report.name, "df_test_thread_") == 0);
+#endif
+}
+
+}
@@ -0,0 +1,96 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/ThreadLocal.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+
+namespace {
+
+/// counts its live instances
+struct Tracked
+{
+	static df::Atomic<df::int32> s_liveCount;
+
+	Tracked():count(0) { s_liveCount.fetchAdd(1); }
+	Tracked(const Tracked& other):count(other.count) { s_liveCount.fetchAdd(1); }
+	~Tracked() { s_liveCount.fetchSub(1); }
+
+	int count;
+};
+df::Atomic<df::int32> Tracked::s_liveCount;
+
+const int NUM_THREAD = 4;
+const int NUM_INCREMENT = 1000;
+
+struct Sum
+{
+	Sum():total(0) {}
+	void operator()(Tracked& tracked) { total += tracked.count; }
+	int total;
+};
+
+struct SharedCounters
+{
+	df::ThreadLocal<Tracked> counters;
+	df::Atomic<df::uint32> readyCount;
+	df::Atomic<df::uint32> isDone;
+	df::Atomic<df::uint32> errorCount;
+};
+
+void incrementCounter(void* userData)
+{
+	SharedCounters* test = (SharedCounters*) userData;
+	if(test->counters.hasInstance()) {
+		test->errorCount.fetchAdd(1);
+	}
+	for(int i = 0; i < NUM_INCREMENT; ++i) {
+		++test->counters->count;
+	}
+	if(test->counters.get().count != NUM_INCREMENT) {
+		test->errorCount.fetchAdd(1);
+	}
+	// stay alive until the main thread has enumerated the instances
+	test->readyCount.fetchAdd(1);
+	while(!test->isDone.load()) {
+		df::this_thread::yield();
+	}
+}
+
+TEST(check_thread_local)
+{
+	{
+		SharedCounters test;
+		CHECK(!test.counters.hasInstance());
+		test.counters->count = 7;
+		CHECK(test.counters.hasInstance());
+		CHECK(test.counters.getInstanceCount() == 1);
+		CHECK(Tracked::s_liveCount.load() == 2); // initial value + instance of this thread
+
+		df::Thread* threads[NUM_THREAD];
+		for(int i = 0; i < NUM_THREAD; ++i) {
+			threads[i] = new df::Thread(&incrementCounter, &test);
+		}
+		while(test.readyCount.load() < NUM_THREAD) {
+			df::this_thread::yield();
+		}
+		CHECK(test.counters.getInstanceCount() == NUM_THREAD + 1);
+		CHECK(test.counters.forEach(Sum()).total == NUM_THREAD * NUM_INCREMENT + 7);
+
+		// the instances of the threads are destroyed when they exit
+		test.isDone.store(1);
+		for(int i = 0; i < NUM_THREAD; ++i) {
+			delete threads[i];
+		}
+		CHECK(test.counters.getInstanceCount() == 1);
+		CHECK(Tracked::s_liveCount.load() == 2);
+		CHECK(test.counters->count == 7);
+		CHECK(test.errorCount.load() == 0);
+	}
+	// and the remaining ones with the ThreadLocal
+	CHECK(Tracked::s_liveCount.load() == 0);
+
+	df::ThreadLocal<int> initialized(42);
+	CHECK(*initialized == 42);
+}
+
+}
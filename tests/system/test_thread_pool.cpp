@@ -0,0 +1,205 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <stdio.h>
+
+#include <df/system/ThreadPool.h>
+#include <df/system/Parallel.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+
+namespace {
+
+void increment(void* userData)
+{
+	df::priv::atomicFetchAdd((volatile df::uint32*) userData, df::uint32(1));
+}
+
+class IncrementRunnable : public df::Runnable
+{
+public:
+	IncrementRunnable():count(0) {}
+	virtual void run() { increment((void*)&count); }
+	volatile df::uint32 count;
+};
+
+/// recursive fibonacci, each level submits a task from the worker running it and waits for it
+struct Fibonacci
+{
+	df::ThreadPool* pool;
+	df::uint32 n;
+	df::uint64 result;
+
+	static void run(void* userData)
+	{
+		Fibonacci* fib = (Fibonacci*) userData;
+		if(fib->n < 2)
+		{
+			fib->result = fib->n;
+			return;
+		}
+		Fibonacci left = { fib->pool, fib->n - 1, 0 };
+		Fibonacci right = { fib->pool, fib->n - 2, 0 };
+		df::TaskGroup group;
+		fib->pool->submit(group, &Fibonacci::run, &left);
+		run(&right);
+		fib->pool->wait(group);
+		fib->result = left.result + right.result;
+	}
+};
+
+struct NestedSum
+{
+	df::ThreadPool* pool;
+	volatile df::uint32* total;
+	void operator()(df::uint32 begin, df::uint32 end) const
+	{
+		for(df::uint32 i = begin; i < end; ++i)
+		{
+			Inner inner = { total };
+			df::parallel_for(*pool, 100, inner, 10);
+		}
+	}
+	struct Inner
+	{
+		volatile df::uint32* total;
+		void operator()(df::uint32 begin, df::uint32 end) const { df::priv::atomicFetchAdd(total, end - begin); }
+	};
+};
+
+TEST(check_thread_pool_task_group)
+{
+	df::ThreadPool pool(3);
+	volatile df::uint32 count = 0;
+	df::TaskGroup group;
+	CHECK(group.isDone());
+	// more tasks than a worker deque can hold
+	for(int i = 0; i<5000; ++i)
+	{
+		pool.submit(group, &increment, (void*)&count);
+	}
+	pool.wait(group);
+	CHECK(group.isDone());
+	CHECK(count == 5000);
+
+	IncrementRunnable runnable;
+	for(int i = 0; i<10; ++i)
+	{
+		pool.submit(group, &runnable);
+	}
+	pool.wait(group);
+	CHECK(runnable.count == 10);
+}
+
+struct GroupWaiter
+{
+	df::ThreadPool* pool;
+	df::TaskGroup* group;
+
+	static void run(void* userData)
+	{
+		GroupWaiter* waiter = (GroupWaiter*) userData;
+		waiter->pool->wait(*waiter->group);
+	}
+};
+
+void sleepAndIncrement(void* userData)
+{
+	df::this_thread::sleep(df::milliseconds(20));
+	increment(userData);
+}
+
+TEST(check_thread_pool_parked_waiters)
+{
+	// threads which are not workers sleep until the last task of the group wakes them up
+	df::ThreadPool pool(2);
+	volatile df::uint32 count = 0;
+	df::TaskGroup group;
+	for(int round = 0; round<3; ++round)
+	{
+		for(int i = 0; i<4; ++i)
+		{
+			pool.submit(group, &sleepAndIncrement, (void*)&count);
+		}
+		GroupWaiter waiter = { &pool, &group };
+		df::Thread first(&GroupWaiter::run, &waiter);
+		df::Thread second(&GroupWaiter::run, &waiter);
+		pool.wait(group);
+		first.join();
+		second.join();
+		CHECK(group.isDone());
+		CHECK(count == df::uint32(4 * (round + 1)));
+	}
+}
+
+TEST(check_thread_pool_drain_on_destruction)
+{
+	volatile df::uint32 count = 0;
+	{
+		df::ThreadPool pool(2);
+		for(int i = 0; i<1000; ++i)
+		{
+			pool.submit(&increment, (void*)&count);
+		}
+	}
+	CHECK(count == 1000);
+
+	// a pool without worker runs tasks inline
+	df::ThreadPool inlinePool(0);
+	df::TaskGroup group;
+	inlinePool.submit(group, &increment, (void*)&count);
+	CHECK(count == 1001);
+	CHECK(group.isDone());
+	inlinePool.wait(group);
+}
+
+TEST(check_thread_pool_nested_tasks)
+{
+	df::ThreadPool pool(3);
+	Fibonacci fib = { &pool, 20, 0 };
+	df::TaskGroup group;
+	pool.submit(group, &Fibonacci::run, &fib);
+	pool.wait(group);
+	CHECK(fib.result == 6765);
+
+	// parallel algorithms called from the workers of the same pool
+	volatile df::uint32 total = 0;
+	NestedSum sum = { &pool, &total };
+	df::parallel_for(pool, 50, sum, 1);
+	CHECK(total == 5000);
+}
+
+TEST(bench_thread_pool_spawn)
+{
+	// cost of a batch of small tasks on the pool versus one thread per task
+	const int BATCH_SIZE = 64;
+	volatile df::uint32 count = 0;
+	df::ThreadPool pool;
+	df::Timer timer;
+	for(int batch = 0; batch<100; ++batch)
+	{
+		df::TaskGroup group;
+		for(int i = 0; i<BATCH_SIZE; ++i)
+		{
+			pool.submit(group, &increment, (void*)&count);
+		}
+		pool.wait(group);
+	}
+	const float poolTime = timer.restart().asMilliseconds() / 100;
+	for(int batch = 0; batch<10; ++batch)
+	{
+		df::Thread* threads[BATCH_SIZE];
+		for(int i = 0; i<BATCH_SIZE; ++i)
+		{
+			threads[i] = new df::Thread(&increment, (void*)&count);
+		}
+		for(int i = 0; i<BATCH_SIZE; ++i)
+		{
+			delete threads[i];
+		}
+	}
+	const float threadTime = timer.restart().asMilliseconds() / 10;
+	printf("batch of %d tasks: pool %.3fms, one thread per task %.3fms\n", BATCH_SIZE, poolTime, threadTime);
+	CHECK(count == 110 * BATCH_SIZE);
+}
+
+}
@@ -2,6 +2,7 @@
 #include <ReportAssert.h>
 #include <df/system/Timer.h>
 #include <df/system/Thread.h>
+#include <cstdio>
 
 namespace {
 
@@ -15,6 +16,32 @@ TEST(test_Time)
     CHECK_CLOSE( t_milliseconds.asMicroseconds(), t_microseconds.asMicroseconds(), 10);
 }
 
+TEST(test_Time_nanoseconds)
+{
+    // exact integer arithmetic, below the microsecond and beyond the precision of a float
+    const df::Time day = df::microseconds(86400000000LL);
+    const df::Time uptime = day * 365 + df::nanoseconds(1);
+    CHECK_EQUAL( 365 * 86400000000000LL + 1, uptime.asNanoseconds());
+    CHECK_EQUAL( 365 * 86400000000LL, uptime.asMicroseconds());
+    CHECK( uptime - df::nanoseconds(1) == day * 365);
+    CHECK_EQUAL( df::int64(365), uptime / day);
+    CHECK( uptime % day == df::nanoseconds(1));
+    CHECK( (uptime - df::nanoseconds(1)) / 365 == day);
+    CHECK_EQUAL( df::int64(1500), (df::nanoseconds(3000) / 2).asNanoseconds());
+    CHECK_EQUAL( df::int64(-1), df::nanoseconds(-1001).asMicroseconds());
+
+    // float factors go through double precision
+    CHECK_EQUAL( df::int64(500000), df::milliseconds(0.5f).asNanoseconds());
+    CHECK_EQUAL( 2 * 365 * 86400000000000LL, (day * 365 * 2.0f).asNanoseconds());
+    CHECK_EQUAL( 365 * 86400000000000LL / 4, (day * 365 / 4.0f).asNanoseconds());
+
+    df::Time time = df::nanoseconds(10);
+    time *= 3;
+    time /= df::int64(2);
+    time += df::nanoseconds(1);
+    CHECK_EQUAL( df::int64(16), time.asNanoseconds());
+}
+
 TEST(test_Timer)
 {
     df::Timer timer;
@@ -27,4 +54,61 @@ TEST(test_Timer)
     CHECK( elapsed.asMilliseconds() <= 125.0f);
 }
 
-}
\ No newline at end of file
+TEST(test_sleepUntil)
+{
+    const df::Time deadline = df::Timer::getCurrentTime() + df::milliseconds(20.0f);
+    df::this_thread::sleepUntil(deadline);
+    const df::Time late = df::Timer::getCurrentTime() - deadline;
+    CHECK( late >= df::Time());
+    CHECK( late.asMilliseconds() <= 25.0f);
+
+    // past deadline: no sleep
+    df::Timer timer;
+    df::this_thread::sleepUntil(deadline);
+    CHECK( timer.getElapsedTime().asMilliseconds() < 5.0f);
+
+    const df::Time preciseDeadline = df::Timer::getCurrentTime() + df::milliseconds(5.0f);
+    df::this_thread::sleepUntilPrecise(preciseDeadline);
+    CHECK( df::Timer::getCurrentTime() >= preciseDeadline);
+}
+
+/// wake up delay after deadlines 1 ms apart
+template<class Sleep>
+void measureJitter(const char* name, Sleep sleep)
+{
+    const int count = 200;
+    df::int64 total = 0;
+    df::int64 maximum = 0;
+    df::Time deadline = df::Timer::getCurrentTime();
+    for(int i = 0; i < count; ++i)
+    {
+        deadline += df::microseconds(1000);
+        sleep(deadline);
+        const df::int64 late = (df::Timer::getCurrentTime() - deadline).asMicroseconds();
+        total += late;
+        maximum = (late > maximum) ? late : maximum;
+    }
+    printf("%s: wake up %.1f us late on average, %d us at worst\n", name, double(total) / count, int(maximum));
+}
+
+void sleepRelative(df::Time deadline)
+{
+    const df::Time remaining = deadline - df::Timer::getCurrentTime();
+    if(remaining > df::Time()) {
+        df::this_thread::sleep(remaining);
+    }
+}
+
+void sleepPrecise(df::Time deadline)
+{
+    df::this_thread::sleepUntilPrecise(deadline);
+}
+
+TEST(bench_sleep_jitter)
+{
+    measureJitter("sleep", &sleepRelative);
+    measureJitter("sleepUntil", &df::this_thread::sleepUntil);
+    measureJitter("sleepUntilPrecise", &sleepPrecise);
+}
+
+}
@@ -0,0 +1,249 @@
+#include <UnitTest++.h>
+#include <ReportAssert.h>
+#include <df/system/TimerWheel.h>
+#include <df/system/Atomic.h>
+#include <df/system/Thread.h>
+#include <df/system/Timer.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const df::Time DAY = df::seconds(86400.0f);
+
+/// records the order in which timers fire
+struct Firing
+{
+	std::vector<int> fired;
+};
+
+struct Record
+{
+	Firing* firing;
+	int value;
+};
+
+void recordValue(void* userData)
+{
+	Record* record = (Record*) userData;
+	record->firing->fired.push_back(record->value);
+}
+
+TEST(check_timer_wheel_order)
+{
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	Firing firing;
+
+	// deadlines spread over the three first levels, in ms
+	const int count = 2000;
+	std::vector<Record> records(count);
+	srand(42);
+	for(int i = 0; i < count; ++i)
+	{
+		records[i].firing = &firing;
+		records[i].value = rand() % 200000;
+		wheel.schedule(start + df::milliseconds(float(records[i].value)), &recordValue, &records[i]);
+	}
+	CHECK_EQUAL((df::uint32) count, wheel.getCount());
+
+	// nothing fires before its deadline, everything fires after it
+	df::uint32 firedCount = 0;
+	for(int now = 0; now <= 200000; now += 997)
+	{
+		firedCount += wheel.advance(start + df::milliseconds(float(now)));
+		for(size_t i = 0; i < firing.fired.size(); ++i) {
+			CHECK(firing.fired[i] <= now + 1);
+		}
+		CHECK(wheel.getCount() + firedCount == (df::uint32) count);
+	}
+	firedCount += wheel.advance(start + df::milliseconds(200002));
+	CHECK_EQUAL((df::uint32) count, firedCount);
+	CHECK_EQUAL((size_t) count, firing.fired.size());
+	CHECK_EQUAL(0u, wheel.getCount());
+	for(size_t i = 1; i < firing.fired.size(); ++i) {
+		CHECK(firing.fired[i - 1] <= firing.fired[i]);
+	}
+}
+
+TEST(check_timer_wheel_cancel)
+{
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	Firing firing;
+	Record records[3] = { { &firing, 0 }, { &firing, 1 }, { &firing, 2 } };
+
+	const df::TimerId first = wheel.schedule(start + df::milliseconds(10), &recordValue, &records[0]);
+	const df::TimerId second = wheel.schedule(start + df::milliseconds(10), &recordValue, &records[1]);
+	const df::TimerId third = wheel.schedule(start + df::milliseconds(5000), &recordValue, &records[2]);
+	CHECK(first != 0 && second != 0 && third != 0);
+	CHECK(wheel.cancel(second));
+	CHECK(!wheel.cancel(second));
+	CHECK(wheel.cancel(third));
+	CHECK_EQUAL(1u, wheel.getCount());
+
+	// the node of second is reused: its old id stays invalid
+	const df::TimerId reused = wheel.schedule(start + df::milliseconds(20), &recordValue, &records[1]);
+	CHECK(reused != second);
+	CHECK(!wheel.cancel(second));
+
+	CHECK_EQUAL(0u, wheel.advance(start + df::milliseconds(8)));
+	CHECK_EQUAL(2u, wheel.advance(start + df::milliseconds(30)));
+	CHECK(!wheel.cancel(first));
+	CHECK(!wheel.cancel(reused));
+	CHECK(!wheel.cancel(0));
+	CHECK_EQUAL(2u, (unsigned) firing.fired.size());
+	CHECK_EQUAL(0, firing.fired[0]);
+	CHECK_EQUAL(1, firing.fired[1]);
+}
+
+TEST(check_timer_wheel_far)
+{
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	Firing firing;
+	// 2^32 ms is about 49.7 days: the 60 days timer goes beyond the wheel
+	Record records[3] = { { &firing, 1 }, { &firing, 30 }, { &firing, 60 } };
+	wheel.schedule(start + DAY * df::int64(60), &recordValue, &records[2]);
+	wheel.schedule(start + DAY * df::int64(30), &recordValue, &records[1]);
+	wheel.schedule(start + DAY, &recordValue, &records[0]);
+	CHECK(wheel.getNextDeadline() > start);
+	CHECK(wheel.getNextDeadline() <= start + DAY);
+
+	CHECK_EQUAL(0u, wheel.advance(start + DAY - df::milliseconds(2)));
+	CHECK_EQUAL(1u, wheel.advance(start + DAY + df::milliseconds(2)));
+	CHECK_EQUAL(0u, wheel.advance(start + DAY * df::int64(29)));
+	CHECK_EQUAL(1u, wheel.advance(start + DAY * df::int64(31)));
+	CHECK_EQUAL(0u, wheel.advance(start + DAY * df::int64(59)));
+	CHECK_EQUAL(1u, wheel.getCount());
+	CHECK_EQUAL(1u, wheel.advance(start + DAY * df::int64(60) + df::milliseconds(2)));
+	CHECK_EQUAL(3u, (unsigned) firing.fired.size());
+	CHECK_EQUAL(60, firing.fired[2]);
+	// no timer left: a deadline already reached
+	CHECK(wheel.getNextDeadline() <= start + DAY * df::int64(60) + df::milliseconds(2));
+}
+
+/// reschedules itself until count reaches 0
+struct Repeater
+{
+	df::TimerWheel* wheel;
+	df::Time deadline;
+	int count;
+};
+
+void repeat(void* userData)
+{
+	Repeater* repeater = (Repeater*) userData;
+	if(--repeater->count > 0)
+	{
+		repeater->deadline += df::milliseconds(3);
+		repeater->wheel->schedule(repeater->deadline, &repeat, repeater);
+	}
+}
+
+TEST(check_timer_wheel_level_boundaries)
+{
+	// deadlines exactly on the first tick of a level 1 and a level 2 slot fire at their tick
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time origin = wheel.getNextDeadline(); // empty wheel: its tick 0
+	Firing firing;
+	Record records[2] = { { &firing, 256 }, { &firing, 65536 } };
+	wheel.schedule(origin + df::milliseconds(256), &recordValue, &records[0]);
+	wheel.schedule(origin + df::milliseconds(65536), &recordValue, &records[1]);
+
+	CHECK_EQUAL(0u, wheel.advance(origin + df::milliseconds(255)));
+	CHECK(wheel.getNextDeadline() == origin + df::milliseconds(256));
+	CHECK_EQUAL(1u, wheel.advance(origin + df::milliseconds(256)));
+	CHECK_EQUAL(0u, wheel.advance(origin + df::milliseconds(65535)));
+	CHECK(wheel.getNextDeadline() == origin + df::milliseconds(65536));
+	CHECK_EQUAL(1u, wheel.advance(origin + df::milliseconds(65536)));
+	CHECK_EQUAL(2u, (unsigned) firing.fired.size());
+}
+
+TEST(check_timer_wheel_reschedule)
+{
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	Repeater repeater = { &wheel, start + df::milliseconds(3), 100 };
+	wheel.schedule(repeater.deadline, &repeat, &repeater);
+	// a single advance fires the timers scheduled by the callbacks too
+	CHECK_EQUAL(100u, wheel.advance(start + df::milliseconds(1000)));
+	CHECK_EQUAL(0, repeater.count);
+	CHECK_EQUAL(0u, wheel.getCount());
+}
+
+struct Alarm
+{
+	df::Time deadline;
+	df::Time firedTime;
+	df::Atomic<df::uint32> isFired;
+};
+
+void ring(void* userData)
+{
+	Alarm* alarm = (Alarm*) userData;
+	alarm->firedTime = df::Timer::getCurrentTime();
+	alarm->isFired.store(1);
+}
+
+TEST(check_timer_wheel_thread)
+{
+	df::TimerWheelThread timers(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	const int count = 4;
+	Alarm alarms[count];
+	Alarm cancelled;
+	// scheduled latest first: each one must wake the driver up earlier
+	for(int i = count - 1; i >= 0; --i)
+	{
+		alarms[i].deadline = start + df::milliseconds(float(20 + 10 * i));
+		timers.schedule(alarms[i].deadline, &ring, &alarms[i]);
+	}
+	const df::TimerId cancelledId = timers.schedule(start + df::milliseconds(25), &ring, &cancelled);
+	CHECK(timers.cancel(cancelledId));
+
+	df::this_thread::sleep(df::milliseconds(200));
+	CHECK_EQUAL(0u, timers.getCount());
+	CHECK(!cancelled.isFired.load());
+	for(int i = 0; i < count; ++i)
+	{
+		CHECK(alarms[i].isFired.load());
+		CHECK(alarms[i].firedTime >= alarms[i].deadline);
+		printf("TimerWheelThread: timer %d fired %lld us late\n", i, (long long) (alarms[i].firedTime - alarms[i].deadline).asMicroseconds());
+	}
+}
+
+void doNothing(void*)
+{
+}
+
+TEST(bench_timer_wheel)
+{
+	const int count = 1000000;
+	df::TimerWheel wheel(df::milliseconds(1));
+	const df::Time start = df::Timer::getCurrentTime();
+	std::vector<df::TimerId> ids(count);
+	wheel.reserve(count);
+
+	df::Timer timer;
+	for(int i = 0; i < count; ++i) {
+		ids[i] = wheel.schedule(start + df::milliseconds(float(i % 100000)), &doNothing, NULL);
+	}
+	const df::Time scheduleTime = timer.getElapsedTime();
+	timer.restart();
+	for(int i = 0; i < count; i += 2) {
+		wheel.cancel(ids[i]);
+	}
+	const df::Time cancelTime = timer.getElapsedTime();
+	timer.restart();
+	const df::uint32 firedCount = wheel.advance(start + df::milliseconds(100000));
+	const df::Time advanceTime = timer.getElapsedTime();
+	CHECK_EQUAL((df::uint32) count / 2, firedCount);
+
+	printf("TimerWheel: schedule %.1f ns, cancel %.1f ns, fire %.1f ns per timer\n",
+		scheduleTime.asNanoseconds() / double(count), cancelTime.asNanoseconds() / double(count / 2),
+		advanceTime.asNanoseconds() / double(count / 2));
+}
+
+}